@@ -24,10 +24,48 @@ constexpr uint DISPLAY_PIN_DC    = 19;  // Data/Command (RS)
 constexpr uint DISPLAY_PIN_RESET = 18;  // Reset
 // The BL (Backlight) pin is not used for this display
 
-// The maximum number of pixels the async drawing buffer can hold.
+// The largest tile Drawing::drawImageAsync accepts.
 // A full-screen tile (320x12) is 3840 pixels. 4096 is a safe, round number.
 constexpr size_t MAX_DRAW_BUFFER_PIXELS = 4096;
 
+// --- Band renderer ---
+// BandRenderer composites into two bands of BAND_MAX_WIDTH x BAND_ROWS pixels
+// (2 x 5 KB at these values). Taller bands mean fewer window writes per
+// render; a band must fit in MAX_DRAW_BUFFER_PIXELS.
+constexpr uint16_t BAND_MAX_WIDTH = 320;
+constexpr uint16_t BAND_ROWS = 8;
+
+// --- Core assignment ---
+// When true, core1 owns the display and the drawing pipeline, and core0
+// (Wi-Fi, BLE, CRC checks) hands tiles over through a lock-free queue.
+// When false, everything runs on core0 as part of the BTstack run loop.
+constexpr bool DISPLAY_ON_CORE1 = true;
+
+// --- Draw scheduling (core0) ---
+// Time the display pipeline may take from each poll when it runs on core0.
+constexpr uint32_t DRAW_BUDGET_US = 3000;
+// Housekeeping cadence (watchdog, Wi-Fi link, TCP timeouts). Tiles, ACKs and
+// encoder events are handled on wakeups, not on this tick.
+constexpr uint32_t POLL_INTERVAL_MS = 10;
+// How often the achieved rows/s is logged.
+constexpr uint32_t DRAW_STATS_INTERVAL_MS = 5000;
+
+// --- Retained mode ---
+// Keeps a copy of the panel in RAM (150 KB at 320x240). Tiles are drawn into
+// it, the changed rows are flushed to the panel, and the host may move pixels
+// with COPY_RECT / SCROLL_RECT instead of resending them. The tile queue
+// shrinks to make room; if the heap is still too small, the app logs a
+// warning and draws straight to the panel as usual.
+constexpr bool SHADOW_FRAMEBUFFER = false;
+// Longest a framebuffer change waits for the panel while tiles keep arriving.
+// An idle tile queue flushes at once.
+constexpr uint32_t FRAMEBUFFER_FLUSH_DELAY_US = 20000;
+
+// Logs the byte loop, slice-by-8 and DMA sniffer CRC-32 rates at boot.
+constexpr bool CRC_BENCHMARK_AT_BOOT = false;
+// Logs drawString timings at boot: per-pixel windows versus row spans.
+constexpr bool TEXT_BENCHMARK_AT_BOOT = false;
+
 #include "private_config.h"
 
 #endif // CONFIG_H
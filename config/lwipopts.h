@@ -17,7 +17,9 @@
 
 // --- TCP Options ---
 #define TCP_MSS                     1460
-#define TCP_WND                     (8 * TCP_MSS)
+// Queued tiles keep their share of the window until drawn (see TcpServer),
+// so leave room for one tile being drawn, one queued and one arriving.
+#define TCP_WND                     (16 * TCP_MSS)
 #define TCP_SND_BUF                 (8 * TCP_MSS)
 #define TCP_SND_QUEUELEN            ((4 * (TCP_SND_BUF) + (TCP_MSS - 1))/(TCP_MSS))
 #define TCP_TMR_INTERVAL            100 // Required for threadsafe background mode
@@ -34,9 +36,22 @@
 #define LWIP_DNS                    1
 #define LWIP_TCP                    1
 #define LWIP_UDP                    1
-#define LWIP_STATS                  0
 #define LWIP_TCP_KEEPALIVE          1
 
+// --- Statistics ---
+// Heap and pool usage only, reported in the STATS frame.
+#define LWIP_STATS                  1
+#define LWIP_STATS_DISPLAY          0
+#define MEM_STATS                   1
+#define MEMP_STATS                  1
+#define LINK_STATS                  0
+#define ETHARP_STATS                0
+#define IP_STATS                    0
+#define ICMP_STATS                  0
+#define UDP_STATS                   0
+#define TCP_STATS                   0
+#define SYS_STATS                   0
+
 // --- Checksum options ---
 #define CHECKSUM_GEN_IP             1
 #define CHECKSUM_GEN_UDP            1
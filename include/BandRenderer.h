@@ -0,0 +1,62 @@
+// File: include/BandRenderer.h
+
+#ifndef BAND_RENDERER_H
+#define BAND_RENDERER_H
+
+#include "Drawing.h"
+#include "CustomFont.h"
+#include "config.h"
+
+// Composites overlapping drawing without a framebuffer. Operations are
+// recorded into a display list and rasterized together, BAND_ROWS rows at a
+// time, into one of two band buffers; each finished band goes to the panel
+// as a single window while the next one is rasterized. Every pixel is
+// written once, so there is no overdraw and nothing flickers.
+//
+//   renderer.clear();
+//   renderer.fillRect(...); renderer.drawString(...);
+//   renderer.render(x, y, width, height);
+class BandRenderer {
+public:
+    explicit BandRenderer(Drawing& drawing);
+
+    // Starts a new display list.
+    void clear();
+    // Operations are composited in the order they were added. Strings and
+    // pixels are not copied and must stay valid until render() returns.
+    // Each returns false if the display list is full.
+    bool fillRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t color);
+    bool drawString(uint16_t x, uint16_t y, const char* str, uint16_t color, const custom_font_t* font);
+    bool drawImage(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint16_t* pixels);
+
+    // Rasterizes the display list inside the given window, which is at most
+    // BAND_MAX_WIDTH wide and must lie on the panel; pixels no operation
+    // covers are black. Returns once the last band has been handed to Drawing
+    // (in retained mode, the framebuffer), or false as soon as Drawing
+    // rejects a band, in which case the rest of the window is not drawn.
+    bool render(uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+
+private:
+    enum class OpType : uint8_t { FILL, TEXT, IMAGE };
+    struct Op {
+        OpType type;
+        uint16_t x, y, width, height;
+        uint16_t color;
+        const void* data; // TEXT: the string, IMAGE: the pixels
+        const custom_font_t* font;
+    };
+
+    bool add(const Op& op);
+    void wait_idle();
+    void rasterize(uint16_t* band, uint16_t x, uint16_t y, uint16_t width, uint16_t rows) const;
+    static void rasterize_text(const Op& op, uint16_t* band, uint16_t x, uint16_t y, uint16_t width, uint16_t rows);
+
+    static constexpr size_t MAX_OPS = 16;
+
+    Drawing& m_drawing;
+    Op m_ops[MAX_OPS];
+    size_t m_op_count = 0;
+    uint16_t m_bands[2][BAND_MAX_WIDTH * BAND_ROWS];
+};
+
+#endif // BAND_RENDERER_H
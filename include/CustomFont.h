@@ -5,15 +5,63 @@
 
 #include "pico/stdlib.h"
 
-// A custom font structure that supports characters wider than 8 pixels.
+// Glyph bitmaps cover only the glyph's ink, so blank glyphs such as space
+// take no bitmap bytes at all. Fonts are generated by scripts/create_font.py.
+#define GLYPH_RLE 0x01 // Bitmap is run-length coded rather than packed bits
+
 typedef struct {
-    const uint8_t *data;
-    const uint8_t *widths;
-    uint8_t width;
+    uint16_t offset;  // Start of the bitmap in custom_font_t::bitmaps
+    uint8_t width;    // Ink box; zero for blank glyphs
     uint8_t height;
-    uint8_t bytes_per_row; // Number of bytes for each horizontal line of pixels
-    uint8_t first_char;
-    uint8_t last_char;
+    int8_t x_offset;  // Box position from the pen, and from the top of the line
+    int8_t y_offset;
+    uint8_t advance;  // Pen movement to the next glyph
+    uint8_t flags;    // GLYPH_RLE
+} custom_glyph_t;
+
+// Characters first..last map to consecutive glyphs from 'glyph' on, so a font
+// may hold any sparse set of characters.
+typedef struct {
+    uint8_t first;
+    uint8_t last;
+    uint16_t glyph;
+} custom_font_range_t;
+
+typedef struct {
+    const uint8_t *bitmaps;
+    const custom_glyph_t *glyphs;
+    const custom_font_range_t *ranges; // Sorted by character
+    uint8_t range_count;
+    uint8_t height; // Line height; every glyph box lies inside it
 } custom_font_t;
 
-#endif // CUSTOM_FONT_H
\ No newline at end of file
+// The glyph for 'c', or nullptr if the font does not have it.
+const custom_glyph_t* font_find_glyph(const custom_font_t* font, char c);
+
+// Walks a glyph's ink as horizontal runs, top to bottom, in glyph box
+// coordinates. Packed bitmaps hold the box row-major, one bit per pixel,
+// first pixel in the low bit, rows not padded. RLE bitmaps hold alternating
+// clear and inked run lengths (starting with clear) in nibbles, low nibble
+// first; a nibble of 15 adds 15 and continues the same run.
+class GlyphRuns {
+public:
+    GlyphRuns(const custom_font_t* font, const custom_glyph_t* glyph);
+    // Next run of ink: row and columns [x0, x1). Runs never span rows.
+    // Returns false once the glyph is done.
+    bool next(uint8_t& row, uint8_t& x0, uint8_t& x1);
+
+private:
+    uint16_t read_run();
+    uint16_t count_bits(bool ink) const;
+
+    const uint8_t* m_data;
+    bool m_rle;
+    uint8_t m_width;
+    uint16_t m_total;
+    uint16_t m_pos = 0;     // Pixels of the box walked so far
+    uint16_t m_left = 0;    // Pixels left in the current run
+    bool m_ink = true;      // Colour of the current run
+    uint16_t m_nibble = 0;  // RLE read position
+};
+
+#endif // CUSTOM_FONT_H
@@ -4,9 +4,9 @@
 #define DRAWING_H
 
 #include "Display.h"
+#include "Framebuffer.h"
 #include "CustomFont.h"
 #include "config.h"
-#include <vector>
 
 class Drawing {
 public:
@@ -17,22 +17,74 @@ public:
 
     Drawing(St7789Display& display);
 
+    // Retained mode: with a framebuffer set, every call below draws into it
+    // and returns at once, and flush() sends what changed to the panel.
+    void setFramebuffer(Framebuffer* framebuffer) { m_framebuffer = framebuffer; }
+    bool isRetained() const { return m_framebuffer != nullptr; }
+    // Sends the topmost dirty band of the framebuffer to the panel. Full-width
+    // bands are contiguous in memory and go out as one DMA transfer, finished
+    // like drawImageAsync; narrower ones are streamed row by row. Returns
+    // false if there was nothing to send (or a transfer is still running).
+    bool flush();
+
     void fillRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t color);
+    // Text is rasterized a row of the whole string at a time. Transparent
+    // strings draw only their ink, one window per horizontal run in each row;
+    // with a background the string's box goes out as a single window.
     void drawString(uint16_t x, uint16_t y, const char* str, uint16_t color, const custom_font_t* font);
+    void drawString(uint16_t x, uint16_t y, const char* str, uint16_t color, uint16_t background, const custom_font_t* font);
     
+    // Zero-copy: image_data is read by DMA and must stay valid (and unchanged)
+    // until processDrawing() returns IDLE. The image is not clipped: empty or
+    // off-screen rectangles are rejected.
     bool drawImageAsync(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint16_t* image_data);
     DrawStatus processDrawing();
 
+    // St7789Display's streamed window, or its equivalent in the framebuffer.
+    void beginWrite(uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+    void writePixels(const uint16_t* pixels, uint32_t count);
+    void endWrite();
+    bool isWriting() const;
+
+    // Decodes an IMAGE_TILE_RLE payload row by row straight to the display.
+    // Blocking; rows are double-buffered so decoding overlaps the DMA. Returns
+    // false on malformed data (the rest of the window is then drawn black).
+    bool drawRleImage(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint8_t* data, size_t length);
+
+    // Expands palette indices (1, 2, 4 or 8 bits per pixel, rows byte aligned,
+    // first pixel in the low bits) to RGB565 row by row using interp0, and
+    // streams the rows like drawRleImage. Indices beyond the palette draw black.
+    bool drawPaletteImage(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t bits_per_pixel,
+                          const uint16_t* palette, size_t palette_count, const uint8_t* indices, size_t length);
+
 private:
-    void drawChar(uint16_t x, uint16_t y, char c, uint16_t color, const custom_font_t* font);
-    void drawPixel(uint16_t x, uint16_t y, uint16_t color);
-    void drawImage(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint16_t* image_data);
-    
+    // Columns the string's advances and ink span, clipped to the panel and a row buffer.
+    uint16_t text_width(uint16_t x, const char* str, const custom_font_t* font) const;
+    // Sets bit i of m_text_mask[j] where line row top + j of the string has
+    // ink in column i, for TEXT_MASK_ROWS rows.
+    void text_mask(const char* str, const custom_font_t* font, uint16_t top, uint16_t width);
+
+    bool decode_rle_row(uint16_t* out, const uint16_t* above, uint16_t width, const uint8_t*& data, const uint8_t* end);
+
+    static constexpr size_t MAX_ROW_PIXELS = 320;
+    static constexpr size_t MASK_WORDS = (MAX_ROW_PIXELS + 31) / 32;
+    static constexpr size_t MAX_OPEN_SPANS = 48; // Runs of ink tracked down a transparent string
+    static constexpr size_t TEXT_MASK_ROWS = 16;
+
     St7789Display& m_display;
+    Framebuffer* m_framebuffer = nullptr;
     DrawStatus m_status;
-    uint16_t m_async_x, m_async_y, m_async_width, m_async_height;
-    std::vector<uint16_t> m_async_pixel_buffer;
-    int m_async_y_offset;
+    // Streamed window in the framebuffer, and the pixels written so far.
+    uint16_t m_window_x = 0, m_window_y = 0, m_window_width = 0, m_window_height = 0;
+    uint32_t m_window_pos = 0;
+    uint16_t m_row_buffers[2][MAX_ROW_PIXELS];
+    uint16_t m_palette[256];
+    uint32_t m_text_mask[TEXT_MASK_ROWS][MASK_WORDS];
 };
 
+// Logs how long drawString takes for two status-line strings: plotted pixel
+// by pixel (the old path), as spans, and as spans over a background. Draws in
+// the top text line of the panel and clears it afterwards.
+void text_benchmark(St7789Display& display, Drawing& drawing, const custom_font_t* font);
+
 #endif // DRAWING_H
\ No newline at end of file
@@ -0,0 +1,55 @@
+// File: include/Framebuffer.h
+
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include "pico/stdlib.h"
+
+// Device-side copy of the panel for retained mode (SHADOW_FRAMEBUFFER in
+// config.h). Drawing writes here instead of to the panel, and every write
+// marks the columns it touched in each row dirty until Drawing::flush() has
+// sent them on. Pixels are native RGB565 in row-major order, the layout the
+// display's DMA reads, so rows go to the panel straight from here.
+class Framebuffer {
+public:
+    // Allocates width * height pixels, black and clean. Returns false, and
+    // stays invalid, if the heap is too small.
+    bool init(uint16_t width, uint16_t height);
+    bool isValid() const { return m_pixels != nullptr; }
+    uint16_t getWidth() const { return m_width; }
+    uint16_t getHeight() const { return m_height; }
+    const uint16_t* row(uint16_t y) const { return m_pixels + (size_t)y * m_width; }
+
+    // Everything below clips to the framebuffer.
+    void fill(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t color);
+    void setPixel(uint16_t x, uint16_t y, uint16_t color);
+    void writeRow(uint16_t x, uint16_t y, const uint16_t* pixels, uint16_t count);
+    // Source and destination may overlap.
+    void copy(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t dst_x, uint16_t dst_y);
+    // Moves the content of the rectangle by (dx, dy); what is uncovered gets fill_color.
+    void scroll(uint16_t x, uint16_t y, uint16_t width, uint16_t height, int16_t dx, int16_t dy, uint16_t fill_color);
+    void markDirty(uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+
+    bool isDirty() const { return m_dirty_top < m_dirty_bottom; }
+    // time_us_32() when the framebuffer last went from clean to dirty.
+    uint32_t dirtySinceUs() const { return m_dirty_since_us; }
+    // Marks the topmost run of dirty rows clean and returns it as one
+    // rectangle, the union of their dirty columns. False if all is clean.
+    bool takeDirtyRect(uint16_t& x, uint16_t& y, uint16_t& width, uint16_t& height);
+
+private:
+    bool clip(uint16_t x, uint16_t y, uint16_t& width, uint16_t& height) const;
+
+    uint16_t* m_pixels = nullptr;
+    uint16_t m_width = 0;
+    uint16_t m_height = 0;
+    // Dirty columns [m_dirty_x0[y], m_dirty_x1[y]) of each row; a clean row has x0 >= x1.
+    uint16_t* m_dirty_x0 = nullptr;
+    uint16_t* m_dirty_x1 = nullptr;
+    // Every dirty row lies in [m_dirty_top, m_dirty_bottom).
+    uint16_t m_dirty_top = 0;
+    uint16_t m_dirty_bottom = 0;
+    uint32_t m_dirty_since_us = 0;
+};
+
+#endif // FRAMEBUFFER_H
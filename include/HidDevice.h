@@ -25,6 +25,8 @@ protected:
     virtual void onReadyToSend_impl();
     virtual void onHidSubscribed_impl();
     virtual void onTypingTimer_impl(btstack_timer_source_t* ts);
+    // Called whenever the ACL link comes up or goes down; per-connection state resets here.
+    virtual void onConnectionChanged_impl();
 
     virtual const uint8_t* getHidDescriptor() const = 0;
     virtual uint16_t getHidDescriptorSize() const = 0;
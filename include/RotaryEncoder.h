@@ -6,8 +6,12 @@
 
 class RotaryEncoder {
 public:
+    // Called from the GPIO interrupt after a rotation step or a key press.
+    typedef void (*EventCallback)(void* context);
+
     RotaryEncoder(uint pin_A, uint pin_B, uint pin_Key);
     void init(); // The new initialization method
+    void setEventCallback(EventCallback callback, void* context);
 
     bool read_and_clear_raw_press_event();
     int8_t read_and_clear_rotation();
@@ -26,6 +30,9 @@ private:
     volatile bool m_key_event_occurred = false;
     
     volatile uint64_t m_last_rotation_interrupt_time_us = 0;
+
+    EventCallback m_on_event = nullptr;
+    void* m_on_event_context = nullptr;
     
     critical_section_t m_crit_sec;
 };
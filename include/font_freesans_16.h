@@ -3,219 +3,172 @@
 
 #include "CustomFont.h"
 
-// Font data for font_freesans_16 (16x16)
-static const uint8_t font_freesans_16_data[] = {
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 
-    0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0a, 0x00, 0x0a, 0x00, 0x0a, 0x00, 0x0a, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc8, 0x00, 0x48, 0x00, 0x48, 0x00, 0xfe, 0x01, 
-    0x4c, 0x00, 0x44, 0x00, 0x64, 0x00, 0xff, 0x00, 0x24, 0x00, 0x24, 0x00, 0x26, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x7c, 0x00, 0xd6, 0x00, 0x92, 0x00, 0x12, 0x00, 
-    0x16, 0x00, 0x38, 0x00, 0xd0, 0x00, 0x90, 0x00, 0x92, 0x00, 0xd6, 0x00, 0x7c, 0x00, 0x10, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1e, 0x02, 0x33, 0x02, 0x21, 0x01, 0xa1, 0x01, 
-    0xb3, 0x00, 0xde, 0x00, 0x40, 0x1e, 0x60, 0x33, 0x20, 0x21, 0x10, 0x33, 0x10, 0x1e, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x38, 0x00, 0x44, 0x00, 0x44, 0x00, 0x6c, 0x00, 
-    0x38, 0x00, 0x1c, 0x00, 0x36, 0x01, 0xe2, 0x01, 0xc2, 0x00, 0xe6, 0x01, 0x3c, 0x03, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x02, 0x00, 
-    0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x04, 0x00, 0x04, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x08, 0x00, 
-    0x08, 0x00, 0x08, 0x00, 0x08, 0x00, 0x08, 0x00, 0x08, 0x00, 0x08, 0x00, 0x04, 0x00, 0x04, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x2a, 0x00, 0x1c, 0x00, 0x14, 0x00, 0x14, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0xfe, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x1e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x08, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 
-    0x04, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x38, 0x00, 0x44, 0x00, 0x82, 0x00, 0x82, 0x00, 
-    0x82, 0x00, 0x82, 0x00, 0x82, 0x00, 0x82, 0x00, 0x82, 0x00, 0x44, 0x00, 0x38, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x18, 0x00, 0x1c, 0x00, 0x10, 0x00, 
-    0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7c, 0x00, 0xc6, 0x00, 0x82, 0x00, 0x80, 0x00, 
-    0x80, 0x00, 0x60, 0x00, 0x38, 0x00, 0x0c, 0x00, 0x04, 0x00, 0x02, 0x00, 0xfe, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7c, 0x00, 0xc6, 0x00, 0x82, 0x00, 0x80, 0x00, 
-    0xc0, 0x00, 0x70, 0x00, 0xc0, 0x00, 0x80, 0x00, 0x82, 0x00, 0xc6, 0x00, 0x7c, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x00, 0x30, 0x00, 0x38, 0x00, 0x28, 0x00, 
-    0x24, 0x00, 0x26, 0x00, 0x23, 0x00, 0xff, 0x00, 0x20, 0x00, 0x20, 0x00, 0x20, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfc, 0x00, 0x04, 0x00, 0x04, 0x00, 0x02, 0x00, 
-    0x7e, 0x00, 0xc6, 0x00, 0x80, 0x00, 0x80, 0x00, 0x82, 0x00, 0x46, 0x00, 0x3c, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x38, 0x00, 0x44, 0x00, 0x82, 0x00, 0x02, 0x00, 
-    0x7a, 0x00, 0xc6, 0x00, 0x82, 0x00, 0x82, 0x00, 0x82, 0x00, 0x44, 0x00, 0x38, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfe, 0x00, 0x40, 0x00, 0x40, 0x00, 0x20, 0x00, 
-    0x10, 0x00, 0x10, 0x00, 0x08, 0x00, 0x08, 0x00, 0x08, 0x00, 0x04, 0x00, 0x04, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7c, 0x00, 0xc6, 0x00, 0x82, 0x00, 0x82, 0x00, 
-    0xc6, 0x00, 0x7c, 0x00, 0xc6, 0x00, 0x82, 0x00, 0x82, 0x00, 0xc6, 0x00, 0x7c, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x38, 0x00, 0x44, 0x00, 0x82, 0x00, 0x82, 0x00, 
-    0x82, 0x00, 0xc6, 0x00, 0xbc, 0x00, 0x80, 0x00, 0x80, 0x00, 0x46, 0x00, 0x3c, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 
-    0xc0, 0x01, 0x38, 0x00, 0x0e, 0x00, 0x06, 0x00, 0x38, 0x00, 0xe0, 0x00, 0x80, 0x01, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0xfe, 0x01, 0x00, 0x00, 0x00, 0x00, 0xfe, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x0e, 0x00, 0x38, 0x00, 0xc0, 0x00, 0xc0, 0x01, 0x70, 0x00, 0x0e, 0x00, 0x02, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7c, 0x00, 0xc6, 0x00, 0x82, 0x00, 0x80, 0x00, 0xc0, 0x00, 
-    0x60, 0x00, 0x30, 0x00, 0x10, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0, 0x07, 0x30, 0x1c, 0x08, 0x30, 0x04, 0x20, 0xc4, 0x4d, 
-    0x22, 0x4e, 0x12, 0x46, 0x12, 0x46, 0x12, 0x62, 0x32, 0x33, 0xe4, 0x1e, 0x0c, 0x00, 0x18, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x00, 0x70, 0x00, 0x50, 0x00, 0xd8, 0x00, 0xc8, 0x00, 
-    0x8c, 0x00, 0x8c, 0x01, 0xfc, 0x01, 0x06, 0x01, 0x06, 0x03, 0x02, 0x03, 0x03, 0x02, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfe, 0x00, 0x82, 0x01, 0x02, 0x01, 0x02, 0x01, 0x02, 0x01, 
-    0x82, 0x01, 0xfe, 0x00, 0x02, 0x03, 0x02, 0x02, 0x02, 0x02, 0x02, 0x03, 0xfe, 0x01, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xf0, 0x00, 0x0c, 0x01, 0x04, 0x02, 0x02, 0x00, 0x02, 0x00, 
-    0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x02, 0x04, 0x02, 0x0c, 0x01, 0xf0, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfe, 0x00, 0x82, 0x01, 0x02, 0x01, 0x02, 0x02, 0x02, 0x02, 
-    0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x01, 0x82, 0x01, 0xfe, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfe, 0x01, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 
-    0x02, 0x00, 0xfe, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0xfe, 0x01, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfe, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 
-    0x02, 0x00, 0xfe, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xf0, 0x01, 0x08, 0x02, 0x04, 0x04, 0x06, 0x00, 0x02, 0x00, 
-    0x02, 0x00, 0x82, 0x07, 0x02, 0x04, 0x02, 0x04, 0x04, 0x06, 0x08, 0x07, 0xf0, 0x04, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 
-    0x02, 0x02, 0xfe, 0x03, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 
-    0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x00, 0x40, 0x00, 0x40, 0x00, 0x40, 0x00, 0x40, 0x00, 
-    0x40, 0x00, 0x40, 0x00, 0x40, 0x00, 0x42, 0x00, 0x42, 0x00, 0x66, 0x00, 0x3c, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x82, 0x01, 0xc2, 0x00, 0x62, 0x00, 0x32, 0x00, 0x12, 0x00, 
-    0x1a, 0x00, 0x36, 0x00, 0x62, 0x00, 0x42, 0x00, 0xc2, 0x00, 0x82, 0x01, 0x02, 0x01, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 
-    0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0xfe, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x0c, 0x06, 0x0c, 0x0e, 0x0e, 0x0a, 0x0a, 0x0a, 0x0a, 
-    0x1a, 0x0b, 0x12, 0x09, 0x12, 0x09, 0xb2, 0x09, 0xa2, 0x08, 0xe2, 0x08, 0xe2, 0x08, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x02, 0x06, 0x02, 0x0e, 0x02, 0x1a, 0x02, 0x12, 0x02, 
-    0x32, 0x02, 0x62, 0x02, 0x42, 0x02, 0xc2, 0x02, 0x82, 0x03, 0x02, 0x03, 0x02, 0x03, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xf0, 0x00, 0x0c, 0x01, 0x04, 0x02, 0x02, 0x04, 0x02, 0x04, 
-    0x02, 0x04, 0x02, 0x04, 0x02, 0x04, 0x02, 0x04, 0x04, 0x02, 0x0c, 0x01, 0xf0, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfe, 0x00, 0x82, 0x01, 0x02, 0x01, 0x02, 0x01, 0x02, 0x01, 
-    0x82, 0x01, 0xfe, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xf0, 0x00, 0x0c, 0x01, 0x04, 0x02, 0x02, 0x04, 0x02, 0x04, 
-    0x02, 0x04, 0x02, 0x04, 0x02, 0x04, 0x02, 0x04, 0x84, 0x02, 0x0c, 0x03, 0xf0, 0x03, 0x00, 0x04, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfe, 0x01, 0x02, 0x03, 0x02, 0x02, 0x02, 0x02, 0x02, 0x03, 
-    0xfe, 0x01, 0x02, 0x03, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x06, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x78, 0x00, 0x86, 0x01, 0x02, 0x01, 0x02, 0x00, 0x06, 0x00, 
-    0x3c, 0x00, 0xf0, 0x00, 0x80, 0x01, 0x02, 0x01, 0x02, 0x01, 0x84, 0x00, 0x78, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0x01, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 
-    0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x10, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 
-    0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x04, 0x01, 0xf8, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0x02, 0x03, 0x06, 0x01, 0x86, 0x01, 0x84, 0x01, 
-    0x8c, 0x00, 0xc8, 0x00, 0xc8, 0x00, 0x58, 0x00, 0x70, 0x00, 0x70, 0x00, 0x30, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x83, 0x60, 0xc2, 0x21, 0xc2, 0x21, 0x46, 0x31, 0x66, 0x31, 
-    0x24, 0x13, 0x24, 0x12, 0x24, 0x1a, 0x1c, 0x1e, 0x18, 0x0e, 0x18, 0x0c, 0x18, 0x0c, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x03, 0x86, 0x01, 0x8c, 0x00, 0xd8, 0x00, 0x78, 0x00, 
-    0x30, 0x00, 0x70, 0x00, 0x58, 0x00, 0xc8, 0x00, 0x8c, 0x01, 0x86, 0x01, 0x02, 0x03, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x03, 0x06, 0x01, 0x8c, 0x01, 0x88, 0x00, 0xd8, 0x00, 
-    0x50, 0x00, 0x20, 0x00, 0x20, 0x00, 0x20, 0x00, 0x20, 0x00, 0x20, 0x00, 0x20, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfe, 0x01, 0x80, 0x01, 0xc0, 0x00, 0xc0, 0x00, 0x60, 0x00, 
-    0x30, 0x00, 0x30, 0x00, 0x18, 0x00, 0x0c, 0x00, 0x04, 0x00, 0x06, 0x00, 0xff, 0x01, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0e, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 
-    0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 
-    0x02, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x08, 0x00, 0x08, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 
-    0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x00, 0x18, 0x00, 0x14, 0x00, 0x24, 0x00, 
-    0x22, 0x00, 0x62, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3e, 0x00, 0x41, 0x00, 
-    0x40, 0x00, 0x40, 0x00, 0x7c, 0x00, 0x47, 0x00, 0x41, 0x00, 0x61, 0x00, 0xde, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x3a, 0x00, 0x46, 0x00, 
-    0x82, 0x00, 0x82, 0x00, 0x82, 0x00, 0x82, 0x00, 0x82, 0x00, 0x46, 0x00, 0x3a, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3c, 0x00, 0x62, 0x00, 
-    0x41, 0x00, 0x01, 0x00, 0x01, 0x00, 0x01, 0x00, 0x41, 0x00, 0x62, 0x00, 0x3c, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x80, 0x00, 0x80, 0x00, 0xbc, 0x00, 0xc2, 0x00, 
-    0x81, 0x00, 0x81, 0x00, 0x81, 0x00, 0x81, 0x00, 0x81, 0x00, 0xc2, 0x00, 0xbc, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3c, 0x00, 0x42, 0x00, 
-    0x81, 0x00, 0x81, 0x00, 0xff, 0x00, 0x01, 0x00, 0x01, 0x00, 0xc2, 0x00, 0x7c, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x00, 0x02, 0x00, 0x02, 0x00, 0x07, 0x00, 0x02, 0x00, 
-    0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x5c, 0x00, 0x62, 0x00, 
-    0x41, 0x00, 0x41, 0x00, 0x41, 0x00, 0x41, 0x00, 0x41, 0x00, 0x62, 0x00, 0x5c, 0x00, 0x40, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x3a, 0x00, 0x46, 0x00, 
-    0x42, 0x00, 0x42, 0x00, 0x42, 0x00, 0x42, 0x00, 0x42, 0x00, 0x42, 0x00, 0x42, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 
-    0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x01, 0x00, 
-    0x01, 0x00, 0x01, 0x00, 0x01, 0x00, 0x01, 0x00, 0x01, 0x00, 0x01, 0x00, 0x01, 0x00, 0x01, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x62, 0x00, 0x32, 0x00, 
-    0x1a, 0x00, 0x1e, 0x00, 0x16, 0x00, 0x32, 0x00, 0x22, 0x00, 0x62, 0x00, 0x42, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 
-    0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3a, 0x07, 0xc6, 0x08, 
-    0x42, 0x08, 0x42, 0x08, 0x42, 0x08, 0x42, 0x08, 0x42, 0x08, 0x42, 0x08, 0x42, 0x08, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3a, 0x00, 0x46, 0x00, 
-    0x42, 0x00, 0x42, 0x00, 0x42, 0x00, 0x42, 0x00, 0x42, 0x00, 0x42, 0x00, 0x42, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3c, 0x00, 0x42, 0x00, 
-    0x81, 0x00, 0x81, 0x00, 0x81, 0x00, 0x81, 0x00, 0x81, 0x00, 0x42, 0x00, 0x3c, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3a, 0x00, 0x46, 0x00, 
-    0x82, 0x00, 0x82, 0x00, 0x82, 0x00, 0x82, 0x00, 0x82, 0x00, 0x46, 0x00, 0x3a, 0x00, 0x02, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xbc, 0x00, 0xc2, 0x00, 
-    0x81, 0x00, 0x81, 0x00, 0x81, 0x00, 0x81, 0x00, 0x81, 0x00, 0xc2, 0x00, 0xbc, 0x00, 0x80, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1a, 0x00, 0x06, 0x00, 
-    0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3c, 0x00, 0x46, 0x00, 
-    0x02, 0x00, 0x02, 0x00, 0x0c, 0x00, 0x70, 0x00, 0x40, 0x00, 0x42, 0x00, 0x3c, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x02, 0x00, 0x07, 0x00, 0x02, 0x00, 
-    0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x02, 0x00, 0x06, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x42, 0x00, 0x42, 0x00, 
-    0x42, 0x00, 0x42, 0x00, 0x42, 0x00, 0x42, 0x00, 0x42, 0x00, 0x62, 0x00, 0x5c, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc3, 0x00, 0x42, 0x00, 
-    0x62, 0x00, 0x66, 0x00, 0x24, 0x00, 0x34, 0x00, 0x1c, 0x00, 0x18, 0x00, 0x18, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x63, 0x04, 0x63, 0x04, 
-    0x72, 0x06, 0x52, 0x02, 0xd6, 0x02, 0x96, 0x02, 0x9c, 0x03, 0x8c, 0x01, 0x8c, 0x01, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x42, 0x00, 0x26, 0x00, 
-    0x34, 0x00, 0x18, 0x00, 0x18, 0x00, 0x1c, 0x00, 0x34, 0x00, 0x66, 0x00, 0x43, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x43, 0x00, 0x42, 0x00, 
-    0x62, 0x00, 0x26, 0x00, 0x24, 0x00, 0x34, 0x00, 0x1c, 0x00, 0x18, 0x00, 0x18, 0x00, 0x08, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7e, 0x00, 0x60, 0x00, 
-    0x30, 0x00, 0x10, 0x00, 0x18, 0x00, 0x0c, 0x00, 0x04, 0x00, 0x02, 0x00, 0x7f, 0x00, 0x00, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 
-    0x04, 0x00, 0x04, 0x00, 0x02, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 
-    0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 
-    0x04, 0x00, 0x04, 0x00, 0x08, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 0x04, 0x00, 
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
-    0x0c, 0x00, 0x92, 0x00, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
+// Glyph bitmaps for font_freesans_16 (95 glyphs, line height 16)
+static const uint8_t font_freesans_16_bitmaps[] = {
+    0xff, 0x0b, 0x6d, 0x0b, 0xc8, 0x90, 0x20, 0xf1, 0xcf, 0x84, 0x08, 0x99, 0x7f, 0x24, 0x48, 0x98, 
+    0x00, 0x08, 0xdf, 0x3a, 0x99, 0x58, 0x70, 0xd0, 0xc8, 0xe4, 0xda, 0x87, 0x00, 0x1e, 0xc2, 0x8c, 
+    0x10, 0x12, 0x84, 0x06, 0xb3, 0x80, 0x37, 0x00, 0xe4, 0x81, 0xcd, 0x20, 0x21, 0xc4, 0x0c, 0xe1, 
+    0x01, 0x1c, 0x44, 0x88, 0xb0, 0xc1, 0xc1, 0xc1, 0xa6, 0x78, 0x61, 0xe6, 0x79, 0x06, 0x0f, 0x94, 
+    0x94, 0x24, 0x49, 0x24, 0x91, 0x44, 0x92, 0x24, 0x25, 0xa4, 0x3a, 0xa5, 0x00, 0x08, 0x04, 0xe2, 
+    0x8f, 0x40, 0x20, 0x00, 0x03, 0x0f, 0x01, 0x88, 0x44, 0x44, 0x22, 0x22, 0x11, 0x1c, 0x51, 0x30, 
+    0x18, 0x0c, 0x06, 0x83, 0x41, 0x11, 0x07, 0xf4, 0x49, 0x92, 0x24, 0x01, 0xbe, 0x71, 0x10, 0x08, 
+    0x84, 0x71, 0x0c, 0x82, 0xc0, 0x1f, 0xbe, 0x71, 0x10, 0x08, 0xc6, 0x81, 0x81, 0xc1, 0xb1, 0x0f, 
+    0x20, 0x30, 0x38, 0x28, 0x24, 0x26, 0x23, 0xff, 0x20, 0x20, 0x20, 0x7e, 0x81, 0x20, 0xf0, 0x1b, 
+    0x03, 0x81, 0xc1, 0x91, 0x07, 0x1c, 0x51, 0x30, 0xd0, 0x1b, 0x07, 0x83, 0x41, 0x11, 0x07, 0x7f, 
+    0x10, 0x08, 0x82, 0x40, 0x10, 0x08, 0x04, 0x81, 0x00, 0xbe, 0x71, 0x30, 0x38, 0xf6, 0x8d, 0x83, 
+    0xc1, 0xb1, 0x0f, 0x1c, 0x51, 0x30, 0x18, 0x1c, 0x7b, 0x81, 0xc0, 0x91, 0x07, 0x01, 0x01, 0x81, 
+    0x01, 0x80, 0xe0, 0x1c, 0x07, 0x03, 0x1c, 0x70, 0xc0, 0x80, 0x1f, 0x08, 0x07, 0x1c, 0x60, 0xe0, 
+    0x38, 0x07, 0x01, 0xbe, 0x71, 0x10, 0x08, 0x86, 0x61, 0x10, 0x08, 0x00, 0x00, 0x01, 0xe0, 0x03, 
+    0x86, 0x43, 0x80, 0x09, 0x40, 0xe2, 0x66, 0xc4, 0x99, 0x30, 0x26, 0x8c, 0x09, 0x71, 0x66, 0x26, 
+    0xf7, 0x18, 0x00, 0x0c, 0x00, 0x30, 0xc0, 0x01, 0x05, 0x36, 0xc8, 0x30, 0xc2, 0x18, 0x7f, 0x06, 
+    0x19, 0x2c, 0xf0, 0x80, 0x7f, 0x82, 0x05, 0x0a, 0x14, 0x28, 0xd8, 0x9f, 0xc0, 0x01, 0x03, 0x06, 
+    0xfe, 0x07, 0x78, 0x0c, 0x09, 0x0c, 0x10, 0x20, 0x40, 0x80, 0x00, 0x01, 0x05, 0x1a, 0xc2, 0x03, 
+    0x7f, 0x82, 0x05, 0x0a, 0x18, 0x30, 0x60, 0xc0, 0x80, 0x01, 0x03, 0x05, 0xfb, 0x03, 0x90, 0x17, 
+    0x17, 0x17, 0x17, 0x77, 0x11, 0x17, 0x17, 0x17, 0x87, 0xff, 0x40, 0x20, 0x10, 0x08, 0xfc, 0x03, 
+    0x81, 0x40, 0x20, 0x00, 0xf8, 0x10, 0x24, 0xe0, 0x00, 0x01, 0x04, 0x10, 0x7c, 0x80, 0x01, 0x0a, 
+    0x4c, 0x38, 0x9e, 0x10, 0x27, 0x27, 0x27, 0x27, 0x27, 0xb7, 0x27, 0x27, 0x27, 0x27, 0x17, 0xc0, 
+    0x20, 0x08, 0x82, 0x20, 0x08, 0x82, 0x61, 0x38, 0x7b, 0xc1, 0x61, 0x31, 0x19, 0x09, 0x0d, 0x1b, 
+    0x31, 0x21, 0x61, 0xc1, 0x81, 0x81, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x81, 0x40, 0xe0, 0x0f, 
+    0x03, 0x1e, 0xf0, 0xc1, 0x0b, 0x5a, 0xd0, 0xc6, 0x26, 0x32, 0x91, 0xd9, 0x8c, 0x62, 0x1c, 0xe3, 
+    0x08, 0x03, 0x07, 0x1e, 0x6c, 0x98, 0x30, 0x63, 0xcc, 0x90, 0x61, 0x83, 0x07, 0x0e, 0x0c, 0x78, 
+    0x18, 0x22, 0x50, 0x80, 0x01, 0x06, 0x18, 0x60, 0x80, 0x01, 0x0a, 0x64, 0x08, 0x1e, 0x7f, 0xc1, 
+    0x81, 0x81, 0x81, 0xc1, 0x7f, 0x01, 0x01, 0x01, 0x01, 0x01, 0x78, 0x18, 0x22, 0x50, 0x80, 0x01, 
+    0x06, 0x18, 0x60, 0x80, 0x01, 0x0a, 0x65, 0x18, 0x7e, 0x00, 0x02, 0xff, 0x04, 0x16, 0x50, 0x40, 
+    0x81, 0xfd, 0x13, 0x58, 0x40, 0x01, 0x05, 0x14, 0x50, 0xc0, 0x3c, 0xc3, 0x81, 0x01, 0x03, 0x1e, 
+    0x78, 0xc0, 0x81, 0x81, 0x42, 0x3c, 0x90, 0x14, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 
+    0x18, 0x18, 0x04, 0x01, 0x03, 0x06, 0x0c, 0x18, 0x30, 0x60, 0xc0, 0x80, 0x01, 0x03, 0x0a, 0xe2, 
+    0x03, 0x03, 0x0b, 0x6c, 0x90, 0x61, 0x84, 0x31, 0x82, 0x0c, 0x32, 0x58, 0xc0, 0x01, 0x07, 0x0c, 
+    0x83, 0x60, 0xe1, 0x90, 0x70, 0xc8, 0x28, 0x66, 0x16, 0x23, 0x99, 0x90, 0x48, 0x48, 0x34, 0x1c, 
+    0x1e, 0x0c, 0x07, 0x06, 0x03, 0x83, 0x01, 0x83, 0x87, 0x19, 0x61, 0xc3, 0x03, 0x03, 0x0e, 0x16, 
+    0x64, 0x8c, 0x0d, 0x0b, 0x0c, 0x83, 0x07, 0x19, 0x23, 0xc2, 0x06, 0x05, 0x04, 0x08, 0x10, 0x20, 
+    0x40, 0x80, 0x00, 0x81, 0x27, 0x26, 0x27, 0x26, 0x26, 0x27, 0x26, 0x26, 0x17, 0x27, 0x96, 0x4f, 
+    0x92, 0x24, 0x49, 0x12, 0x11, 0x22, 0x22, 0x44, 0x44, 0x88, 0x27, 0x49, 0x92, 0x24, 0x49, 0x0c, 
+    0xa3, 0x48, 0x51, 0x0c, 0x09, 0x3e, 0x41, 0x40, 0x40, 0x7c, 0x47, 0x41, 0x61, 0xde, 0x81, 0x40, 
+    0xa0, 0x33, 0x0a, 0x06, 0x83, 0xc1, 0xe0, 0xa8, 0x03, 0x3c, 0x71, 0x30, 0x10, 0x08, 0x04, 0xc5, 
+    0x3c, 0x80, 0x80, 0x80, 0xbc, 0xc2, 0x81, 0x81, 0x81, 0x81, 0x81, 0xc2, 0xbc, 0x3c, 0x42, 0x81, 
+    0x81, 0xff, 0x01, 0x01, 0xc2, 0x7c, 0x96, 0x2e, 0x49, 0x92, 0x04, 0x5c, 0x71, 0x30, 0x18, 0x0c, 
+    0x06, 0xc5, 0x5c, 0x20, 0x41, 0x10, 0x74, 0x63, 0x18, 0x86, 0x61, 0x18, 0x86, 0xf9, 0x0f, 0xf9, 
+    0x1f, 0x41, 0x10, 0xc4, 0x59, 0xf3, 0x2c, 0x59, 0x14, 0x87, 0xc0, 0x9d, 0x1b, 0x63, 0x08, 0x43, 
+    0x18, 0xc2, 0x10, 0x86, 0x30, 0x84, 0x21, 0x04, 0xdd, 0x18, 0x86, 0x61, 0x18, 0x86, 0x21, 0x3c, 
+    0x42, 0x81, 0x81, 0x81, 0x81, 0x81, 0x42, 0x3c, 0x9d, 0x51, 0x30, 0x18, 0x0c, 0x06, 0x47, 0x9d, 
+    0x00, 0xbc, 0xc2, 0x81, 0x81, 0x81, 0x81, 0x81, 0xc2, 0xbc, 0x80, 0x3d, 0x11, 0x11, 0x11, 0x01, 
+    0xde, 0x18, 0x04, 0x06, 0x0e, 0x86, 0x1e, 0xd2, 0x25, 0x49, 0x92, 0x01, 0x61, 0x18, 0x86, 0x61, 
+    0x18, 0xc6, 0x2e, 0xc3, 0x42, 0x62, 0x66, 0x24, 0x34, 0x1c, 0x18, 0x18, 0x63, 0x1c, 0xa3, 0x9c, 
+    0xa5, 0x64, 0x2d, 0x4b, 0x71, 0x8e, 0x31, 0x8c, 0x01, 0x42, 0x13, 0x0d, 0x83, 0xe1, 0xd0, 0xcc, 
+    0x43, 0x43, 0xa1, 0xd8, 0x44, 0xa2, 0x71, 0x30, 0x18, 0x04, 0x7e, 0x30, 0x0c, 0x82, 0x61, 0x10, 
+    0x04, 0x7f, 0x96, 0x24, 0x29, 0x92, 0x24, 0xd0, 0x93, 0x24, 0x89, 0x92, 0x24, 0x86, 0x24, 0x1c, 
 
 };
 
-// Character widths for font_freesans_16
-static const uint8_t font_freesans_16_widths[] = {
-    4, 5, 5, 9, 9, 14, 11, 3, 5, 5, 6, 9, 4, 5, 4, 6, 
-    9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 4, 4, 9, 9, 9, 9, 
-    16, 11, 11, 11, 11, 10, 10, 12, 12, 4, 8, 11, 9, 14, 12, 13, 
-    11, 13, 11, 11, 10, 12, 11, 15, 11, 11, 10, 4, 6, 4, 8, 11, 
-    4, 9, 9, 8, 9, 9, 5, 9, 9, 4, 4, 9, 3, 13, 9, 9, 
-    9, 9, 5, 8, 5, 9, 8, 12, 8, 8, 8, 5, 4, 5, 8, 
+// Glyph boxes for font_freesans_16
+static const custom_glyph_t font_freesans_16_glyphs[] = {
+    {    0,  0,  0,  0,  0,  5, 0}, // ' '
+    {    0,  1, 12,  2,  3,  6, 0}, // '!'
+    {    2,  3,  4,  1,  4,  6, 0}, // '"'
+    {    4,  9, 11,  0,  4, 10, 0}, // '#'
+    {   17,  7, 13,  1,  3, 10, 0}, // '$'
+    {   29, 14, 11,  0,  4, 15, 0}, // '%'
+    {   49,  9, 11,  1,  4, 12, 0}, // '&'
+    {   62,  1,  4,  1,  4,  4, 0}, // '''
+    {   63,  3, 13,  1,  3,  6, 0}, // '('
+    {   68,  3, 13,  1,  3,  6, 0}, // ')'
+    {   73,  5,  5,  1,  3,  7, 0}, // '*'
+    {   77,  7,  7,  1,  8, 10, 0}, // '+'
+    {   84,  1,  2,  1, 14,  5, 0}, // ','
+    {   85,  4,  1,  1, 10,  6, 0}, // '-'
+    {   86,  1,  1,  1, 14,  5, 0}, // '.'
+    {   87,  4, 12,  0,  3,  7, 0}, // '/'
+    {   93,  7, 11,  1,  4, 10, 0}, // '0'
+    {  103,  3, 11,  2,  4, 10, 0}, // '1'
+    {  108,  7, 11,  1,  4, 10, 0}, // '2'
+    {  118,  7, 11,  1,  4, 10, 0}, // '3'
+    {  128,  8, 11,  0,  4, 10, 0}, // '4'
+    {  139,  7, 11,  1,  4, 10, 0}, // '5'
+    {  149,  7, 11,  1,  4, 10, 0}, // '6'
+    {  159,  7, 11,  1,  4, 10, 0}, // '7'
+    {  169,  7, 11,  1,  4, 10, 0}, // '8'
+    {  179,  7, 11,  1,  4, 10, 0}, // '9'
+    {  189,  1,  9,  1,  6,  5, 0}, // ':'
+    {  191,  1,  9,  1,  7,  5, 0}, // ';'
+    {  193,  8,  8,  1,  7, 10, 0}, // '<'
+    {  201,  8,  4,  1,  9, 10, 1}, // '='
+    {  204,  8,  7,  1,  8, 10, 0}, // '>'
+    {  211,  7, 12,  1,  3, 10, 0}, // '?'
+    {  222, 14, 13,  1,  3, 17, 0}, // '@'
+    {  245, 10, 12,  0,  3, 12, 0}, // 'A'
+    {  260,  9, 12,  1,  3, 12, 0}, // 'B'
+    {  274,  9, 12,  1,  3, 12, 0}, // 'C'
+    {  288,  9, 12,  1,  3, 12, 0}, // 'D'
+    {  302,  8, 12,  1,  3, 11, 1}, // 'E'
+    {  313,  7, 12,  1,  3, 11, 0}, // 'F'
+    {  324, 10, 12,  1,  3, 13, 0}, // 'G'
+    {  339,  9, 12,  1,  3, 13, 1}, // 'H'
+    {  351,  1, 12,  2,  3,  5, 1}, // 'I'
+    {  352,  6, 12,  1,  3,  9, 0}, // 'J'
+    {  361,  8, 12,  1,  3, 12, 0}, // 'K'
+    {  373,  7, 12,  1,  3, 10, 0}, // 'L'
+    {  384, 11, 12,  1,  3, 15, 0}, // 'M'
+    {  401,  9, 12,  1,  3, 13, 0}, // 'N'
+    {  415, 10, 12,  1,  3, 14, 0}, // 'O'
+    {  430,  8, 12,  1,  3, 12, 0}, // 'P'
+    {  442, 10, 13,  1,  3, 14, 0}, // 'Q'
+    {  459, 10, 12,  1,  3, 12, 0}, // 'R'
+    {  474,  8, 12,  1,  3, 12, 0}, // 'S'
+    {  486,  9, 12,  0,  3, 11, 1}, // 'T'
+    {  499,  9, 12,  1,  3, 13, 0}, // 'U'
+    {  513, 10, 12,  0,  3, 12, 0}, // 'V'
+    {  528, 15, 12,  0,  3, 16, 0}, // 'W'
+    {  551,  9, 12,  1,  3, 12, 0}, // 'X'
+    {  565,  9, 12,  1,  3, 12, 0}, // 'Y'
+    {  579,  9, 12,  0,  3, 11, 1}, // 'Z'
+    {  591,  3, 13,  1,  3,  5, 0}, // '['
+    {  596,  4, 12,  0,  3,  7, 0}, // '\'
+    {  602,  3, 13,  0,  3,  5, 0}, // ']'
+    {  607,  6,  6,  1,  4,  9, 0}, // '^'
+    {  612,  0,  0,  0,  0, 12, 0}, // '_'
+    {  612,  2,  2,  1,  3,  5, 0}, // '`'
+    {  613,  8,  9,  0,  6, 10, 0}, // 'a'
+    {  622,  7, 12,  1,  3, 10, 0}, // 'b'
+    {  633,  7,  9,  0,  6,  9, 0}, // 'c'
+    {  641,  8, 12,  0,  3, 10, 0}, // 'd'
+    {  653,  8,  9,  0,  6, 10, 0}, // 'e'
+    {  662,  3, 12,  0,  3,  6, 0}, // 'f'
+    {  667,  7, 10,  0,  6, 10, 0}, // 'g'
+    {  676,  6, 12,  1,  3, 10, 0}, // 'h'
+    {  685,  1, 12,  1,  3,  5, 0}, // 'i'
+    {  687,  1, 13,  0,  3,  5, 0}, // 'j'
+    {  689,  6, 12,  1,  3, 10, 0}, // 'k'
+    {  698,  1, 12,  1,  3,  4, 1}, // 'l'
+    {  699, 11,  9,  1,  6, 14, 0}, // 'm'
+    {  712,  6,  9,  1,  6, 10, 0}, // 'n'
+    {  719,  8,  9,  0,  6, 10, 0}, // 'o'
+    {  728,  7, 10,  1,  6, 10, 0}, // 'p'
+    {  737,  8, 10,  0,  6, 10, 0}, // 'q'
+    {  747,  4,  9,  1,  6,  6, 0}, // 'r'
+    {  752,  6,  9,  1,  6,  9, 0}, // 's'
+    {  759,  3, 11,  0,  4,  6, 0}, // 't'
+    {  764,  6,  9,  1,  6, 10, 0}, // 'u'
+    {  771,  8,  9,  0,  6,  9, 0}, // 'v'
+    {  780, 11,  9,  0,  6, 13, 0}, // 'w'
+    {  793,  7,  9,  0,  6,  9, 0}, // 'x'
+    {  801,  7, 10,  0,  6,  9, 0}, // 'y'
+    {  810,  7,  9,  0,  6,  9, 0}, // 'z'
+    {  818,  3, 13,  1,  3,  6, 0}, // '{'
+    {  823,  1, 13,  2,  3,  5, 1}, // '|'
+    {  824,  3, 13,  1,  3,  6, 0}, // '}'
+    {  829,  7,  3,  1,  8,  9, 0}, // '~'
+};
+
+static const custom_font_range_t font_freesans_16_ranges[] = {
+    {32, 126, 0},
 };
 
 const custom_font_t font_freesans_16 = {
-    .data = font_freesans_16_data,
-    .widths = font_freesans_16_widths,
-    .width = 16,
-    .height = 16,
-    .bytes_per_row = 2,
-    .first_char = 32,
-    .last_char = 126
+    .bitmaps = font_freesans_16_bitmaps,
+    .glyphs = font_freesans_16_glyphs,
+    .ranges = font_freesans_16_ranges,
+    .range_count = 1,
+    .height = 16
 };
 
 #endif // FONT_FONT_FREESANS_16_H
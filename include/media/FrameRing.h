@@ -0,0 +1,138 @@
+// File: include/media/FrameRing.h
+
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "FrameProtocol.h"
+
+// Single-producer/single-consumer queue of frames stored at their real size
+// in one contiguous buffer, so the same RAM holds a few full-size tiles or
+// dozens of small ones. Like SpscQueue it needs no locks: the producer only
+// writes m_head, the consumer only writes m_tail, and the release/acquire
+// pair makes a record visible before the position that publishes it.
+//
+// A record is its size in bytes, the Protocol::Frame and the payload, padded
+// to a multiple of 4 so every payload is word aligned and DMA can read it in
+// place. Records never wrap: one that does not fit before the end of the
+// buffer starts again at offset 0, behind a WRAP marker.
+//   producer: Protocol::Frame* f = r.reserve(length); ...fill f->header and f->payload()...; r.commit();
+//   consumer: Protocol::Frame* f = r.front();        ...use f...;                          r.pop();
+template <size_t CAPACITY>
+class FrameRing {
+    static constexpr uint32_t RECORD_HEADER = sizeof(uint32_t) + sizeof(Protocol::Frame);
+    static_assert(RECORD_HEADER == Protocol::TILE_RECORD_OVERHEAD, "hosts count ring space with this");
+    static_assert(RECORD_HEADER % 4 == 0, "payloads must stay word aligned");
+    static_assert(CAPACITY % 4 == 0, "FrameRing capacity must be a multiple of 4");
+
+public:
+    // Ring bytes taken by a frame with 'payload_length' bytes of payload.
+    static constexpr uint32_t record_size(size_t payload_length) {
+        return (RECORD_HEADER + payload_length + 3) & ~3u;
+    }
+    static constexpr uint32_t MAX_RECORD = record_size(Protocol::MAX_PAYLOAD_SIZE);
+    static_assert(CAPACITY >= 2 * MAX_RECORD, "FrameRing must hold two full-size frames");
+
+    // --- Producer side ---
+    // Returns room for a frame with 'payload_length' bytes of payload, or
+    // nullptr if the ring is too full.
+    Protocol::Frame* reserve(size_t payload_length) {
+        uint32_t size = record_size(payload_length);
+        uint32_t head = m_head.load(std::memory_order_relaxed);
+        uint32_t used = distance(m_tail.load(std::memory_order_acquire), head);
+        uint32_t index = index_of(head);
+        uint32_t skip = size <= CAPACITY - index ? 0 : CAPACITY - index;
+        if (used + skip + size > CAPACITY) return nullptr;
+        m_reserved_skip = skip;
+        m_reserved_size = size;
+        return frame_at(skip ? 0 : index);
+    }
+    // Publishes the frame returned by the last reserve().
+    void commit() {
+        uint32_t head = m_head.load(std::memory_order_relaxed);
+        if (m_reserved_skip) {
+            m_words[index_of(head) / 4] = WRAP;
+            head = advance(head, m_reserved_skip);
+        }
+        m_words[index_of(head) / 4] = m_reserved_size;
+        m_frames_in.store(m_frames_in.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        m_head.store(advance(head, m_reserved_size), std::memory_order_release);
+    }
+    // Ring bytes that frames of any mix of sizes, counted with record_size(),
+    // are sure to fit in. Padding at the end of the buffer makes this less
+    // than the free space when the gap wraps around.
+    uint32_t guaranteed_space() const {
+        uint32_t head = m_head.load(std::memory_order_relaxed);
+        uint32_t tail = m_tail.load(std::memory_order_acquire);
+        uint32_t free = CAPACITY - distance(tail, head);
+        uint32_t head_index = index_of(head);
+        uint32_t tail_index = index_of(tail);
+        if (free == 0 || head_index < tail_index) return free;
+        // The gap runs to the end and on from the start. At most one record
+        // is pushed past the end, wasting less than MAX_RECORD bytes.
+        uint32_t to_end = CAPACITY - head_index;
+        uint32_t split = to_end + tail_index > MAX_RECORD - 4 ? to_end + tail_index - (MAX_RECORD - 4) : 0;
+        return std::max({to_end, tail_index, split});
+    }
+
+    // --- Consumer side ---
+    // Returns the oldest frame, or nullptr if the ring is empty.
+    Protocol::Frame* front() {
+        uint32_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire)) return nullptr;
+        uint32_t index = index_of(tail);
+        if (m_words[index / 4] == WRAP) {
+            // The producer always writes the frame after a marker in the same commit.
+            m_tail.store(advance(tail, CAPACITY - index), std::memory_order_release);
+            index = 0;
+        }
+        return frame_at(index);
+    }
+    // Releases the frame returned by front() back to the producer.
+    void pop() {
+        uint32_t tail = m_tail.load(std::memory_order_relaxed);
+        uint32_t size = m_words[index_of(tail) / 4];
+        m_frames_out.store(m_frames_out.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        m_tail.store(advance(tail, size), std::memory_order_release);
+    }
+
+    // Frames queued.
+    size_t size() const {
+        return m_frames_in.load(std::memory_order_acquire) - m_frames_out.load(std::memory_order_acquire);
+    }
+    bool empty() const { return size() == 0; }
+
+private:
+    static constexpr uint32_t WRAP = 0; // Size word of the padding before the end
+
+    // Positions count bytes modulo 2 * CAPACITY, so a full ring (head - tail
+    // == CAPACITY) is told apart from an empty one for any capacity.
+    static uint32_t advance(uint32_t position, uint32_t bytes) {
+        position += bytes;
+        return position >= 2 * CAPACITY ? position - 2 * CAPACITY : position;
+    }
+    static uint32_t distance(uint32_t from, uint32_t to) {
+        return to >= from ? to - from : to + 2 * CAPACITY - from;
+    }
+    static uint32_t index_of(uint32_t position) {
+        return position >= CAPACITY ? position - CAPACITY : position;
+    }
+    Protocol::Frame* frame_at(uint32_t index) {
+        return reinterpret_cast<Protocol::Frame*>(&m_words[index / 4 + 1]);
+    }
+
+    uint32_t m_words[CAPACITY / 4];
+    std::atomic<uint32_t> m_head{0};
+    std::atomic<uint32_t> m_tail{0};
+    // Free-running frame counts for size().
+    std::atomic<uint32_t> m_frames_in{0};
+    std::atomic<uint32_t> m_frames_out{0};
+    // The last reserve() (producer only).
+    uint32_t m_reserved_skip = 0;
+    uint32_t m_reserved_size = 0;
+};
+
+#endif // FRAME_RING_H
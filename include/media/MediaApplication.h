@@ -7,30 +7,68 @@
 #include "btstack.h"
 #include "Display.h"
 #include "Drawing.h"
+#include "BandRenderer.h"
+#include "Framebuffer.h"
 #include "FrameProtocol.h"
+#include "SpscQueue.h"
+#include "FrameRing.h"
+#include "Crc32.h"
 #include "config.h" 
-#include "pico/sync.h"
-#include <array>
+#include <atomic>
 
 class MediaApplication {
 public:
     MediaApplication();
     void setup();
-    void on_image_tile_received(const Protocol::FrameHeader& frame_header, const uint8_t* payload);
-    void on_valid_tile_received(const Protocol::FrameHeader& frame_header, const uint8_t* payload);
+    bool on_tile_frame(const Protocol::FrameHeader& frame_header, const struct pbuf* p, uint16_t offset);
+    void on_client_connected();
+    void on_client_disconnected();
+    void on_hello(const Protocol::Hello& hello);
+    void on_throughput_sink(const Protocol::FrameHeader& frame_header, const Protocol::ThroughputTest& test,
+                            const struct pbuf* p, uint16_t offset);
+    void on_stats_request();
+    void on_tile_timestamp(const Protocol::TileTimestamp& timestamp);
+    void on_epoch_commit(const Protocol::EpochCommit& commit);
+
+    // --- Display side (core1 when DISPLAY_ON_CORE1, else core0) ---
+    void core1_main();
 
 private:
     void handle_encoder();
     void poll_handler();
+    void process_events();
     static void poll_handler_forwarder(btstack_timer_source_t* ts);
+    static void wakeup_handler_forwarder(btstack_data_source_t* ds, btstack_data_source_callback_type_t callback_type);
+
+    void init_display();
+    bool update_display();
+    bool run_display(uint32_t budget_us);
+    void release_tile();
+    void begin_stream(const Protocol::ImageTileHeader& tile_header, Protocol::Frame* tile);
+    void write_stream_pixels(Protocol::Frame* tile, size_t header_size);
+    void close_stream();
+    void begin_batch(Protocol::Frame* tile);
+    void draw_next_batch_rect(Protocol::Frame* tile);
+    void apply_retained_op(const Protocol::ImageTileHeader& tile_header, const Protocol::Frame* tile);
+    void update_draw_stats(uint32_t now_ms);
+    void fill_stats(Protocol::DeviceStats& stats);
+    void send_pending_acks();
+    void send_tile_nack(uint32_t seq);
+    void send_draw_completions();
+    uint32_t copy_from_chain(uint8_t* dst, const struct pbuf* p, size_t skip, size_t len);
+    void show_status(const char* text, uint16_t color);
 
     MediaControllerDevice m_media_controller;
     RotaryEncoder m_encoder;
     St7789Display m_display;
     Drawing m_drawing;
+    BandRenderer m_band_renderer; // Status line (display side)
+    Framebuffer m_framebuffer; // Retained mode only; allocated in setup()
     TcpServer m_tcp_server;
+    Crc32Copier m_crc_copier;
 
     btstack_timer_source_t m_poll_timer;
+    btstack_data_source_t m_wakeup_source;
     btstack_timer_source_t m_release_timer;
     btstack_timer_source_t m_battery_timer;
     
@@ -44,11 +82,86 @@ private:
     uint32_t m_last_wifi_check = 0;
     // ------------------------------------
 
-    critical_section_t m_tile_queue_crit_sec;
-    static constexpr size_t TILE_QUEUE_SIZE = 4;
-    std::array<Protocol::Frame, TILE_QUEUE_SIZE> m_tile_queue;
-    volatile uint8_t m_queue_head = 0;
-    volatile uint8_t m_queue_tail = 0;
+    // Filled by the TCP receive callback, drained by the display side. Frames
+    // take their real size, so a 200-byte tile does not cost a full slot.
+    // Retained mode gives up part of it for the framebuffer.
+    static constexpr size_t TILE_QUEUE_BYTES = SHADOW_FRAMEBUFFER ? 20 * 1024 : 36 * 1024;
+    using TileQueue = FrameRing<TILE_QUEUE_BYTES>;
+    TileQueue m_tile_queue;
+    // Full-size tiles the empty ring holds wherever it has wrapped to.
+    static constexpr uint8_t TILE_QUEUE_DEPTH = (TILE_QUEUE_BYTES - TileQueue::MAX_RECORD + 4) / TileQueue::MAX_RECORD;
+    // The display side draws straight from the front frame and keeps it leased
+    // until the transfer completes. Tiles freed by the display side, and the
+    // count already reported to the host (core0 only).
+    bool m_tile_leased = false;
+    std::atomic<uint32_t> m_tiles_released{0};
+    uint32_t m_tiles_acked = 0;
+    // Frame bytes of queued and of released tiles, and the count already handed
+    // back to the TCP receive window (core0 only). A new connection starts
+    // returning bytes at m_tile_bytes_queued, past every tile of the old one.
+    uint32_t m_tile_bytes_queued = 0;
+    std::atomic<uint32_t> m_tile_bytes_released{0};
+    uint32_t m_tile_bytes_returned = 0;
+    // Sequence number of the next tile to queue (core0 only).
+    uint32_t m_next_tile_seq = 0;
+    bool m_ack_pending = false;
+
+    // What the panel shows, for session resume (core0 only). m_local_draws
+    // counts drawing the host did not ask for (display side).
+    uint32_t m_session_id = 0;
+    uint32_t m_content_epoch = 0;
+    bool m_epoch_valid = false;
+    bool m_update_open = false;        // Tiles queued since the last commit
+    uint32_t m_update_local_draws = 0; // m_local_draws when the update began
+    uint32_t m_epoch_local_draws = 0;  // m_local_draws the epoch chain assumes
+    std::atomic<uint32_t> m_local_draws{0};
+
+    // TILE_TIMESTAMP waiting for its tile (core0 only).
+    Protocol::TileTimestamp m_pending_timestamp = {};
+    bool m_timestamp_pending = false;
+    // Timed tiles whose slots were released, on their way from the display
+    // side to core0, which sends them as DRAW_COMPLETE.
+    SpscQueue<Protocol::DrawComplete, 8> m_draw_completions;
+
+    // Streamed tile window (display side only), and the connection that opened it.
+    bool m_stream_open = false;
+    uint32_t m_stream_remaining = 0;
+    uint8_t m_stream_connection = 0;
+    // Counts client disconnects; queued frames are tagged with it (written by core0).
+    std::atomic<uint8_t> m_connection{0};
+
+    // Progress through the leased batch tile (display side only).
+    uint16_t m_batch_rect = 0;
+    uint16_t m_batch_rect_count = 0;
+    size_t m_batch_pixel_offset = 0;
+
+    // Display throughput: rows started by the display side, sampled on core0.
+    std::atomic<uint32_t> m_rows_drawn{0};
+    uint32_t m_stats_window_start_ms = 0;
+    uint32_t m_stats_window_rows = 0;
+    uint32_t m_rows_per_second = 0;
+    std::atomic<uint32_t> m_rle_pixels{0};
+    std::atomic<uint32_t> m_rle_decode_us{0};
+    uint32_t m_stats_window_rle_pixels = 0;
+    uint32_t m_stats_window_rle_us = 0;
+
+    // Telemetry (Protocol::DeviceStats). m_stats holds the counters kept on
+    // core0; the display side publishes its draw times through the atomics.
+    Protocol::DeviceStats m_stats = {};
+    uint32_t m_tile_start_us = 0; // Display side
+    std::atomic<uint32_t> m_draw_us_total{0};
+    std::atomic<uint32_t> m_draw_us_max{0};
+    uint32_t m_stats_window_draw_us = 0;
+    uint32_t m_stats_window_draws = 0;
+    uint32_t m_poll_armed_us = 0;
+    uint32_t m_poll_jitter_window_us = 0;
+
+    // Status line mailbox: core0 posts, the display side draws.
+    // The text must be a string literal.
+    std::atomic<const char*> m_status_text{nullptr};
+    std::atomic<uint16_t> m_status_color{0};
+    std::atomic<uint32_t> m_status_seq{0};
+    uint32_t m_status_drawn_seq = 0;
 
     static void release_handler_forwarder(btstack_timer_source_t* ts);
     static void battery_timer_handler_forwarder(btstack_timer_source_t* ts);
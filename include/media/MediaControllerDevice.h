@@ -4,6 +4,7 @@
 #define MEDIA_CONTROLLER_DEVICE_H
 
 #include "HidDevice.h"
+#include "FrameProtocol.h"
 #include <cstdint>
 
 class MediaControllerDevice : public HidDevice {
@@ -11,6 +12,8 @@ public:
     void setup() override;
     void enterSetupMode();
     void setBatteryLevel(uint8_t level);
+    // Stores the telemetry characteristic's value and notifies a subscribed client.
+    void updateStats(const Protocol::DeviceStats& stats);
 
     // Media Control Methods
     void increaseVolume();
@@ -27,8 +30,16 @@ protected:
     uint16_t getHidDescriptorSize() const override;
     const uint8_t* getAdvertisingData() const override;
     uint16_t getAdvertisingDataSize() const override;
+    void onConnectionChanged_impl() override;
 
     bool m_setup_mode = false;
+
+private:
+    friend uint16_t att_read_callback(hci_con_handle_t con_handle, uint16_t att_handle, uint16_t offset, uint8_t* buffer, uint16_t buffer_size);
+    friend int att_write_callback(hci_con_handle_t con_handle, uint16_t att_handle, uint16_t transaction_mode, uint16_t offset, uint8_t* buffer, uint16_t buffer_size);
+
+    Protocol::DeviceStats m_stats = {};
+    bool m_stats_notify = false;
 };
 
 #endif // MEDIA_CONTROLLER_DEVICE_H
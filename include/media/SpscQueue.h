@@ -0,0 +1,61 @@
+// File: include/media/SpscQueue.h
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Fixed-size single-producer/single-consumer queue. The producer and consumer
+// may run on different cores (or in an IRQ and the main loop) without locks:
+// each index is written by one side only, and the release/acquire pair makes
+// the slot contents visible before the index that publishes them.
+//
+// Slots are filled and drained in place to avoid copying large elements:
+//   producer: T* slot = q.reserve(); ...fill slot...; q.commit();
+//   consumer: T* slot = q.front();   ...use slot...;  q.pop();
+template <typename T, size_t N>
+class SpscQueue {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+
+public:
+    // --- Producer side ---
+    // Returns the next free slot, or nullptr if the queue is full.
+    T* reserve() {
+        uint32_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) == N) return nullptr;
+        return &m_slots[head & (N - 1)];
+    }
+    // Publishes the slot returned by reserve().
+    void commit() {
+        m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // --- Consumer side ---
+    // Returns the oldest element, or nullptr if the queue is empty.
+    T* front() {
+        uint32_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire)) return nullptr;
+        return &m_slots[tail & (N - 1)];
+    }
+    // Releases the slot returned by front() back to the producer.
+    void pop() {
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    size_t size() const {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+    bool empty() const { return size() == 0; }
+
+private:
+    // Word aligned so DMA can read packed elements in place.
+    alignas(4) std::array<T, N> m_slots;
+    // Free-running counters; only the low bits select a slot.
+    std::atomic<uint32_t> m_head{0};
+    std::atomic<uint32_t> m_tail{0};
+};
+
+#endif // SPSC_QUEUE_H
@@ -3,8 +3,8 @@
 #ifndef FRAME_PROTOCOL_H
 #define FRAME_PROTOCOL_H
 
+#include <cstddef>
 #include <cstdint>
-#include <array>
 
 // Use pragma pack to ensure the compiler doesn't add padding bytes.
 #pragma pack(push, 1)
@@ -12,18 +12,45 @@
 namespace Protocol {
 
     constexpr uint8_t FRAME_MAGIC = 0xAA;
+
+    // Bumped whenever a frame layout changes. Sent in HELLO and CAPS.
+    constexpr uint8_t PROTOCOL_VERSION = 1;
     
     // Maximum possible size for any frame's payload.
     // From config.py: TILE_PAYLOAD_SIZE = 8192
     constexpr size_t MAX_PAYLOAD_SIZE = 8192;
 
     enum class FrameType : uint8_t {
-        THROUGHPUT_TEST = 0x01,
+        THROUGHPUT_TEST = 0x01, // ThroughputTest + filler; answered with an echo or a ThroughputReply
         IMAGE_TILE      = 0x02,
-        TILE_ACK        = 0x03,
-        TILE_NACK       = 0x04
+        TILE_ACK        = 0x03, // TileAck, device -> host
+        TILE_NACK       = 0x04, // TileNack, device -> host
+        IMAGE_TILE_RLE  = 0x05, // ImageTileHeader + RLE pixel data (see below)
+        IMAGE_TILE_PALETTE = 0x06, // ImageTileHeader + PaletteTileHeader + palette + indices
+        IMAGE_STREAM_BEGIN = 0x07, // ImageTileHeader opening a window of any size + first pixels
+        IMAGE_STREAM_DATA  = 0x08, // StreamChunkHeader + more pixels for the open window
+        IMAGE_BATCH        = 0x09, // ImageTileHeader + BatchHeader + BatchRects + pixels
+        HELLO              = 0x0A, // Hello, host -> device
+        CAPS               = 0x0B, // Capabilities, device -> host
+        STATS              = 0x0C, // Empty request from the host; answered with DeviceStats
+        TILE_TIMESTAMP     = 0x0D, // TileTimestamp, host -> device, just before the tile it names
+        DRAW_COMPLETE      = 0x0E, // DrawComplete, device -> host
+        EPOCH_COMMIT       = 0x0F, // EpochCommit, host -> device, after the tiles of an update
+        SESSION            = 0x10, // SessionInfo, device -> host, right after CAPS
+        COPY_RECT          = 0x11, // ImageTileHeader (source rectangle) + CopyRect
+        SCROLL_RECT        = 0x12, // ImageTileHeader + ScrollRect
+        REDRAW_REGION      = 0x13  // ImageTileHeader only
     };
 
+    // Frames that carry a CRC and a sequence number and go through the tile queue.
+    constexpr bool is_tile_frame(FrameType type) {
+        return type == FrameType::IMAGE_TILE || type == FrameType::IMAGE_TILE_RLE ||
+               type == FrameType::IMAGE_TILE_PALETTE || type == FrameType::IMAGE_STREAM_BEGIN ||
+               type == FrameType::IMAGE_STREAM_DATA || type == FrameType::IMAGE_BATCH ||
+               type == FrameType::COPY_RECT || type == FrameType::SCROLL_RECT ||
+               type == FrameType::REDRAW_REGION;
+    }
+
     struct FrameHeader {
         uint8_t   magic;
         FrameType type;
@@ -36,12 +63,242 @@ namespace Protocol {
         uint16_t width;
         uint16_t height;
         uint32_t crc32;
+        uint32_t seq;    // Tile sequence number, starts at 0 for each connection
+    };
+
+    // IMAGE_BATCH carries several small rectangles in one frame, drawn in order
+    // and acknowledged as one tile. The ImageTileHeader holds their bounding
+    // box; rect_count BatchRects follow the BatchHeader, then the raw RGB565
+    // pixels of every rectangle, back to back.
+    struct BatchHeader {
+        uint16_t rect_count;
+    };
+
+    struct BatchRect {
+        uint16_t x;
+        uint16_t y;
+        uint16_t width;
+        uint16_t height;
+    };
+
+    // Streamed tiles: IMAGE_STREAM_BEGIN's ImageTileHeader opens a window of
+    // width * height pixels, which is not limited by MAX_PAYLOAD_SIZE. Its
+    // payload and that of each following IMAGE_STREAM_DATA frame are raw
+    // RGB565 pixels in row-major order, forwarded to the panel chunk by chunk.
+    // Each chunk has its own CRC and sequence number and is flow controlled
+    // like a tile. The window closes once width * height pixels have arrived;
+    // any other tile frame before that closes it early (the rest is black).
+    struct StreamChunkHeader {
+        uint32_t crc32;
+        uint32_t seq;
+    };
+
+    // Retained mode (FEATURE_RETAINED): the device keeps a framebuffer, so the
+    // host can move pixels that are already on the panel instead of resending
+    // them. These frames are sequenced, CRC-checked (over what follows the
+    // ImageTileHeader) and acknowledged like tiles, so they apply in order
+    // with the tiles around them. The ImageTileHeader gives the rectangle.
+    //   COPY_RECT:     copies the rectangle to (dst_x, dst_y); they may overlap.
+    //   SCROLL_RECT:   moves the rectangle's content by (dx, dy) within it and
+    //                  fills the uncovered pixels with fill_color.
+    //   REDRAW_REGION: sends the rectangle from the framebuffer to the panel
+    //                  again, e.g. after the panel was reset.
+    struct CopyRect {
+        uint16_t dst_x;
+        uint16_t dst_y;
+    };
+
+    struct ScrollRect {
+        int16_t  dx;
+        int16_t  dy;
+        uint16_t fill_color; // RGB565
+        uint16_t reserved;
+    };
+
+    // THROUGHPUT_TEST measures the transport without drawing anything. The
+    // payload is a ThroughputTest header followed by filler bytes.
+    //   THROUGHPUT_ECHO: the whole frame is sent back unchanged.
+    //   THROUGHPUT_SINK: the frame is answered with a ThroughputReply. With
+    //                    THROUGHPUT_FLAG_CRC the filler is also copied and
+    //                    checked the way a tile is, and the reply says how long
+    //                    that took.
+    // Test frames are not sequenced and do not use tile credits.
+    constexpr uint8_t THROUGHPUT_ECHO = 0;
+    constexpr uint8_t THROUGHPUT_SINK = 1;
+    constexpr uint8_t THROUGHPUT_FLAG_CRC = 0x01;
+
+    struct ThroughputTest {
+        uint8_t  mode;     // THROUGHPUT_ECHO or THROUGHPUT_SINK
+        uint8_t  flags;    // THROUGHPUT_FLAG_* bits
+        uint16_t reserved;
+        uint32_t id;       // Returned in the reply so the host can match it
+    };
+
+    struct ThroughputReply {
+        uint32_t id;
+        uint32_t bytes;    // Filler bytes received
+        uint32_t crc32;    // CRC-32 of the filler (THROUGHPUT_FLAG_CRC only)
+        uint32_t crc_us;   // Time spent copying and checking the filler
+    };
+
+    // Flow control for image tiles. The device accepts tiles strictly in
+    // sequence order and advertises how much of its tile queue is free; the
+    // host may send any tile with seq < next_seq + credits or, if it reads
+    // credit_bytes, any run of tiles from next_seq whose queue cost fits in
+    // it. ACKs are cumulative and are sent when a connection opens and
+    // whenever queued tiles are released.
+    struct TileAck {
+        uint32_t next_seq;     // Every tile before this one has been queued
+        uint8_t  credits;      // Full-size tiles that surely fit
+        uint32_t credit_bytes; // Queue bytes free for the tiles from next_seq on
+    };
+
+    // Tile queue bytes a frame costs: its payload plus this, rounded up to a
+    // multiple of 4. Hosts use it to spend credit_bytes.
+    constexpr size_t TILE_RECORD_OVERHEAD = 24;
+
+    // Sent when the expected tile fails its CRC check or cannot be queued.
+    // Tiles after it are dropped until it is resent, so the host resends
+    // from seq onwards.
+    struct TileNack {
+        uint32_t seq;
+    };
+
+    // IMAGE_TILE_RLE pixel data is a sequence of ops, decoded row by row. An op
+    // never crosses the end of a row, and the CRC covers the encoded bytes.
+    // Pixels are little-endian RGB565, as in IMAGE_TILE.
+    //   0x00-0x7F  literal: (op & 0x7F) + 1 pixels follow
+    //   0x80-0xBF  run:     one pixel follows, repeated (op & 0x3F) + 1 times
+    //   0xC0-0xFF  copy up: (op & 0x3F) + 1 pixels are copied from the row above
+    constexpr uint8_t RLE_OP_REPEAT  = 0x80; // Set for run and copy up
+    constexpr uint8_t RLE_OP_COPY_UP = 0x40; // Distinguishes copy up from run
+    constexpr size_t  RLE_MAX_LITERAL = 128;
+    constexpr size_t  RLE_MAX_REPEAT  = 64;
+
+    // IMAGE_TILE_PALETTE: palette_size + 1 RGB565 entries follow this header,
+    // then the pixel indices. Each row starts on a byte boundary; within a
+    // byte the first pixel is in the least significant bits.
+    struct PaletteTileHeader {
+        uint8_t bits_per_pixel;  // 1, 2, 4 or 8
+        uint8_t palette_size;    // Number of entries - 1
+    };
+
+    // Handshake. The host sends HELLO right after connecting and the device
+    // answers with CAPS, so the host does not have to assume this firmware's
+    // limits. A device that never answers predates the handshake; the host
+    // then falls back to raw IMAGE_TILE frames and its own defaults.
+    struct Hello {
+        uint8_t protocol_version; // Highest version the host speaks
     };
 
-    // A structure to hold a complete, parsed frame using a fixed-size buffer
+    constexpr uint8_t PIXEL_FORMAT_RGB565_LE = 0x01;
+
+    constexpr uint16_t CODEC_RLE     = 0x0001; // IMAGE_TILE_RLE
+    constexpr uint16_t CODEC_PALETTE = 0x0002; // IMAGE_TILE_PALETTE
+    constexpr uint16_t CODEC_STREAM  = 0x0004; // IMAGE_STREAM_BEGIN / IMAGE_STREAM_DATA
+    constexpr uint16_t CODEC_BATCH   = 0x0008; // IMAGE_BATCH
+
+    constexpr uint8_t FEATURE_STATS      = 0x01; // STATS
+    constexpr uint8_t FEATURE_DRAW_TIMING = 0x02; // TILE_TIMESTAMP / DRAW_COMPLETE
+    constexpr uint8_t FEATURE_SESSION    = 0x04; // EPOCH_COMMIT / SESSION
+    constexpr uint8_t FEATURE_RETAINED   = 0x08; // COPY_RECT / SCROLL_RECT / REDRAW_REGION
+
+    struct Capabilities {
+        uint8_t  protocol_version;
+        uint8_t  pixel_formats;      // PIXEL_FORMAT_* bits
+        uint16_t codecs;             // CODEC_* bits; raw IMAGE_TILE is always supported
+        uint16_t panel_width;
+        uint16_t panel_height;
+        uint16_t max_payload;        // Largest payload_length accepted
+        uint16_t max_tile_pixels;    // Largest raw tile or batch rectangle
+        uint8_t  queue_depth;        // Full-size tiles the empty tile queue holds (credits)
+        uint8_t  features;           // FEATURE_* bits
+        uint16_t preferred_tile_width;
+        uint16_t preferred_tile_height;
+    };
+
+    // Session resume. After all tiles of an update are queued the host sends
+    // EPOCH_COMMIT with a number for the resulting image. The device reports
+    // its boot session and last epoch in SESSION on every HELLO; if both match
+    // what the host committed and SESSION_EPOCH_VALID is set, the panel (once
+    // the queue drains) shows exactly that image and the host can keep
+    // diffing against it instead of resending the whole screen.
+    // The epoch is only valid if the chain started with an EPOCH_FULL_FRAME
+    // commit, every later update was committed, and nothing was drawn by the
+    // device itself (such as the status line) since.
+    constexpr uint8_t EPOCH_FULL_FRAME = 0x01;
+
+    struct EpochCommit {
+        uint32_t epoch;
+        uint8_t  flags;      // EPOCH_* bits
+    };
+
+    constexpr uint8_t SESSION_EPOCH_VALID = 0x01;
+
+    struct SessionInfo {
+        uint32_t session_id; // Random, chosen at boot
+        uint32_t epoch;      // Last committed epoch
+        uint8_t  flags;      // SESSION_* bits
+    };
+
+    // Latency measurement. A TILE_TIMESTAMP sent right before a tile frame
+    // marks that tile (by seq) as timed. Once its slot is released, after the
+    // last pixel has been handed to the panel, the device answers with
+    // DRAW_COMPLETE. Device times are time_us_32() values; only differences
+    // between them mean anything to the host. Tiles that are dropped or
+    // resent lose their timestamp.
+    struct TileTimestamp {
+        uint32_t seq;
+        uint32_t host_time;   // Opaque to the device, returned as is
+    };
+
+    struct DrawComplete {
+        uint32_t seq;
+        uint32_t host_time;
+        uint32_t received_us; // Tile checked and queued
+        uint32_t dequeued_us; // Display side started it
+        uint32_t completed_us;
+    };
+
+    // Runtime counters, for sizing queues and spotting regressions in the
+    // field. Also the value of the BLE telemetry characteristic. Counters
+    // run from boot and wrap; "interval" values cover the last
+    // DRAW_STATS_INTERVAL_MS.
+    struct DeviceStats {
+        uint32_t uptime_ms;
+        uint32_t tiles_received;     // Tile frames queued
+        uint32_t bytes_received;     // TCP payload bytes, all frames
+        uint32_t crc_failures;
+        uint32_t tiles_dropped;      // Out of sequence or queue full
+        uint32_t tiles_drawn;
+        uint32_t draw_us_avg;        // Dequeue to slot release, interval average
+        uint32_t draw_us_max;
+        uint32_t poll_jitter_us;     // Worst poll tick lateness, interval
+        uint32_t poll_jitter_max_us;
+        uint16_t lwip_mem_used;      // lwIP heap bytes (0 without MEM_STATS)
+        uint16_t lwip_mem_max;
+        uint16_t pbuf_pool_used;     // PBUF_POOL entries (0 without MEMP_STATS)
+        uint16_t pbuf_pool_max;
+        uint8_t  queue_depth;        // Full-size tiles the empty tile queue holds
+        uint8_t  queue_used;         // Frames queued, of any size (capped at 255)
+        uint8_t  queue_high_water;
+        uint8_t  reserved;
+    };
+
+    // A parsed frame in the device's tile queue. Its header.payload_length
+    // bytes of payload follow it directly (see FrameRing.h).
     struct Frame {
         FrameHeader header;
-        std::array<uint8_t, MAX_PAYLOAD_SIZE> payload;
+        // Filled in by the device when the frame is queued; not sent.
+        uint32_t seq;
+        uint32_t received_us;
+        uint32_t host_time;
+        bool     timed;       // A TILE_TIMESTAMP named this tile
+        uint8_t  connection;  // Client connection that sent it (wraps)
+        uint8_t  reserved[2]; // Keeps the payload word aligned
+
+        uint8_t* payload() { return reinterpret_cast<uint8_t*>(this + 1); }
+        const uint8_t* payload() const { return reinterpret_cast<const uint8_t*>(this + 1); }
     };
 
 } // namespace Protocol
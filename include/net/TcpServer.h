@@ -4,7 +4,6 @@
 #include "lwip/tcp.h"
 #include "lwip/pbuf.h"
 #include "FrameProtocol.h"
-#include "pico/sync.h"
 #include <array>
 #include <cstdint>
 
@@ -19,28 +18,35 @@ public:
     void close(); // <--- NEW: Explicitly close server
     void poll();
     err_t send_frame(Protocol::FrameType type, const uint8_t* payload, uint16_t len);
+    void release_rx_window(size_t len);
+    uint32_t bytes_received() const { return m_rx_bytes_total; }
 
 private:
     static err_t tcp_accept_callback(void *arg, struct tcp_pcb *newpcb, err_t err);
     static err_t tcp_recv_callback(void *arg, struct tcp_pcb *tpcb, struct pbuf *p, err_t err);
+    static err_t tcp_sent_callback(void *arg, struct tcp_pcb *tpcb, u16_t len);
     static void tcp_err_callback(void *arg, err_t err);
 
     err_t _recv_callback(struct tcp_pcb *tpcb, struct pbuf *p, err_t err);
+    void _process_rx();
+    bool _handle_throughput_test(const Protocol::FrameHeader& header);
+    bool _echo_frame(size_t len);
     void _close_client_connection();
+    void _consume_rx(size_t len, bool reopen_window);
+    void _reset_rx();
 
     MediaApplication* m_app_context;
     struct tcp_pcb *m_server_pcb = nullptr;
     struct tcp_pcb *m_client_pcb = nullptr;
     
-    // Safety
-    critical_section_t m_buffer_crit_sec;
     uint32_t m_last_activity_time_ms = 0;
 
-    // Buffers
-    static constexpr size_t RX_BUFFER_SIZE = Protocol::MAX_PAYLOAD_SIZE * 2;
-    std::array<uint8_t, RX_BUFFER_SIZE> m_rx_buffer;
-    volatile size_t m_rx_head = 0;
-    volatile size_t m_rx_tail = 0;
+    // Received data not yet parsed. Frames are read in place from the chain.
+    struct pbuf* m_rx_chain = nullptr;
+    // Bytes received but not yet returned to the TCP window
+    size_t m_rx_unacked = 0;
+    // Every byte received since boot (wraps)
+    uint32_t m_rx_bytes_total = 0;
 };
 
 #endif // TCPSERVER_H
\ No newline at end of file
@@ -18,12 +18,77 @@ TILE_PAYLOAD_SIZE = 8192
 FRAME_MAGIC = 0xAA
 FRAME_HEADER_FORMAT = "<BBH"
 FRAME_HEADER_SIZE = struct.calcsize(FRAME_HEADER_FORMAT)
+FRAME_TYPE_THROUGHPUT_TEST = 0x01 # THROUGHPUT_TEST_FORMAT + filler, see transport_bench.py
 FRAME_TYPE_IMAGE_TILE = 0x02
 FRAME_TYPE_TILE_ACK = 0x03 # Re-enabled
 FRAME_TYPE_TILE_NACK = 0x04 # Re-enabled
-IMAGE_TILE_HEADER_FORMAT = "<HHHHI"  # x, y, width, height, crc32
+FRAME_TYPE_IMAGE_TILE_RLE = 0x05 # Same header, RLE pixel data (see tile_codec.py)
+FRAME_TYPE_IMAGE_TILE_PALETTE = 0x06 # Same header, palette + 1/2/4/8-bit indices
+FRAME_TYPE_IMAGE_STREAM_BEGIN = 0x07 # Same header for the whole window, then raw pixels
+FRAME_TYPE_IMAGE_STREAM_DATA = 0x08 # STREAM_CHUNK_HEADER_FORMAT, then more raw pixels
+FRAME_TYPE_IMAGE_BATCH = 0x09 # Same header (bounding box), BATCH_HEADER_FORMAT, rects, raw pixels
+FRAME_TYPE_HELLO = 0x0A # HELLO_FORMAT, sent right after connecting
+FRAME_TYPE_CAPS = 0x0B # CAPS_FORMAT, the device's answer to HELLO
+FRAME_TYPE_STATS = 0x0C # Empty request; the device answers with STATS_FORMAT
+FRAME_TYPE_TILE_TIMESTAMP = 0x0D # TILE_TIMESTAMP_FORMAT, sent just before the tile it names
+FRAME_TYPE_DRAW_COMPLETE = 0x0E # DRAW_COMPLETE_FORMAT, once a timed tile is on the panel
+FRAME_TYPE_EPOCH_COMMIT = 0x0F # EPOCH_COMMIT_FORMAT, after the tiles of each update
+FRAME_TYPE_SESSION = 0x10 # SESSION_FORMAT, sent by the device right after CAPS
+FRAME_TYPE_COPY_RECT = 0x11 # Tile header (source rect), COPY_RECT_FORMAT; retained mode
+FRAME_TYPE_SCROLL_RECT = 0x12 # Tile header, SCROLL_RECT_FORMAT; retained mode
+FRAME_TYPE_REDRAW_REGION = 0x13 # Tile header only; retained mode
+PROTOCOL_VERSION = 1
+HELLO_FORMAT = "<B"  # protocol_version
+# protocol_version, pixel_formats, codecs, panel_width, panel_height, max_payload,
+# max_tile_pixels, queue_depth, features, preferred_tile_width, preferred_tile_height
+CAPS_FORMAT = "<BBHHHHHBBHH"
+CODEC_RLE = 0x0001
+CODEC_PALETTE = 0x0002
+CODEC_STREAM = 0x0004
+CODEC_BATCH = 0x0008
+FEATURE_STATS = 0x01
+FEATURE_DRAW_TIMING = 0x02
+FEATURE_SESSION = 0x04
+FEATURE_RETAINED = 0x08  # COPY_RECT / SCROLL_RECT / REDRAW_REGION (device framebuffer)
+EPOCH_COMMIT_FORMAT = "<IB"  # epoch, flags
+EPOCH_FULL_FRAME = 0x01
+SESSION_FORMAT = "<IIB"  # session_id, epoch, flags
+SESSION_EPOCH_VALID = 0x01
+TILE_TIMESTAMP_FORMAT = "<II"  # seq, host_time (microseconds, wraps)
+DRAW_COMPLETE_FORMAT = "<IIIII"  # seq, host_time, received_us, dequeued_us, completed_us (device clock)
+STATS_FIELDS = ("uptime_ms", "tiles_received", "bytes_received", "crc_failures", "tiles_dropped",
+                "tiles_drawn", "draw_us_avg", "draw_us_max", "poll_jitter_us", "poll_jitter_max_us",
+                "lwip_mem_used", "lwip_mem_max", "pbuf_pool_used", "pbuf_pool_max",
+                "queue_depth", "queue_used", "queue_high_water", "reserved")
+STATS_FORMAT = "<10I4H4B"  # Protocol::DeviceStats, also the BLE telemetry characteristic (FF02)
+HELLO_TIMEOUT_SECONDS = 2.0 # Firmware without the handshake never answers
+THROUGHPUT_TEST_FORMAT = "<BBHI"  # mode, flags, reserved, id
+THROUGHPUT_TEST_SIZE = struct.calcsize(THROUGHPUT_TEST_FORMAT)
+THROUGHPUT_REPLY_FORMAT = "<IIII"  # id, bytes, crc32, crc_us
+THROUGHPUT_ECHO = 0
+THROUGHPUT_SINK = 1
+THROUGHPUT_FLAG_CRC = 0x01
+IMAGE_TILE_HEADER_FORMAT = "<HHHHII"  # x, y, width, height, crc32, seq
+TILE_ACK_FORMAT = "<IB"  # next_seq, credits (full-size tiles that fit)
+TILE_ACK_BYTES_FORMAT = "<IBI"  # ...then credit_bytes (free tile queue bytes), newer firmware
+TILE_RECORD_OVERHEAD = 24  # Tile queue bytes a frame costs on top of its payload, before rounding up to 4
+TILE_NACK_FORMAT = "<I"  # seq to resend from
 IMAGE_TILE_HEADER_SIZE = struct.calcsize(IMAGE_TILE_HEADER_FORMAT)
-MAX_PIXEL_DATA_SIZE = TILE_PAYLOAD_SIZE - IMAGE_TILE_HEADER_SIZE
+MAX_PIXEL_DATA_SIZE = TILE_PAYLOAD_SIZE - IMAGE_TILE_HEADER_SIZE # Until CAPS says otherwise
+MAX_TILE_PIXELS = 4096 # Device's MAX_DRAW_BUFFER_PIXELS, until CAPS says otherwise
+STREAM_CHUNK_HEADER_FORMAT = "<II"  # crc32, seq
+STREAM_CHUNK_HEADER_SIZE = struct.calcsize(STREAM_CHUNK_HEADER_FORMAT)
+USE_RLE_TILES = True # Send RLE tiles when they cover more rows than a raw tile
+USE_PALETTE_TILES = True # Same for palette tiles
+USE_STREAMED_TILES = True # Send large uncompressible updates as one streamed window
+BATCH_HEADER_FORMAT = "<H"  # rect_count
+BATCH_RECT_FORMAT = "<HHHH"  # x, y, width, height
+USE_BATCH_FRAMES = True # Send scattered small changes as separate rects in one frame
+BATCH_MERGE_GAP = 8 # Changed areas closer than this (pixels) share a rect
+COPY_RECT_FORMAT = "<HH"  # dst_x, dst_y
+SCROLL_RECT_FORMAT = "<hhHH"  # dx, dy, fill_color, reserved
+USE_RETAINED_SCROLL = True # On a retained-mode device, send vertical scrolls as SCROLL_RECT
+SCROLL_MIN_ROWS = 8 # Rows a scroll must save before it is worth a frame
 
 # -- Location & Weather --
 LOCATION_LAT = 49.4247
@@ -1,116 +1,204 @@
 # File: create_font.py
 
 import argparse
-import math
+import re
 from PIL import Image, ImageDraw, ImageFont
 
-def generate_font_data(ttf_path, size, first_char=32, last_char=126):
+# Matches GLYPH_RLE in CustomFont.h.
+GLYPH_RLE = 0x01
+
+def crop_to_ink(rows):
+    """Trims blank rows and columns; returns the rows and the offset of the kept box."""
+    inked_rows = [y for y, row in enumerate(rows) if any(row)]
+    if not inked_rows:
+        return [], 0, 0
+    inked_cols = [x for x in range(len(rows[0])) if any(row[x] for row in rows)]
+    top, bottom = inked_rows[0], inked_rows[-1] + 1
+    left, right = inked_cols[0], inked_cols[-1] + 1
+    return [row[left:right] for row in rows[top:bottom]], left, top
+
+def render_ttf_glyphs(ttf_path, size, codes):
     try:
         font = ImageFont.truetype(ttf_path, size)
     except IOError:
         print(f"Error: Could not load font file at '{ttf_path}'")
-        return None, None, 0, 0, 0
-
-    max_width = 0
-    max_height = 0
-    char_widths = []
-
-    # First pass: find max dimensions and individual widths
-    for i in range(first_char, last_char + 1):
-        char = chr(i)
-        try:
-            bbox = font.getbbox(char)
-            char_width = bbox[2] - bbox[0]
-            char_height = bbox[3] - bbox[1]
-        except AttributeError: # Fallback for older Pillow versions
-            char_width, char_height = font.getsize(char)
-
-        char_widths.append(char_width if char_width > 0 else 1) # Store individual width
-        if char_width > max_width:
-            max_width = char_width
-        if char_height > max_height:
-            max_height = char_height
-    
-    if max_width == 0 or max_height == 0:
-        print("Warning: Font could not be rendered.")
-        return None, None, 0, 0, 0
-
-    bytes_per_row = math.ceil(max_width / 8.0)
-    font_data = bytearray()
-    
-    print(f"Generating font. Max character size: {max_width}x{max_height} pixels")
-
-    # Second pass: render characters into the bitmap
-    for char_code in range(first_char, last_char + 1):
-        char = chr(char_code)
-        image = Image.new('1', (max_width, max_height), 0)
-        draw = ImageDraw.Draw(image)
-        draw.text((0, 0), char, font=font, fill=1)
-
-        for y in range(max_height):
-            for byte_idx in range(bytes_per_row):
-                byte = 0
-                for bit_idx in range(8):
-                    x = byte_idx * 8 + bit_idx
-                    if x >= max_width:
-                        break
-                    if image.getpixel((x, y)) > 0:
-                        byte |= (1 << bit_idx)
-                font_data.append(byte)
-
-    return font_data, bytearray(char_widths), max_width, max_height, bytes_per_row
-
-def write_c_header(output_path, var_name, font_data, char_widths, width, height, bytes_per_row, first_char, last_char):
+        return None, 0
+
+    ascent, descent = font.getmetrics()
+    glyphs = []
+    for code in codes:
+        char = chr(code)
+        advance = round(font.getlength(char))
+        # The box is relative to the pen, with y = 0 at the top of the ascent.
+        left, top, right, bottom = font.getbbox(char)
+        rows, x_offset, y_offset = [], 0, 0
+        if right > left and bottom > top:
+            image = Image.new('1', (right - left, bottom - top), 0)
+            ImageDraw.Draw(image).text((-left, -top), char, font=font, fill=1)
+            pixels = [[1 if image.getpixel((x, y)) else 0 for x in range(right - left)] for y in range(bottom - top)]
+            rows, dx, dy = crop_to_ink(pixels)
+            x_offset, y_offset = left + dx, top + dy
+        glyphs.append({'code': code, 'rows': rows, 'x_offset': x_offset, 'y_offset': y_offset, 'advance': advance})
+
+    # Glyph boxes must lie inside the line: move everything down if some ink
+    # rises above the ascent, and grow the line to the lowest ink.
+    shift = -min([0] + [g['y_offset'] for g in glyphs if g['rows']])
+    for g in glyphs:
+        g['y_offset'] += shift
+    line_height = max([ascent + descent + shift] + [g['y_offset'] + len(g['rows']) for g in glyphs])
+    return glyphs, line_height
+
+def read_fixed_grid_header(header_path):
+    """Reads a header in the old fixed-grid format (every glyph stored at the
+    font's full width x height) so it can be written out in the compact one."""
+    with open(header_path) as f:
+        text = f.read()
+
+    def field(name):
+        return int(re.search(rf"\.{name} = (\d+)", text).group(1))
+
+    def array(name):
+        body = re.search(rf"_{name}\[\] = \{{(.*?)\}};", text, re.S).group(1)
+        return [int(v, 0) for v in re.findall(r"0x[0-9a-fA-F]+|\d+", body)]
+
+    var_name = re.search(r"const custom_font_t (\w+) =", text).group(1)
+    data, widths = array("data"), array("widths")
+    width, height, bytes_per_row = field("width"), field("height"), field("bytes_per_row")
+    first_char, last_char = field("first_char"), field("last_char")
+
+    glyphs = []
+    for i, code in enumerate(range(first_char, last_char + 1)):
+        base = i * height * bytes_per_row
+        pixels = [[(data[base + y * bytes_per_row + x // 8] >> (x % 8)) & 1 for x in range(width)] for y in range(height)]
+        rows, x_offset, y_offset = crop_to_ink(pixels)
+        # The old renderer left a 1-pixel gap after each glyph's width.
+        glyphs.append({'code': code, 'rows': rows, 'x_offset': x_offset, 'y_offset': y_offset, 'advance': widths[i] + 1})
+    return glyphs, height, var_name
+
+def pack_bits(rows):
+    """Row-major, one bit per pixel, first pixel in the low bit, rows not padded."""
+    bits = [bit for row in rows for bit in row]
+    packed = bytearray((len(bits) + 7) // 8)
+    for i, bit in enumerate(bits):
+        if bit:
+            packed[i // 8] |= 1 << (i % 8)
+    return packed
+
+def rle_encode(rows):
+    """Alternating clear and inked run lengths, starting with clear, in
+    nibbles (low nibble first). A nibble of 15 adds 15 and continues the run."""
+    bits = [bit for row in rows for bit in row]
+    nibbles = []
+    i, colour = 0, 0
+    while i < len(bits):
+        j = i
+        while j < len(bits) and bits[j] == colour:
+            j += 1
+        run = j - i
+        while run >= 15:
+            nibbles.append(15)
+            run -= 15
+        nibbles.append(run)
+        i, colour = j, colour ^ 1
+    if len(nibbles) % 2:
+        nibbles.append(0)
+    return bytearray(nibbles[k] | (nibbles[k + 1] << 4) for k in range(0, len(nibbles), 2))
+
+def build_font(glyphs, use_rle, force_rle=False):
+    glyphs = sorted(glyphs, key=lambda g: g['code'])
+    bitmaps = bytearray()
+    records = []
+    for g in glyphs:
+        rows = g['rows']
+        bitmap, flags = pack_bits(rows), 0
+        if use_rle and rows:
+            rle = rle_encode(rows)
+            if force_rle or len(rle) < len(bitmap):
+                bitmap, flags = rle, GLYPH_RLE
+        records.append((len(bitmaps), len(rows[0]) if rows else 0, len(rows), g['x_offset'], g['y_offset'], g['advance'], flags, g['code']))
+        bitmaps += bitmap
+    if len(bitmaps) > 0xFFFF:
+        raise ValueError("Glyph bitmaps exceed the 64 KB a glyph offset can address")
+
+    # Runs of consecutive characters become one range each.
+    ranges = []
+    for index, g in enumerate(glyphs):
+        if ranges and ranges[-1][1] == g['code'] - 1:
+            ranges[-1][1] = g['code']
+        else:
+            ranges.append([g['code'], g['code'], index])
+    return bitmaps, records, ranges
+
+def write_c_header(output_path, var_name, bitmaps, records, ranges, line_height):
     with open(output_path, 'w') as f:
         header_guard = f"FONT_{var_name.upper()}_H"
         f.write(f"#ifndef {header_guard}\n#define {header_guard}\n\n")
         f.write('#include "CustomFont.h"\n\n')
 
         # Write bitmap data
-        f.write(f"// Font data for {var_name} ({width}x{height})\n")
-        f.write(f"static const uint8_t {var_name}_data[] = {{\n")
-        for i, byte in enumerate(font_data):
+        f.write(f"// Glyph bitmaps for {var_name} ({len(records)} glyphs, line height {line_height})\n")
+        f.write(f"static const uint8_t {var_name}_bitmaps[] = {{\n")
+        for i, byte in enumerate(bitmaps or b"\x00"):
             f.write("    ") if i % 16 == 0 else ""
             f.write(f"0x{byte:02x}, ")
             f.write("\n") if (i + 1) % 16 == 0 else ""
         f.write("\n};\n\n")
 
-        # Write character widths data
-        f.write(f"// Character widths for {var_name}\n")
-        f.write(f"static const uint8_t {var_name}_widths[] = {{\n")
-        for i, w in enumerate(char_widths):
-            f.write("    ") if i % 16 == 0 else ""
-            f.write(f"{w}, ")
-            f.write("\n") if (i + 1) % 16 == 0 else ""
-        f.write("\n};\n\n")
+        # Write glyph boxes: offset, width, height, x_offset, y_offset, advance, flags
+        f.write(f"// Glyph boxes for {var_name}\n")
+        f.write(f"static const custom_glyph_t {var_name}_glyphs[] = {{\n")
+        for offset, width, height, x_offset, y_offset, advance, flags, code in records:
+            f.write(f"    {{{offset:5}, {width:2}, {height:2}, {x_offset:2}, {y_offset:2}, {advance:2}, {flags}}}, // '{chr(code)}'\n")
+        f.write("};\n\n")
+
+        f.write(f"static const custom_font_range_t {var_name}_ranges[] = {{\n")
+        for first, last, glyph in ranges:
+            f.write(f"    {{{first}, {last}, {glyph}}},\n")
+        f.write("};\n\n")
 
         # Write the font struct
         f.write(f"const custom_font_t {var_name} = {{\n")
-        f.write(f"    .data = {var_name}_data,\n")
-        f.write(f"    .widths = {var_name}_widths,\n")
-        f.write(f"    .width = {width},\n")
-        f.write(f"    .height = {height},\n")
-        f.write(f"    .bytes_per_row = {bytes_per_row},\n")
-        f.write(f"    .first_char = {first_char},\n")
-        f.write(f"    .last_char = {last_char}\n")
+        f.write(f"    .bitmaps = {var_name}_bitmaps,\n")
+        f.write(f"    .glyphs = {var_name}_glyphs,\n")
+        f.write(f"    .ranges = {var_name}_ranges,\n")
+        f.write(f"    .range_count = {len(ranges)},\n")
+        f.write(f"    .height = {line_height}\n")
         f.write("};\n\n")
 
         f.write(f"#endif // {header_guard}\n")
-    
+
     print(f"Successfully created font header: {output_path}")
 
 if __name__ == "__main__":
-    parser = argparse.ArgumentParser(description="Convert TTF font to a C header.")
-    parser.add_argument("ttf_file", help="Path to the input .ttf font file.")
-    parser.add_argument("size", type=int, help="Font size in pixels.")
+    parser = argparse.ArgumentParser(description="Convert a TTF font (or a header in the old fixed-grid format) to a compact C font header.")
+    parser.add_argument("ttf_file", help="Path to the input .ttf font file, or an old fixed-grid .h font header to convert.")
+    parser.add_argument("size", type=int, nargs="?", help="Font size in pixels (TTF input only).")
     parser.add_argument("output_file", help="Path for the output .h header file.")
-    parser.add_argument("--var_name", default="custom_font", help="C variable name for the font (e.g., 'font_my_cool_font').")
+    parser.add_argument("--var_name", default=None, help="C variable name for the font (e.g., 'font_my_cool_font'). Defaults to 'custom_font', or the converted header's name.")
     parser.add_argument("--first_char", type=int, default=32, help="ASCII code of the first character to include (default: 32 - space).")
     parser.add_argument("--last_char", type=int, default=126, help="ASCII code of the last character to include (default: 126 - ~).")
+    parser.add_argument("--chars", default=None, help="Exact set of characters to include, e.g. '0123456789:. ' (overrides --first_char/--last_char).")
+    parser.add_argument("--no_rle", action="store_true", help="Store every glyph as packed bits, even where run-length coding is smaller.")
+    parser.add_argument("--force_rle", action="store_true", help="Run-length code every inked glyph, even where packed bits are smaller (used by the host tests).")
 
     args = parser.parse_args()
 
-    data, widths, w, h, bpr = generate_font_data(args.ttf_file, args.size, args.first_char, args.last_char)
-    
-    if data:
-        write_c_header(args.output_file, args.var_name, data, widths, w, h, bpr, args.first_char, args.last_char)
\ No newline at end of file
+    if args.ttf_file.endswith(".h"):
+        glyphs, line_height, var_name = read_fixed_grid_header(args.ttf_file)
+        if args.chars:
+            glyphs = [g for g in glyphs if chr(g['code']) in args.chars]
+    else:
+        if args.size is None:
+            parser.error("size is required for a TTF font")
+        codes = sorted({ord(c) for c in args.chars}) if args.chars else range(args.first_char, args.last_char + 1)
+        if any(code > 255 for code in codes):
+            parser.error("characters must fit in 8 bits")
+        glyphs, line_height = render_ttf_glyphs(args.ttf_file, args.size, codes)
+        var_name = "custom_font"
+
+    if glyphs:
+        bitmaps, records, ranges = build_font(glyphs, not args.no_rle, args.force_rle)
+        rle_count = sum(1 for r in records if r[6] & GLYPH_RLE)
+        print(f"{len(records)} glyphs in {len(ranges)} range(s): {len(bitmaps)} bitmap bytes, "
+              f"{rle_count} glyphs run-length coded, line height {line_height}")
+        write_c_header(args.output_file, args.var_name or var_name, bitmaps, records, ranges, line_height)
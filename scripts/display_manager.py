@@ -9,11 +9,32 @@ import os
 import config
 import weather
 import ui_generator
+import tile_codec
 
 class DeviceManager:
-    """Manages robust, fire-and-forget TCP communication with the Pico W device."""
+    """Manages TCP communication with the Pico W device.
+
+    Tiles are sent through a credit-based sliding window: every tile carries a
+    sequence number, the device's cumulative ACK says which tile it expects
+    next and how much of its queue is free, and the host keeps sending while
+    the tiles from next_seq on fit in it. Frames are queued at their real
+    size, so the credit is in bytes (credit_bytes); firmware that only sends
+    a slot count gets seq < next_seq + credits. A NACK makes the host resend
+    from the NACKed tile, since the device drops everything after it."""
     def __init__(self):
         self.sock = None
+        self.device_session = None  # (session_id, epoch, flags) from SESSION
+        self.committed = None       # (session_id, epoch) of the last image we committed
+        self.epoch = 0
+        self._reset_window()
+        self._apply_caps(None)
+
+    def _reset_window(self):
+        self.next_seq = 0   # Sequence number of the next new tile
+        self.acked_seq = 0  # Next tile the device expects
+        self.credits = 1    # Until the device's first ACK arrives
+        self.credit_bytes = None  # Set by ACKs from firmware that counts queue bytes
+        self.draw_timings = {}  # seq -> stage times of timed tiles (see _on_draw_complete)
 
     def connect(self) -> bool:
         if self.sock: return True
@@ -25,13 +46,89 @@ class DeviceManager:
             self.sock.connect((config.PICO_IP, config.PICO_PORT))
             # Set a default timeout for all subsequent socket operations (like waiting for ACK)
             self.sock.settimeout(15.0) 
+            self._reset_window()
             print("Connected.")
+            self._handshake()
             return True
-        except (ConnectionRefusedError, OSError, socket.timeout) as e:
+        except (ConnectionRefusedError, OSError, socket.timeout, struct.error) as e:
             print(f"Connection error: {e}")
-            self.sock = None
+            self.close()
             return False
 
+    def _handshake(self):
+        """Sends HELLO and waits for the device's CAPS. Firmware that predates
+        the handshake ignores HELLO; the host then sticks to raw tiles."""
+        self.sock.sendall(pack_frame(config.FRAME_TYPE_HELLO, struct.pack(config.HELLO_FORMAT, config.PROTOCOL_VERSION)))
+        self.sock.settimeout(config.HELLO_TIMEOUT_SECONDS)
+        caps = None
+        self.device_session = None
+        try:
+            while caps is None:
+                rcv_type, payload = self._recv_frame()
+                if rcv_type == config.FRAME_TYPE_TILE_ACK:
+                    self._on_ack(payload)
+                elif rcv_type == config.FRAME_TYPE_CAPS:
+                    caps = struct.unpack_from(config.CAPS_FORMAT, payload)
+            self._apply_caps(caps)
+            while self.features & config.FEATURE_SESSION and self.device_session is None:
+                rcv_type, payload = self._recv_frame()
+                if rcv_type == config.FRAME_TYPE_TILE_ACK:
+                    self._on_ack(payload)
+                elif rcv_type == config.FRAME_TYPE_SESSION:
+                    self.device_session = struct.unpack_from(config.SESSION_FORMAT, payload)
+        except socket.timeout:
+            if caps is None:
+                print("No CAPS from device, assuming older firmware.")
+                self._apply_caps(None)
+            else:
+                print("No SESSION from device, the next update resends the whole screen.")
+        finally:
+            self.sock.settimeout(15.0)
+
+    def resume_image(self, image):
+        """Returns 'image' if the device still shows it, i.e. it reports the
+        session and epoch of our last commit and nothing has been drawn over
+        it since. Returns None when the whole screen has to be resent."""
+        if image is None or self.device_session is None or self.committed is None:
+            return None
+        session_id, epoch, flags = self.device_session
+        if flags & config.SESSION_EPOCH_VALID and (session_id, epoch) == self.committed:
+            print(f"Resuming session 0x{session_id:08X} at epoch {epoch}.")
+            return image
+        return None
+
+    def _commit_epoch(self, full):
+        """Tells the device that the tiles sent so far complete the next image."""
+        if self.device_session is None:
+            return
+        self.epoch = (self.epoch + 1) & 0xFFFFFFFF
+        flags = config.EPOCH_FULL_FRAME if full else 0
+        if self._send_frame(config.FRAME_TYPE_EPOCH_COMMIT, struct.pack(config.EPOCH_COMMIT_FORMAT, self.epoch, flags)):
+            self.committed = (self.device_session[0], self.epoch)
+
+    def _apply_caps(self, caps):
+        """Sets the transport parameters from a CAPS tuple, or the legacy defaults for None."""
+        if caps is None:
+            self.codecs = 0
+            self.features = 0
+            self.panel_size = (config.LCD_WIDTH, config.LCD_HEIGHT)
+            self.max_pixel_data = config.MAX_PIXEL_DATA_SIZE
+            self.max_tile_pixels = config.MAX_TILE_PIXELS
+            return
+        (version, _pixel_formats, self.codecs, width, height, max_payload, self.max_tile_pixels,
+         queue_depth, self.features, tile_width, tile_height) = caps
+        self.panel_size = (width, height)
+        self.max_pixel_data = min(max_payload, config.TILE_PAYLOAD_SIZE) - config.IMAGE_TILE_HEADER_SIZE
+        print(f"Device CAPS: protocol v{version}, panel {width}x{height}, codecs 0x{self.codecs:04X}, "
+              f"payload {max_payload}, queue {queue_depth}, tile {self.max_tile_pixels} px "
+              f"(preferred {tile_width}x{tile_height})")
+        if self.panel_size != (config.LCD_WIDTH, config.LCD_HEIGHT):
+            print(f"Warning: device panel is {width}x{height}, config.py says {config.LCD_WIDTH}x{config.LCD_HEIGHT}.")
+
+    def _use(self, enabled, codec):
+        """A codec is used when config.py allows it and the device supports it."""
+        return enabled and bool(self.codecs & codec)
+
     def send_image_diff(self, new_image, previous_image):
         if not self.sock: return False, previous_image
 
@@ -47,9 +144,35 @@ class DeviceManager:
             diff = ImageChops.difference(previous_image, quantized_new_image)
             bbox = diff.getbbox()
             if not bbox: return True, previous_image
+            if config.USE_RETAINED_SCROLL and self.features & config.FEATURE_RETAINED:
+                dy = _find_vertical_scroll(previous_image, quantized_new_image, bbox)
+                if dy:
+                    print(f"  - Scroll {bbox} by {dy} rows")
+                    if not self.scroll_rect(bbox, 0, dy):
+                        print("  - FAILED to deliver tiles. Aborting transfer.")
+                        return False, previous_image
+                    previous_image = _scrolled(previous_image, bbox, dy)
+                    diff = ImageChops.difference(previous_image, quantized_new_image)
+                    bbox = diff.getbbox()
+                    if not bbox:
+                        self._commit_epoch(full=False)
+                        return True, previous_image
             reconstructed_image = previous_image.copy()
         
         print(f"Update Bounding Box: {bbox}")
+
+        if previous_image and self._use(config.USE_BATCH_FRAMES, config.CODEC_BATCH):
+            rects = self._find_changed_rects(diff, bbox)
+            batch = self._build_batch(new_image, bbox, rects) if len(rects) > 1 else None
+            if batch is not None:
+                print(f"  - Batch tile {self.next_seq}: {len(rects)} rects {rects}")
+                if not self._send_tiles([batch]):
+                    print("  - FAILED to deliver tiles. Aborting transfer.")
+                    return False, previous_image
+                for rect in rects:
+                    reconstructed_image.paste(new_image.crop(rect), rect[:2])
+                self._commit_epoch(full=False)
+                return True, reconstructed_image
         
         sub_image = new_image.crop(bbox)
         pixel_data_full = ui_generator.convert_image_to_rgb565(sub_image)
@@ -58,80 +181,299 @@ class DeviceManager:
         sub_width, sub_height = sub_image.width, sub_image.height
         
         bytes_per_row = sub_width * 2
-        rows_per_tile = config.MAX_PIXEL_DATA_SIZE // bytes_per_row if bytes_per_row > 0 else 0
+        rows_per_tile = min(self.max_pixel_data // bytes_per_row,
+                            self.max_tile_pixels // sub_width) if bytes_per_row > 0 else 0
         if rows_per_tile == 0:
             print("Error: Tile is too narrow.")
             return False, previous_image
 
         y = 0
-        tile_count = 0
+        tiles = []
+        descriptions = []
+        total_payload = 0
+        pixels = tile_codec.to_pixels(pixel_data_full)
         while y < sub_height:
-            tile_height = min(rows_per_tile, sub_height - y)
-            
-            start_index = y * bytes_per_row
-            end_index = (y + tile_height) * bytes_per_row
-            tile_pixel_data = pixel_data_full[start_index:end_index]
+            frame_type, tile_height, wire_data = self._choose_tile_encoding(
+                pixels, pixel_data_full, sub_width, sub_height, y, rows_per_tile)
             
-            # CRC is calculated on the raw, unpadded pixel data.
-            crc = zlib.crc32(tile_pixel_data)
+            # CRC is calculated on the bytes actually sent.
+            crc = zlib.crc32(wire_data)
+            seq = self.next_seq + len(tiles)
             
             tile_x_global, tile_y_global = offset_x, offset_y + y
-            print(f"  - Sending tile {tile_count+1}: Pos({tile_x_global},{tile_y_global}), Size({sub_width}x{tile_height}), CRC(0x{crc:08X})")
-            
-            tile_header = struct.pack(config.IMAGE_TILE_HEADER_FORMAT, tile_x_global, tile_y_global, sub_width, tile_height, crc)
-            
-            # --- Send the header and the raw pixel data directly. No more padding. ---
-            payload = tile_header + tile_pixel_data
+            kind = TILE_KIND_NAMES[frame_type]
+            descriptions.append(f"  - Tile {seq}: {kind}, Pos({tile_x_global},{tile_y_global}), Size({sub_width}x{tile_height}), CRC(0x{crc:08X})")
             
-            if not self._send_frame_and_wait_for_ack(config.FRAME_TYPE_IMAGE_TILE, payload):
-                print("  - FAILED to get ACK. Aborting transfer.")
-                return False, previous_image
-            
-            tile_img = ui_generator.reconstruct_image_from_rgb565(tile_pixel_data, sub_width, tile_height)
-            reconstructed_image.paste(tile_img, (tile_x_global, tile_y_global))
-                
+            tile_header = struct.pack(config.IMAGE_TILE_HEADER_FORMAT, tile_x_global, tile_y_global, sub_width, tile_height, crc, seq)
+            tiles.append((frame_type, tile_header + wire_data))
+            total_payload += len(wire_data)
             y += tile_height
-            tile_count += 1
+
+        raw_size = len(pixel_data_full)
+        if (self._use(config.USE_STREAMED_TILES, config.CODEC_STREAM) and len(tiles) > 1 and
+                all(frame_type == config.FRAME_TYPE_IMAGE_TILE for frame_type, _ in tiles)):
+            # Nothing compresses, so send the box as one stream: a single
+            # panel window, and chunks that fill whole frames.
+            tiles = self._build_stream(offset_x, offset_y, sub_width, sub_height, pixel_data_full)
+            total_payload = raw_size
+            print(f"  - Streaming {sub_width}x{sub_height} at ({offset_x},{offset_y}) in {len(tiles)} chunks")
+        else:
+            print("\n".join(descriptions))
+
+        if not self._send_tiles(tiles):
+            print("  - FAILED to deliver tiles. Aborting transfer.")
+            return False, previous_image
+
+        reconstructed_image.paste(sub_image, (offset_x, offset_y))
+        self._commit_epoch(full=previous_image is None)
+
+        print(f"Sent {len(tiles)} tiles, {total_payload} of {raw_size} pixel bytes "
+              f"(ratio {raw_size / max(total_payload, 1):.1f}x)")
             
         return True, reconstructed_image
 
-    def _send_frame_and_wait_for_ack(self, frame_type, payload):
-        """Sends a frame and then blocks until an ACK is received."""
-        try:
-            # Send the data frame
-            frame = pack_frame(frame_type, payload)
-            self.sock.sendall(frame)
-            # Wait for the ACK frame
-            response = self.sock.recv(config.FRAME_HEADER_SIZE)
-            if len(response) < config.FRAME_HEADER_SIZE:
-                print("  - Error: Incomplete ACK response from device.")
-                return False
-            
-            magic, rcv_type, _ = struct.unpack(config.FRAME_HEADER_FORMAT, response)
-            
-            if magic != config.FRAME_MAGIC:
-                print("  - Error: Bad magic byte in ACK response.")
-                return False
-            
-            if rcv_type == config.FRAME_TYPE_TILE_ACK:
-                # print("  - ACK OK.") # Optional: for debugging
-                return True
-            elif rcv_type == config.FRAME_TYPE_TILE_NACK:
-                print("  - Error: Received NACK from device (checksum mismatch).")
-                return False
+    def copy_rect(self, box, dst):
+        """Retained mode: copies box (left, top, right, bottom) on the device to dst (x, y)."""
+        return self._send_retained(config.FRAME_TYPE_COPY_RECT, box, struct.pack(config.COPY_RECT_FORMAT, *dst))
+
+    def scroll_rect(self, box, dx, dy, fill_color=0):
+        """Retained mode: moves the content of box by (dx, dy); uncovered pixels get fill_color (RGB565)."""
+        return self._send_retained(config.FRAME_TYPE_SCROLL_RECT, box,
+                                   struct.pack(config.SCROLL_RECT_FORMAT, dx, dy, fill_color, 0))
+
+    def redraw_region(self, box):
+        """Retained mode: has the device send box from its framebuffer to the panel again."""
+        return self._send_retained(config.FRAME_TYPE_REDRAW_REGION, box, b"")
+
+    def _send_retained(self, frame_type, box, body):
+        """Sends a retained-mode frame as a one-tile update. False if the device
+        has no framebuffer (no FEATURE_RETAINED in CAPS) or the send failed."""
+        if not self.features & config.FEATURE_RETAINED:
+            print("The device has no framebuffer (no FEATURE_RETAINED in CAPS).")
+            return False
+        header = struct.pack(config.IMAGE_TILE_HEADER_FORMAT, box[0], box[1], box[2] - box[0], box[3] - box[1],
+                             zlib.crc32(body), self.next_seq)
+        return self._send_tiles([(frame_type, header + body)])
+
+    def _choose_tile_encoding(self, pixels, pixel_data, width, height, y, rows_per_tile):
+        """Picks the encoding that covers the most rows in one tile (fewest tiles to queue),
+        then the fewest bytes. Returns (frame_type, rows, data)."""
+        raw_rows = min(rows_per_tile, height - y)
+        bytes_per_row = width * 2
+        candidates = [(config.FRAME_TYPE_IMAGE_TILE, raw_rows,
+                       pixel_data[y * bytes_per_row:(y + raw_rows) * bytes_per_row])]
+        if self._use(config.USE_RLE_TILES, config.CODEC_RLE):
+            rows, data = self._encode_rle_tile(pixels, width, height, y)
+            candidates.append((config.FRAME_TYPE_IMAGE_TILE_RLE, rows, data))
+        if self._use(config.USE_PALETTE_TILES, config.CODEC_PALETTE):
+            rows, data = tile_codec.encode_palette_tile(pixels, width, height, y, self.max_pixel_data)
+            if rows:
+                candidates.append((config.FRAME_TYPE_IMAGE_TILE_PALETTE, rows, data))
+        return max(candidates, key=lambda c: (c[1], -len(c[2])))
+
+    @staticmethod
+    def _find_changed_rects(diff, bbox):
+        """Splits the changed area inside bbox into disjoint rects (left, top, right, bottom).
+        Rows are grouped into bands, then each band's columns into spans, wherever
+        at least BATCH_MERGE_GAP unchanged pixels separate them."""
+        left, top = bbox[0], bbox[1]
+        mask = diff.crop(bbox).point(lambda v: 255 if v else 0).convert('L')
+        width, height = mask.size
+        data = mask.tobytes()
+        rows = [any(data[y * width:(y + 1) * width]) for y in range(height)]
+        rects = []
+        for y0, y1 in _runs(rows, config.BATCH_MERGE_GAP):
+            cols = [any(data[y * width + x] for y in range(y0, y1)) for x in range(width)]
+            for x0, x1 in _runs(cols, config.BATCH_MERGE_GAP):
+                box = mask.crop((x0, y0, x1, y1)).getbbox()
+                if box:
+                    rects.append((left + x0 + box[0], top + y0 + box[1], left + x0 + box[2], top + y0 + box[3]))
+        return rects
+
+    def _build_batch(self, image, bbox, rects):
+        """Packs the rects of image into one IMAGE_BATCH frame, or returns None
+        if they do not fit in a single payload."""
+        body = bytearray(struct.pack(config.BATCH_HEADER_FORMAT, len(rects)))
+        pixel_data = bytearray()
+        for rect in rects:
+            body += struct.pack(config.BATCH_RECT_FORMAT, rect[0], rect[1], rect[2] - rect[0], rect[3] - rect[1])
+            pixel_data += ui_generator.convert_image_to_rgb565(image.crop(rect))
+        body += pixel_data
+        if len(body) > self.max_pixel_data or any(
+                (r[2] - r[0]) * (r[3] - r[1]) > self.max_tile_pixels for r in rects):
+            return None
+        body = bytes(body)
+        header = struct.pack(config.IMAGE_TILE_HEADER_FORMAT, bbox[0], bbox[1], bbox[2] - bbox[0], bbox[3] - bbox[1],
+                             zlib.crc32(body), self.next_seq)
+        return config.FRAME_TYPE_IMAGE_BATCH, header + body
+
+    def _build_stream(self, x, y, width, height, pixel_data):
+        """Splits raw RGB565 pixels into one IMAGE_STREAM_BEGIN frame and as many
+        IMAGE_STREAM_DATA frames as needed. Chunks need not end on a row."""
+        frames = []
+        pos = 0
+        while pos < len(pixel_data):
+            seq = self.next_seq + len(frames)
+            if not frames:
+                chunk = pixel_data[pos:pos + (self.max_pixel_data & ~1)]
+                header = struct.pack(config.IMAGE_TILE_HEADER_FORMAT, x, y, width, height, zlib.crc32(chunk), seq)
+                frames.append((config.FRAME_TYPE_IMAGE_STREAM_BEGIN, header + chunk))
             else:
-                print(f"  - Error: Received unexpected frame type {rcv_type} in response.")
-                return False
+                chunk_size = self.max_pixel_data + config.IMAGE_TILE_HEADER_SIZE - config.STREAM_CHUNK_HEADER_SIZE
+                chunk = pixel_data[pos:pos + (chunk_size & ~1)]
+                header = struct.pack(config.STREAM_CHUNK_HEADER_FORMAT, zlib.crc32(chunk), seq)
+                frames.append((config.FRAME_TYPE_IMAGE_STREAM_DATA, header + chunk))
+            pos += len(chunk)
+        return frames
+
+    def _encode_rle_tile(self, pixels, width, height, start_y):
+        """Encodes as many rows from start_y as fit in one tile. Returns (rows, data)."""
+        data = bytearray()
+        above = None
+        y = start_y
+        while y < height:
+            row = pixels[y * width:(y + 1) * width]
+            encoded = tile_codec.encode_row(row, above)
+            if len(data) + len(encoded) > self.max_pixel_data:
+                break
+            data += encoded
+            above = row
+            y += 1
+        return y - start_y, bytes(data)
+
+    def _send_tiles(self, tiles, timed=False):
+        """Sends (frame_type, payload) tiles numbered from self.next_seq and
+        blocks until the device has queued all of them. With timed=True each
+        tile is preceded by a TILE_TIMESTAMP, and its DRAW_COMPLETE ends up
+        in self.draw_timings."""
+        base = self.next_seq
+        end = base + len(tiles)
+        send_seq = base
+        try:
+            while self.acked_seq < end:
+                while send_seq < end and self._window_allows(tiles, base, send_seq):
+                    frame_type, payload = tiles[send_seq - base]
+                    if timed:
+                        host_time = time.perf_counter_ns() // 1000 & 0xFFFFFFFF
+                        self.sock.sendall(pack_frame(config.FRAME_TYPE_TILE_TIMESTAMP,
+                                                     struct.pack(config.TILE_TIMESTAMP_FORMAT, send_seq, host_time)))
+                    self.sock.sendall(pack_frame(frame_type, payload))
+                    send_seq += 1
 
+                rcv_type, payload = self._recv_frame()
+                if rcv_type == config.FRAME_TYPE_TILE_ACK:
+                    self._on_ack(payload)
+                elif rcv_type == config.FRAME_TYPE_DRAW_COMPLETE:
+                    self._on_draw_complete(payload)
+                elif rcv_type == config.FRAME_TYPE_TILE_NACK:
+                    (seq,) = struct.unpack(config.TILE_NACK_FORMAT, payload)
+                    if base <= seq < send_seq:
+                        print(f"  - NACK for tile {seq}, resending from there.")
+                        send_seq = seq
+                else:
+                    print(f"  - Error: Received unexpected frame type {rcv_type} in response.")
+                    return False
         except socket.timeout:
             print("  - Error: Timed out waiting for ACK from device.")
             self.close()
             return False
-        except OSError as e:
+        except (OSError, struct.error) as e:
             print(f"Socket error during send/receive: {e}")
             self.close()
             return False
 
+        self.next_seq = end
+        return True
+
+    def read_stats(self):
+        """Asks the device for its telemetry counters. Returns a dict, or None
+        if the device does not answer (firmware without STATS)."""
+        if not self.sock: return None
+        try:
+            self.sock.sendall(pack_frame(config.FRAME_TYPE_STATS, b""))
+            self.sock.settimeout(config.HELLO_TIMEOUT_SECONDS)
+            while True:
+                rcv_type, payload = self._recv_frame()
+                if rcv_type == config.FRAME_TYPE_TILE_ACK:
+                    self._on_ack(payload)
+                elif rcv_type == config.FRAME_TYPE_STATS:
+                    values = struct.unpack_from(config.STATS_FORMAT, payload)
+                    return dict(zip(config.STATS_FIELDS, values))
+        except socket.timeout:
+            print("No STATS from device.")
+            return None
+        except (OSError, struct.error) as e:
+            print(f"Socket error while reading stats: {e}")
+            self.close()
+            return None
+        finally:
+            if self.sock: self.sock.settimeout(15.0)
+
+    def _window_allows(self, tiles, base, send_seq):
+        """True if tile send_seq (of tiles numbered from base) may be sent now."""
+        if self.credit_bytes is None:
+            return send_seq < self.acked_seq + self.credits
+        in_flight = sum(queue_cost(tiles[seq - base][1]) for seq in range(max(self.acked_seq, base), send_seq + 1))
+        return in_flight <= self.credit_bytes
+
+    def _on_ack(self, payload):
+        if len(payload) >= struct.calcsize(config.TILE_ACK_BYTES_FORMAT):
+            next_seq, credits, self.credit_bytes = struct.unpack_from(config.TILE_ACK_BYTES_FORMAT, payload)
+        else:
+            next_seq, credits = struct.unpack_from(config.TILE_ACK_FORMAT, payload)
+        self.acked_seq = max(self.acked_seq, next_seq)
+        self.credits = credits
+
+    def _on_draw_complete(self, payload):
+        """Splits a timed tile's glass-to-glass latency into stages, in seconds.
+        The device clock is not synchronised with ours, so the network time is
+        the round trip minus the device's own share, and half of it is counted
+        as the way in."""
+        seq, host_time, received_us, dequeued_us, completed_us = struct.unpack(config.DRAW_COMPLETE_FORMAT, payload)
+        round_trip = ((time.perf_counter_ns() // 1000 - host_time) & 0xFFFFFFFF) / 1e6
+        queue = ((dequeued_us - received_us) & 0xFFFFFFFF) / 1e6
+        draw = ((completed_us - dequeued_us) & 0xFFFFFFFF) / 1e6
+        network = max(0.0, round_trip - queue - draw) / 2
+        self.draw_timings[seq] = {"network": network, "queue": queue, "draw": draw,
+                                  "total": network + queue + draw}
+
+    def wait_for_draws(self, seqs, timeout=5.0):
+        """Reads frames until every tile in seqs has reported DRAW_COMPLETE.
+        Returns False on a timeout (e.g. a timed tile was resent)."""
+        deadline = time.monotonic() + timeout
+        try:
+            while not all(seq in self.draw_timings for seq in seqs):
+                remaining = deadline - time.monotonic()
+                if remaining <= 0:
+                    return False
+                self.sock.settimeout(remaining)
+                rcv_type, payload = self._recv_frame()
+                if rcv_type == config.FRAME_TYPE_TILE_ACK:
+                    self._on_ack(payload)
+                elif rcv_type == config.FRAME_TYPE_DRAW_COMPLETE:
+                    self._on_draw_complete(payload)
+        except socket.timeout:
+            return False
+        finally:
+            if self.sock: self.sock.settimeout(15.0)
+        return True
+
+    def _recv_frame(self):
+        """Reads one frame from the device. Returns (frame_type, payload)."""
+        magic, rcv_type, length = struct.unpack(config.FRAME_HEADER_FORMAT, self._recv_exact(config.FRAME_HEADER_SIZE))
+        if magic != config.FRAME_MAGIC:
+            raise OSError("bad magic byte in response")
+        return rcv_type, self._recv_exact(length)
+
+    def _recv_exact(self, length):
+        data = bytearray()
+        while len(data) < length:
+            chunk = self.sock.recv(length - len(data))
+            if not chunk:
+                raise ConnectionResetError("device closed the connection")
+            data.extend(chunk)
+        return bytes(data)
+
     def _send_frame(self, frame_type, payload):
         try:
             frame = pack_frame(frame_type, payload)
@@ -148,10 +490,78 @@ class DeviceManager:
             self.sock = None
             print("--- Device Disconnected ---")
 
+TILE_KIND_NAMES = {
+    config.FRAME_TYPE_IMAGE_TILE: "raw",
+    config.FRAME_TYPE_IMAGE_TILE_RLE: "RLE",
+    config.FRAME_TYPE_IMAGE_TILE_PALETTE: "palette",
+}
+
+def _runs(flags, gap):
+    """Returns (start, end) ranges of set flags, merging ranges less than gap apart."""
+    runs = []
+    start = last = None
+    for i, flag in enumerate(flags):
+        if not flag:
+            continue
+        if start is None:
+            start = i
+        elif i - last > max(gap, 1):
+            runs.append((start, last + 1))
+            start = i
+        last = i
+    if start is not None:
+        runs.append((start, last + 1))
+    return runs
+
+def _find_vertical_scroll(old, new, bbox):
+    """Returns the dy (rows, positive is down) for which most changed rows of
+    new inside bbox are old's rows moved by dy, or 0 unless that saves at
+    least SCROLL_MIN_ROWS rows. Rows that occur often (blank ones) are not
+    counted as evidence, since they match any shift."""
+    left, top, right, bottom = bbox
+    height = bottom - top
+    row_bytes = (right - left) * 3
+    old_data = old.crop(bbox).convert('RGB').tobytes()
+    new_data = new.crop(bbox).convert('RGB').tobytes()
+    old_rows = [old_data[y * row_bytes:(y + 1) * row_bytes] for y in range(height)]
+    new_rows = [new_data[y * row_bytes:(y + 1) * row_bytes] for y in range(height)]
+    where = {}
+    for y, row in enumerate(old_rows):
+        where.setdefault(row, []).append(y)
+    votes = {}
+    for y, row in enumerate(new_rows):
+        sources = where.get(row, ())
+        if row == old_rows[y] or len(sources) > 4:
+            continue
+        for source in sources:
+            votes[y - source] = votes.get(y - source, 0) + 1
+    if not votes:
+        return 0
+    dy = max(votes, key=votes.get)
+    blank = bytes(row_bytes)
+    scrolled = [old_rows[y - dy] if 0 <= y - dy < height else blank for y in range(height)]
+    saved = (sum(a == b for a, b in zip(new_rows, scrolled)) -
+             sum(a == b for a, b in zip(new_rows, old_rows)))
+    return dy if saved >= config.SCROLL_MIN_ROWS else 0
+
+def _scrolled(image, bbox, dy):
+    """A copy of image with bbox's content moved down by dy rows, filled
+    black above or below, as the device does for SCROLL_RECT."""
+    region = image.crop(bbox)
+    moved = Image.new(image.mode, region.size)
+    moved.paste(region, (0, dy))
+    result = image.copy()
+    result.paste(moved, bbox[:2])
+    return result
+
 def pack_frame(frame_type, payload):
     header = struct.pack(config.FRAME_HEADER_FORMAT, config.FRAME_MAGIC, frame_type, len(payload))
     return header + payload
 
+def queue_cost(payload):
+    """Bytes of the device's tile queue a frame with this payload takes."""
+    return (config.TILE_RECORD_OVERHEAD + len(payload) + 3) & ~3
+
 def main():
     if os.path.exists(config.STATE_IMAGE_PATH):
         try: os.remove(config.STATE_IMAGE_PATH)
@@ -169,7 +579,8 @@ def main():
                 time.sleep(5)
                 continue
             
-            previous_image = None
+            # After a reconnect, keep diffing if the panel still shows our last image.
+            previous_image = manager.resume_image(previous_image)
 
             while True:
                 if (time.time() - last_weather_check) > config.WEATHER_UPDATE_INTERVAL_SECONDS:
@@ -206,7 +617,6 @@ def main():
         except (ConnectionResetError, BrokenPipeError, OSError) as e:
             print(f"\nConnection error: {e}. Reconnecting in 5 seconds...")
             manager.close()
-            previous_image = None
             time.sleep(5)
         except KeyboardInterrupt:
             print("\nExiting.")
@@ -24,7 +24,12 @@ FRAME_TYPE_IMAGE_TILE = 0x02
 FRAME_TYPE_TILE_ACK = 0x03
 FRAME_TYPE_TILE_NACK = 0x04
 
-IMAGE_TILE_HEADER_FORMAT = "<HHHHI"  # x, y, width, height, crc32
+THROUGHPUT_TEST_FORMAT = "<BBHI"  # mode (0 = echo), flags, reserved, id
+THROUGHPUT_TEST_SIZE = struct.calcsize(THROUGHPUT_TEST_FORMAT)
+
+IMAGE_TILE_HEADER_FORMAT = "<HHHHII"  # x, y, width, height, crc32, seq
+TILE_ACK_FORMAT = "<IB"  # next_seq, credits
+TILE_NACK_FORMAT = "<I"  # seq
 IMAGE_TILE_HEADER_SIZE = struct.calcsize(IMAGE_TILE_HEADER_FORMAT)
 MAX_PIXEL_DATA_SIZE = TILE_PAYLOAD_SIZE - IMAGE_TILE_HEADER_SIZE
 
@@ -78,30 +83,41 @@ def pack_frame(frame_type, payload):
     header = struct.pack(FRAME_HEADER_FORMAT, FRAME_MAGIC, frame_type, len(payload))
     return header + payload
 
-def wait_for_ack(sock):
-    """Waits for an ACK or NACK from the Pico."""
+def recv_exact(sock, length):
+    data = bytearray()
+    while len(data) < length:
+        chunk = sock.recv(length - len(data))
+        if not chunk:
+            raise ConnectionError("connection closed")
+        data.extend(chunk)
+    return bytes(data)
+
+def wait_for_ack(sock, seq):
+    """Waits until the Pico has queued tile 'seq' (or NACKed it).
+
+    ACKs are cumulative and also arrive unprompted (one when the connection
+    opens), so keep reading until one covers this tile."""
     try:
         sock.settimeout(2.0) # 2-second timeout for a response
-        data = sock.recv(FRAME_HEADER_SIZE)
-        if not data or len(data) < FRAME_HEADER_SIZE:
-            print("ERROR: Did not receive a valid response from Pico.")
-            return False
-
-        magic, rcv_type, rcv_len = struct.unpack(FRAME_HEADER_FORMAT, data)
-        
-        if magic != FRAME_MAGIC:
-            print("ERROR: Received bad magic byte in response.")
-            return False
-        
-        if rcv_type == FRAME_TYPE_TILE_ACK:
-            return True
-        elif rcv_type == FRAME_TYPE_TILE_NACK:
-            print("ERROR: Pico reported a NACK (checksum mismatch).")
-            return False
-        else:
-            print(f"ERROR: Received unexpected frame type {rcv_type} in response.")
-            return False
-    except socket.timeout:
+        while True:
+            magic, rcv_type, rcv_len = struct.unpack(FRAME_HEADER_FORMAT, recv_exact(sock, FRAME_HEADER_SIZE))
+            payload = recv_exact(sock, rcv_len)
+
+            if magic != FRAME_MAGIC:
+                print("ERROR: Received bad magic byte in response.")
+                return False
+
+            if rcv_type == FRAME_TYPE_TILE_ACK:
+                next_seq, _credits = struct.unpack_from(TILE_ACK_FORMAT, payload)
+                if next_seq > seq:
+                    return True
+            elif rcv_type == FRAME_TYPE_TILE_NACK:
+                print("ERROR: Pico reported a NACK (checksum mismatch).")
+                return False
+            else:
+                print(f"ERROR: Received unexpected frame type {rcv_type} in response.")
+                return False
+    except (socket.timeout, ConnectionError):
         print("ERROR: Timed out waiting for ACK from Pico.")
         return False
     finally:
@@ -126,13 +142,13 @@ def send_image_to_pico(sock, image):
         
         print(f"Sending tile {i+1}/{num_tiles}: (x={x}, y={y}, w={w}, h={h}), crc=0x{crc:08X}")
         
-        tile_header = struct.pack(IMAGE_TILE_HEADER_FORMAT, x, y, w, h, crc)
+        tile_header = struct.pack(IMAGE_TILE_HEADER_FORMAT, x, y, w, h, crc, i)
         payload = tile_header + pixel_data
         frame = pack_frame(FRAME_TYPE_IMAGE_TILE, payload)
         
         sock.sendall(frame)
         
-        if not wait_for_ack(sock):
+        if not wait_for_ack(sock, i):
             print("Aborting image transfer due to error.")
             return
 
@@ -147,7 +163,8 @@ def run_throughput_test(sock, num_iterations=5, data_size=8192):
     timings = []
     
     for i in range(num_iterations):
-        data_to_send = os.urandom(data_size)
+        # Echo mode; the whole frame, header included, comes back unchanged.
+        data_to_send = struct.pack(THROUGHPUT_TEST_FORMAT, 0, 0, 0, i) + os.urandom(data_size - THROUGHPUT_TEST_SIZE)
         payload = data_to_send
         frame = pack_frame(FRAME_TYPE_THROUGHPUT_TEST, payload)
         
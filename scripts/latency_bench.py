@@ -0,0 +1,99 @@
+# File: latency_bench.py
+"""
+Glass-to-glass latency of tile updates, split by stage.
+
+Each tile is preceded by a TILE_TIMESTAMP frame, and the device answers with
+DRAW_COMPLETE once the tile's slot is released, i.e. after its last pixel has
+been handed to the panel. The stages are:
+
+    network   host -> device, estimated as half of the round trip that is not
+              spent on the device (the two clocks are not synchronised)
+    queue     tile queued -> display side starts it
+    draw      display side starts it -> slot released
+    total     the sum of the three
+
+Sending several tiles per update (--burst) shows how queueing grows with the
+window; the default sends one tile at a time, like a clock tick.
+
+Usage: python latency_bench.py [--count 100] [--burst 1] [--rows 12]
+"""
+import argparse
+import os
+import struct
+import zlib
+import config
+from display_manager import DeviceManager
+
+STAGES = ("network", "queue", "draw", "total")
+BUCKET_EDGES_MS = (0.25, 0.5, 1, 2, 4, 8, 16, 32, 64, 128)
+
+
+def percentile(values, fraction):
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, int(fraction * len(ordered)))]
+
+
+def print_histogram(name, values_ms):
+    print(f"\n{name}: p50 {percentile(values_ms, 0.5):.2f} ms, p99 {percentile(values_ms, 0.99):.2f} ms, "
+          f"max {max(values_ms):.2f} ms")
+    counts = [0] * (len(BUCKET_EDGES_MS) + 1)
+    for value in values_ms:
+        bucket = 0
+        while bucket < len(BUCKET_EDGES_MS) and value >= BUCKET_EDGES_MS[bucket]:
+            bucket += 1
+        counts[bucket] += 1
+    peak = max(counts)
+    for bucket, count in enumerate(counts):
+        if count == 0:
+            continue
+        label = f"< {BUCKET_EDGES_MS[bucket]:g} ms" if bucket < len(BUCKET_EDGES_MS) else f">= {BUCKET_EDGES_MS[-1]:g} ms"
+        print(f"  {label:>10} {count:>5} {'#' * max(1, count * 40 // peak)}")
+
+
+def make_tile(device, seq, rows, y):
+    """A full-width raw tile of random pixels, so every update changes the panel."""
+    width, _height = device.panel_size
+    pixel_data = os.urandom(width * rows * 2)
+    header = struct.pack(config.IMAGE_TILE_HEADER_FORMAT, 0, y, width, rows, zlib.crc32(pixel_data), seq)
+    return config.FRAME_TYPE_IMAGE_TILE, header + pixel_data
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    parser.add_argument("--count", type=int, default=100, help="updates to measure")
+    parser.add_argument("--burst", type=int, default=1, help="tiles per update")
+    parser.add_argument("--rows", type=int, default=12, help="rows per full-width tile")
+    args = parser.parse_args()
+
+    device = DeviceManager()
+    if not device.connect():
+        return
+    if not device.features & config.FEATURE_DRAW_TIMING:
+        print("The device does not report draw timing (no FEATURE_DRAW_TIMING in CAPS).")
+        device.close()
+        return
+
+    width, height = device.panel_size
+    rows = max(1, min(args.rows, height, device.max_tile_pixels // width))
+    lost = 0
+    for update in range(args.count):
+        base = device.next_seq
+        tiles = [make_tile(device, base + i, rows, ((update * args.burst + i) * rows) % (height - rows + 1))
+                 for i in range(args.burst)]
+        if not device._send_tiles(tiles, timed=True):
+            return
+        if not device.wait_for_draws(range(base, base + args.burst)):
+            lost += 1
+
+    timings = list(device.draw_timings.values())
+    if not timings:
+        print("No DRAW_COMPLETE frames received.")
+    else:
+        print(f"{len(timings)} tiles of {width}x{rows}, {args.burst} per update, {lost} updates incomplete")
+        for stage in STAGES:
+            print_histogram(stage, [timing[stage] * 1000 for timing in timings])
+    device.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,233 @@
+# File: tile_codec.py
+"""
+Tile codecs for FRAME_TYPE_IMAGE_TILE_RLE and FRAME_TYPE_IMAGE_TILE_PALETTE.
+
+RLE
+
+Pixel data is little-endian RGB565. Each row is encoded as a sequence of ops
+that never crosses the end of the row, so the device can decode one row at a
+time into a small buffer:
+
+    0x00-0x7F  literal: (op & 0x7F) + 1 pixels follow
+    0x80-0xBF  run:     one pixel follows, repeated (op & 0x3F) + 1 times
+    0xC0-0xFF  copy up: (op & 0x3F) + 1 pixels are copied from the row above
+
+Copy-up makes horizontal gradients (every row identical) nearly free, and runs
+cover flat backgrounds and text.
+
+Palette
+    A "<BB" header (bits per pixel, palette entries - 1), the RGB565 palette,
+    then 1/2/4/8-bit indices. Rows start on a byte boundary and the first pixel
+    of a byte is in its least significant bits.
+
+Run this file directly to report the compression ratio and decode speed on a
+frame from ui_generator.py.
+"""
+import struct
+import time
+from array import array
+
+MAX_LITERAL = 128
+MAX_REPEAT = 64
+OP_RUN = 0x80
+OP_COPY_UP = 0xC0
+
+
+def to_pixels(pixel_data: bytes) -> array:
+    pixels = array('H')
+    pixels.frombytes(pixel_data)
+    return pixels
+
+
+def encode_row(row, above=None) -> bytes:
+    """Encodes one row of RGB565 values (a sequence of ints)."""
+    out = bytearray()
+    width = len(row)
+    literal_start = None
+
+    def flush_literal(end):
+        start = literal_start
+        while start < end:
+            count = min(MAX_LITERAL, end - start)
+            out.append(count - 1)
+            out.extend(struct.pack(f"<{count}H", *row[start:start + count]))
+            start += count
+
+    x = 0
+    while x < width:
+        limit = min(width, x + MAX_REPEAT)
+        run = 1
+        while x + run < limit and row[x + run] == row[x]:
+            run += 1
+        up = 0
+        if above is not None:
+            while x + up < limit and row[x + up] == above[x + up]:
+                up += 1
+
+        # A repeat op costs 1 or 3 bytes; literals cost 2 bytes per pixel.
+        if up >= 2 and up >= run:
+            if literal_start is not None:
+                flush_literal(x)
+                literal_start = None
+            out.append(OP_COPY_UP | (up - 1))
+            x += up
+        elif run >= 2:
+            if literal_start is not None:
+                flush_literal(x)
+                literal_start = None
+            out.append(OP_RUN | (run - 1))
+            out.extend(struct.pack("<H", row[x]))
+            x += run
+        else:
+            if literal_start is None:
+                literal_start = x
+            x += 1
+
+    if literal_start is not None:
+        flush_literal(width)
+    return bytes(out)
+
+
+def encode_rows(pixel_data: bytes, width: int, height: int):
+    """Yields the encoded bytes of each row. Every row may copy from the one before."""
+    pixels = to_pixels(pixel_data)
+    above = None
+    for y in range(height):
+        row = pixels[y * width:(y + 1) * width]
+        yield encode_row(row, above)
+        above = row
+
+
+def encode(pixel_data: bytes, width: int, height: int) -> bytes:
+    return b"".join(encode_rows(pixel_data, width, height))
+
+
+def decode(data: bytes, width: int, height: int) -> bytes:
+    """Reference decoder, mirrors Drawing::drawRleImage."""
+    out = array('H', bytes(width * height * 2))
+    pos = 0
+    for y in range(height):
+        base = y * width
+        x = 0
+        while x < width:
+            op = data[pos]
+            pos += 1
+            count = (op & 0x7F) + 1 if not op & 0x80 else (op & 0x3F) + 1
+            if x + count > width:
+                raise ValueError("op crosses the end of a row")
+            if not op & 0x80:
+                out[base + x:base + x + count] = array('H', data[pos:pos + count * 2])
+                pos += count * 2
+            elif op & 0x40:
+                if y == 0:
+                    raise ValueError("copy-up in the first row")
+                out[base + x:base + x + count] = out[base - width + x:base - width + x + count]
+            else:
+                pixel = data[pos] | (data[pos + 1] << 8)
+                pos += 2
+                out[base + x:base + x + count] = array('H', [pixel]) * count
+            x += count
+    if pos != len(data):
+        raise ValueError("trailing data")
+    return out.tobytes()
+
+
+def _bits_for(color_count: int) -> int:
+    for bits in (1, 2, 4, 8):
+        if color_count <= (1 << bits):
+            return bits
+    raise ValueError("more than 256 colors")
+
+
+def encode_palette_tile(pixels, width: int, height: int, start_y: int, max_bytes: int):
+    """Packs as many rows from start_y as fit in max_bytes. Returns (rows, data)."""
+    colors = set()
+    y = start_y
+    while y < height:
+        row_colors = colors.union(pixels[y * width:(y + 1) * width])
+        if len(row_colors) > 256:
+            break
+        bits = _bits_for(len(row_colors))
+        size = 2 + 2 * len(row_colors) + (y + 1 - start_y) * ((width * bits + 7) // 8)
+        if size > max_bytes:
+            break
+        colors = row_colors
+        y += 1
+    rows = y - start_y
+    if rows == 0:
+        return 0, b""
+
+    palette = sorted(colors)
+    index_of = {color: i for i, color in enumerate(palette)}
+    bits = _bits_for(len(palette))
+    out = bytearray(struct.pack("<BB", bits, len(palette) - 1))
+    out.extend(struct.pack(f"<{len(palette)}H", *palette))
+    per_byte = 8 // bits
+    for y in range(start_y, start_y + rows):
+        row = pixels[y * width:(y + 1) * width]
+        for x in range(0, width, per_byte):
+            byte = 0
+            for i, color in enumerate(row[x:x + per_byte]):
+                byte |= index_of[color] << (i * bits)
+            out.append(byte)
+    return rows, bytes(out)
+
+
+def decode_palette(data: bytes, width: int, height: int) -> bytes:
+    """Reference decoder, mirrors Drawing::drawPaletteImage."""
+    bits, last = struct.unpack_from("<BB", data)
+    palette = struct.unpack_from(f"<{last + 1}H", data, 2)
+    pos = 2 + 2 * (last + 1)
+    bytes_per_row = (width * bits + 7) // 8
+    mask = (1 << bits) - 1
+    out = array('H')
+    for y in range(height):
+        row = data[pos + y * bytes_per_row:pos + (y + 1) * bytes_per_row]
+        for x in range(width):
+            index = (row[x * bits // 8] >> ((x * bits) % 8)) & mask
+            out.append(palette[index] if index < len(palette) else 0)
+    return out.tobytes()
+
+
+def main():
+    from datetime import datetime
+    import config
+    import ui_generator
+
+    now = datetime.now()
+    image = ui_generator.create_ui_image(now.strftime("%H:%M"), now.strftime("%a, %b %d"), None)
+    raw = ui_generator.convert_image_to_rgb565(image)
+
+    start = time.perf_counter()
+    encoded = encode(raw, image.width, image.height)
+    encode_s = time.perf_counter() - start
+
+    start = time.perf_counter()
+    decoded = decode(encoded, image.width, image.height)
+    decode_s = time.perf_counter() - start
+    assert decoded == raw, "round trip mismatch"
+
+    pixels = image.width * image.height
+    print(f"Frame {image.width}x{image.height}: {len(raw)} -> {len(encoded)} bytes "
+          f"(ratio {len(raw) / len(encoded):.1f}x)")
+    print(f"Host encode {pixels / encode_s:,.0f} pixels/s, host decode {pixels / decode_s:,.0f} pixels/s")
+    print(f"Raw tiles: {-(-len(raw) // config.MAX_PIXEL_DATA_SIZE)}, "
+          f"RLE tiles: >= {-(-len(encoded) // config.MAX_PIXEL_DATA_SIZE)}")
+
+    pixels = to_pixels(raw)
+    y = palette_tiles = palette_bytes = 0
+    while y < image.height:
+        rows, data = encode_palette_tile(pixels, image.width, image.height, y, config.MAX_PIXEL_DATA_SIZE)
+        if rows == 0:
+            print(f"Palette: row {y} has more than 256 colors, not applicable to this frame")
+            break
+        y += rows
+        palette_tiles += 1
+        palette_bytes += len(data)
+    else:
+        print(f"Palette tiles: {palette_tiles}, {palette_bytes} bytes (ratio {len(raw) / palette_bytes:.1f}x)")
+    print("Device decode speed is logged by the firmware ('RLE decode ... pixels/s').")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,159 @@
+# File: transport_bench.py
+"""
+Transport benchmark for the Pico W display server.
+
+Runs each stage for every payload size and window depth (frames in flight):
+
+    echo      THROUGHPUT_TEST echo mode: Wi-Fi and lwIP in both directions.
+    sink      THROUGHPUT_TEST sink mode: the frame goes one way and the device
+              answers with a 16-byte ThroughputReply.
+    sink+crc  Sink mode, but the device also copies the filler into its tile
+              queue and checks its CRC, exactly as it does for a tile.
+              The reply says how long that took on the device.
+    draw      Raw IMAGE_TILE frames through DeviceManager's sliding window.
+              The window is the device's tile queue, so only the payload
+              size varies.
+
+Throughput is payload bytes sent per second; for echo the same bytes also
+come back. Latency is from sending a frame to receiving its reply. Comparing
+the stages separates the costs: sink is the network, sink+crc minus sink is
+the receive copy and CRC, and draw minus sink+crc is the panel.
+
+Usage: python transport_bench.py [--sizes 1024,4096,8192] [--depths 1,2,4,8] [--count 64]
+"""
+import argparse
+import os
+import struct
+import time
+import zlib
+import config
+from display_manager import DeviceManager, pack_frame
+
+STAGES = (
+    ("echo", config.THROUGHPUT_ECHO, 0),
+    ("sink", config.THROUGHPUT_SINK, 0),
+    ("sink+crc", config.THROUGHPUT_SINK, config.THROUGHPUT_FLAG_CRC),
+)
+NO_SLOT = 0xFFFFFFFF  # crc_us when the tile queue had no room for the filler
+
+
+def percentile(values, fraction):
+    if not values:
+        return float("nan")
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, int(fraction * len(ordered)))]
+
+
+def run_test_frames(device, mode, flags, size, depth, count):
+    """Keeps up to 'depth' THROUGHPUT_TEST frames in flight until 'count' have
+    been answered. Returns (seconds, round trip times, device CRC times in us)."""
+    filler = os.urandom(size - config.THROUGHPUT_TEST_SIZE)
+    filler_crc = zlib.crc32(filler)
+    sent_at = {}
+    rtts = []
+    crc_times = []
+    next_id = 0
+    start = time.perf_counter()
+    while len(rtts) < count:
+        while next_id < count and len(sent_at) < depth:
+            header = struct.pack(config.THROUGHPUT_TEST_FORMAT, mode, flags, 0, next_id)
+            sent_at[next_id] = time.perf_counter()
+            device.sock.sendall(pack_frame(config.FRAME_TYPE_THROUGHPUT_TEST, header + filler))
+            next_id += 1
+
+        rcv_type, payload = device._recv_frame()
+        if rcv_type == config.FRAME_TYPE_TILE_ACK:
+            device._on_ack(payload)  # Slots freed by an earlier draw stage
+            continue
+        if rcv_type != config.FRAME_TYPE_THROUGHPUT_TEST:
+            raise ValueError(f"unexpected frame type {rcv_type}")
+        if mode == config.THROUGHPUT_ECHO:
+            reply_id = struct.unpack_from(config.THROUGHPUT_TEST_FORMAT, payload)[3]
+            if payload[config.THROUGHPUT_TEST_SIZE:] != filler:
+                raise ValueError(f"echo {reply_id} does not match what was sent")
+        else:
+            reply_id, received, crc, crc_us = struct.unpack(config.THROUGHPUT_REPLY_FORMAT, payload)
+            if received != len(filler):
+                raise ValueError(f"device received {received} bytes of {len(filler)}")
+            if flags & config.THROUGHPUT_FLAG_CRC and crc_us != NO_SLOT:
+                if crc != filler_crc:
+                    raise ValueError(f"device CRC 0x{crc:08X}, expected 0x{filler_crc:08X}")
+                crc_times.append(crc_us)
+        rtts.append(time.perf_counter() - sent_at.pop(reply_id))
+    return time.perf_counter() - start, rtts, crc_times
+
+
+def run_draw(device, size, count):
+    """Sends 'count' full-width raw tiles of about 'size' bytes. Returns seconds."""
+    width, height = device.panel_size
+    pixels = min(device.max_tile_pixels, (size - config.IMAGE_TILE_HEADER_SIZE) // 2)
+    rows = max(1, min(height, pixels // width))
+    pixel_data = os.urandom(width * rows * 2)
+    crc = zlib.crc32(pixel_data)
+    tiles = []
+    for i in range(count):
+        y = (i * rows) % (height - rows + 1)
+        header = struct.pack(config.IMAGE_TILE_HEADER_FORMAT, 0, y, width, rows, crc, device.next_seq + i)
+        tiles.append((config.FRAME_TYPE_IMAGE_TILE, header + pixel_data))
+    start = time.perf_counter()
+    if not device._send_tiles(tiles):
+        raise OSError("tile transfer failed")
+    return time.perf_counter() - start, len(tiles[0][1])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    parser.add_argument("--sizes", default="1024,4096,8192", help="payload sizes in bytes")
+    parser.add_argument("--depths", default="1,2,4,8", help="frames in flight")
+    parser.add_argument("--count", type=int, default=64, help="frames per measurement")
+    args = parser.parse_args()
+    sizes = [min(int(s), config.TILE_PAYLOAD_SIZE) for s in args.sizes.split(",")]
+    depths = [int(d) for d in args.depths.split(",")]
+
+    device = DeviceManager()
+    if not device.connect():
+        return
+
+    print(f"\n{'stage':<9} {'size':>5} {'depth':>5} {'KB/s':>8} {'p50 ms':>8} {'p99 ms':>8} {'device us':>10}")
+    # Best throughput per (stage, size), for the cost breakdown.
+    best = {}
+    try:
+        for size in sizes:
+            for name, mode, flags in STAGES:
+                for depth in depths:
+                    seconds, rtts, crc_times = run_test_frames(device, mode, flags, size, depth, args.count)
+                    rate = size * args.count / seconds
+                    best[name, size] = max(best.get((name, size), 0), rate)
+                    device_us = f"{sum(crc_times) / len(crc_times):.0f}" if crc_times else "-"
+                    print(f"{name:<9} {size:>5} {depth:>5} {rate / 1024:>8.1f} "
+                          f"{percentile(rtts, 0.5) * 1000:>8.2f} {percentile(rtts, 0.99) * 1000:>8.2f} {device_us:>10}")
+
+            seconds, tile_size = run_draw(device, size, args.count)
+            rate = tile_size * args.count / seconds
+            best["draw", size] = rate
+            print(f"{'draw':<9} {tile_size:>5} {'queue':>5} {rate / 1024:>8.1f} {'-':>8} {'-':>8} {'-':>10}")
+    except (OSError, ValueError) as e:
+        print(f"Benchmark stopped: {e}")
+        device.close()
+        return
+
+    # Time per KB at the best window depth; each stage adds one cost.
+    print("\nCost per KB at the best depth (ms):")
+    print(f"{'size':>5} {'network':>8} {'crc':>8} {'draw':>8}")
+    for size in sizes:
+        network = 1024 / best["sink", size]
+        crc = 1024 / best["sink+crc", size] - network
+        draw = 1024 / best["draw", size] - network - crc
+        print(f"{size:>5} {network * 1000:>8.2f} {crc * 1000:>8.2f} {draw * 1000:>8.2f}")
+
+    stats = device.read_stats()
+    if stats:
+        print("\nDevice counters:")
+        for name, value in stats.items():
+            if name != "reserved":
+                print(f"  {name:<20} {value}")
+    device.close()
+
+
+if __name__ == "__main__":
+    main()
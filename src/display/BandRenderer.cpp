@@ -0,0 +1,127 @@
+// File: src/display/BandRenderer.cpp
+
+#include "BandRenderer.h"
+#include <algorithm>
+#include <cstring>
+
+// Each band goes out through Drawing::drawImageAsync in one call.
+static_assert((size_t)BAND_MAX_WIDTH * BAND_ROWS <= MAX_DRAW_BUFFER_PIXELS, "a band must fit in one image draw");
+
+BandRenderer::BandRenderer(Drawing& drawing) : m_drawing(drawing) {
+}
+
+void BandRenderer::clear() {
+    m_op_count = 0;
+}
+
+bool BandRenderer::add(const Op& op) {
+    if (m_op_count == MAX_OPS) return false;
+    m_ops[m_op_count++] = op;
+    return true;
+}
+
+bool BandRenderer::fillRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t color) {
+    return add({OpType::FILL, x, y, width, height, color, nullptr, nullptr});
+}
+
+bool BandRenderer::drawString(uint16_t x, uint16_t y, const char* str, uint16_t color, const custom_font_t* font) {
+    // The extent lets render() skip bands the text does not reach.
+    int32_t pen = 0;
+    int32_t width = 0;
+    for (const char* c = str; *c; ++c) {
+        const custom_glyph_t* glyph = font_find_glyph(font, *c);
+        if (!glyph) continue;
+        width = std::max<int32_t>({width, pen + glyph->advance, pen + glyph->x_offset + glyph->width});
+        pen += glyph->advance;
+    }
+    return add({OpType::TEXT, x, y, (uint16_t)std::min<int32_t>(width, UINT16_MAX), font->height, color, str, font});
+}
+
+bool BandRenderer::drawImage(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint16_t* pixels) {
+    return add({OpType::IMAGE, x, y, width, height, 0, pixels, nullptr});
+}
+
+bool BandRenderer::render(uint16_t x, uint16_t y, uint16_t width, uint16_t height) {
+    if (width == 0 || width > BAND_MAX_WIDTH) return false;
+    // A band from the last render may still be on its way to the panel.
+    wait_idle();
+    int buffer = 0;
+    for (uint16_t band_y = y; band_y < y + height; band_y += BAND_ROWS) {
+        uint16_t rows = std::min<uint16_t>(BAND_ROWS, y + height - band_y);
+        // The DMA is still reading the other buffer.
+        rasterize(m_bands[buffer], x, band_y, width, rows);
+        wait_idle();
+        if (!m_drawing.drawImageAsync(x, band_y, width, rows, m_bands[buffer])) {
+            // Refused while a transfer was running: wait for it and try once
+            // more. A band that is still refused (e.g. off the panel) fails the
+            // render rather than being lost while its buffer is reused.
+            wait_idle();
+            if (!m_drawing.drawImageAsync(x, band_y, width, rows, m_bands[buffer])) return false;
+        }
+        buffer ^= 1;
+    }
+    return true;
+}
+
+void BandRenderer::wait_idle() {
+    while (m_drawing.processDrawing() == Drawing::DrawStatus::BUSY) {
+        tight_loop_contents();
+    }
+}
+
+void BandRenderer::rasterize(uint16_t* band, uint16_t x, uint16_t y, uint16_t width, uint16_t rows) const {
+    std::fill_n(band, (size_t)width * rows, 0);
+    for (size_t i = 0; i < m_op_count; i++) {
+        const Op& op = m_ops[i];
+        // The part of the operation inside this band.
+        int left = std::max<int>(op.x, x);
+        int right = std::min<int>(op.x + op.width, x + width);
+        int top = std::max<int>(op.y, y);
+        int bottom = std::min<int>(op.y + op.height, y + rows);
+        if (left >= right || top >= bottom) continue;
+
+        switch (op.type) {
+        case OpType::FILL:
+            for (int row = top; row < bottom; row++) {
+                std::fill_n(band + (row - y) * width + (left - x), right - left, op.color);
+            }
+            break;
+        case OpType::IMAGE: {
+            const uint16_t* pixels = static_cast<const uint16_t*>(op.data);
+            for (int row = top; row < bottom; row++) {
+                memcpy(band + (row - y) * width + (left - x), pixels + (size_t)(row - op.y) * op.width + (left - op.x),
+                       (right - left) * sizeof(uint16_t));
+            }
+            break;
+        }
+        case OpType::TEXT:
+            rasterize_text(op, band, x, y, width, rows);
+            break;
+        }
+    }
+}
+
+// Same glyph placement as Drawing::drawString, clipped to the band. Only
+// glyphs with ink in the band are decoded.
+void BandRenderer::rasterize_text(const Op& op, uint16_t* band, uint16_t x, uint16_t y, uint16_t width, uint16_t rows) {
+    const custom_font_t* font = op.font;
+    int pen_x = op.x;
+    for (const char* c = static_cast<const char*>(op.data); *c; ++c) {
+        const custom_glyph_t* glyph = font_find_glyph(font, *c);
+        if (!glyph) continue;
+        int left = pen_x + glyph->x_offset - x;
+        int top = op.y + glyph->y_offset - y;
+        pen_x += glyph->advance;
+        if (left >= width || top >= rows || top + glyph->height <= 0) continue;
+        GlyphRuns runs(font, glyph);
+        uint8_t row, x0, x1;
+        while (runs.next(row, x0, x1)) {
+            int line = top + row;
+            if (line < 0) continue;
+            if (line >= rows) break;
+            int from = std::max(left + x0, 0);
+            int to = std::min<int>(left + x1, width);
+            if (from < to) std::fill_n(band + line * width + from, to - from, op.color);
+        }
+    }
+}
@@ -0,0 +1,62 @@
+// File: src/display/CustomFont.cpp
+
+#include "CustomFont.h"
+#include <algorithm>
+
+const custom_glyph_t* font_find_glyph(const custom_font_t* font, char c) {
+    uint8_t code = (uint8_t)c;
+    // Fonts have a handful of ranges at most.
+    for (uint8_t i = 0; i < font->range_count; ++i) {
+        const custom_font_range_t& range = font->ranges[i];
+        if (code < range.first) break;
+        if (code <= range.last) return &font->glyphs[range.glyph + (code - range.first)];
+    }
+    return nullptr;
+}
+
+GlyphRuns::GlyphRuns(const custom_font_t* font, const custom_glyph_t* glyph) :
+    m_data(font->bitmaps + glyph->offset),
+    m_rle(glyph->flags & GLYPH_RLE),
+    m_width(glyph->width),
+    m_total(glyph->width * glyph->height)
+{
+}
+
+uint16_t GlyphRuns::read_run() {
+    uint16_t length = 0;
+    uint8_t nibble;
+    do {
+        nibble = (m_data[m_nibble / 2] >> (m_nibble % 2 ? 4 : 0)) & 0x0F;
+        m_nibble++;
+        length += nibble;
+    } while (nibble == 15);
+    return length;
+}
+
+uint16_t GlyphRuns::count_bits(bool ink) const {
+    uint16_t end = m_pos;
+    while (end < m_total && (bool)((m_data[end / 8] >> (end % 8)) & 1) == ink) end++;
+    return end - m_pos;
+}
+
+bool GlyphRuns::next(uint8_t& row, uint8_t& x0, uint8_t& x1) {
+    while (m_pos < m_total) {
+        if (m_left == 0) {
+            bool ink = !m_ink;
+            m_left = m_rle ? read_run() : count_bits(ink);
+            m_ink = ink;
+            continue;
+        }
+        uint8_t col = m_pos % m_width;
+        uint16_t count = std::min<uint16_t>(m_left, m_width - col);
+        row = m_pos / m_width;
+        m_pos += count;
+        m_left -= count;
+        if (m_ink) {
+            x0 = col;
+            x1 = col + count;
+            return true;
+        }
+    }
+    return false;
+}
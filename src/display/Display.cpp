@@ -2,8 +2,9 @@
 
 #include "Display.h"
 #include "hardware/gpio.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
 #include "st7789_lcd.pio.h" // Generated by CMake
-#include "pico/cyw43_arch.h"
 #include "pico/time.h"
 
 // Screen configuration for GMT020-02
@@ -24,6 +25,15 @@ static const uint8_t st7789_init_seq[] = {
     0
 };
 
+static St7789Display* g_display_instance = nullptr;
+
+// Shared DMA_IRQ_1 handler; the instance checks that the interrupt is its own.
+static void dma_complete_irq_handler() {
+    if (g_display_instance) {
+        g_display_instance->_dma_irq();
+    }
+}
+
 St7789Display::St7789Display(PIO pio, uint pin_sda, uint pin_scl, uint pin_cs, uint pin_dc, uint pin_reset, DisplayOrientation orientation)
     : m_pio(pio), m_pin_sda(pin_sda), m_pin_scl(pin_scl), m_pin_cs(pin_cs), m_pin_dc(pin_dc), m_pin_reset(pin_reset), m_orientation(orientation)
 {
@@ -40,6 +50,11 @@ void St7789Display::init() {
     m_sm = pio_claim_unused_sm(m_pio, true);
     m_offset = pio_add_program(m_pio, &st7789_lcd_program);
     st7789_lcd_program_init(m_pio, m_sm, m_offset, m_pin_sda, m_pin_scl, SERIAL_CLK_DIV);
+    m_command_config = st7789_lcd_program_get_config(m_offset, m_pin_sda, m_pin_scl, SERIAL_CLK_DIV, 8);
+    m_pixel_config = st7789_lcd_program_get_config(m_offset, m_pin_sda, m_pin_scl, SERIAL_CLK_DIV, 16);
+    m_px32_offset = pio_add_program(m_pio, &st7789_lcd_px32_program);
+    m_px32_config = st7789_lcd_px32_program_get_config(m_px32_offset, m_pin_sda, m_pin_scl, SERIAL_CLK_DIV);
+    init_dma();
 
     uint32_t pin_mask = (1u << m_pin_cs) | (1u << m_pin_dc) | (1u << m_pin_reset);
     gpio_init_mask(pin_mask);
@@ -48,7 +63,76 @@ void St7789Display::init() {
     gpio_put(m_pin_cs, 1);
     gpio_put(m_pin_reset, 1);
     
+    // The init sequence has odd-length parameter lists, so it always goes out
+    // through the byte-wide program with DC on a GPIO.
     init_display();
+    if (m_transfer_mode == PixelTransferMode::FRAMED) {
+        load_programs(true);
+    }
+}
+
+void St7789Display::setPixelTransferMode(PixelTransferMode mode) {
+    waitForIdle();
+    m_transfer_mode = mode;
+    bool framed = (mode == PixelTransferMode::FRAMED);
+    if (m_dma_channel_claimed && framed != m_framed_loaded) {
+        load_programs(framed);
+    }
+}
+
+// The framed program does not fit in instruction memory next to the
+// byte-wide ones, so the two sets are swapped. DC follows the program.
+void St7789Display::load_programs(bool framed) {
+    pio_sm_set_enabled(m_pio, m_sm, false);
+    if (framed) {
+        pio_remove_program(m_pio, &st7789_lcd_program, m_offset);
+        pio_remove_program(m_pio, &st7789_lcd_px32_program, m_px32_offset);
+        m_framed_offset = pio_add_program(m_pio, &st7789_lcd_framed_program);
+        st7789_lcd_framed_program_init(m_pio, m_sm, m_framed_offset, m_pin_sda, m_pin_scl, m_pin_dc, SERIAL_CLK_DIV);
+    } else {
+        pio_remove_program(m_pio, &st7789_lcd_framed_program, m_framed_offset);
+        gpio_init(m_pin_dc);
+        gpio_set_dir(m_pin_dc, GPIO_OUT);
+        gpio_put(m_pin_dc, 1);
+        m_offset = pio_add_program(m_pio, &st7789_lcd_program);
+        m_command_config = st7789_lcd_program_get_config(m_offset, m_pin_sda, m_pin_scl, SERIAL_CLK_DIV, 8);
+        m_pixel_config = st7789_lcd_program_get_config(m_offset, m_pin_sda, m_pin_scl, SERIAL_CLK_DIV, 16);
+        m_px32_offset = pio_add_program(m_pio, &st7789_lcd_px32_program);
+        m_px32_config = st7789_lcd_px32_program_get_config(m_px32_offset, m_pin_sda, m_pin_scl, SERIAL_CLK_DIV);
+        st7789_lcd_set_config(m_pio, m_sm, m_offset, &m_command_config);
+    }
+    m_framed_loaded = framed;
+}
+
+void St7789Display::init_dma() {
+    m_dma_channel = dma_claim_unused_channel(true);
+
+    // Transfers into the TX FIFO, paced by the state machine's DREQ. Transfer
+    // size and read increment are chosen per transfer (see drawBufferAsync).
+    dma_channel_config c = dma_channel_get_default_config(m_dma_channel);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(m_pio, m_sm, true));
+    dma_channel_configure(m_dma_channel, &c, &m_pio->txf[m_sm], nullptr, 0, false);
+
+    // In FRAMED mode a second channel sends the window packets and then
+    // triggers the pixel channel through chain_to.
+    m_dma_packet_channel = dma_claim_unused_channel(true);
+    dma_channel_config pc = dma_channel_get_default_config(m_dma_packet_channel);
+    channel_config_set_transfer_data_size(&pc, DMA_SIZE_16);
+    channel_config_set_read_increment(&pc, true);
+    channel_config_set_write_increment(&pc, false);
+    channel_config_set_dreq(&pc, pio_get_dreq(m_pio, m_sm, true));
+    channel_config_set_chain_to(&pc, m_dma_channel);
+    dma_channel_configure(m_dma_packet_channel, &pc, &m_pio->txf[m_sm], m_packets, 0, false);
+    m_dma_last_channel = m_dma_channel;
+    m_dma_channel_claimed = true;
+
+    g_display_instance = this;
+    dma_channel_set_irq1_enabled(m_dma_channel, true);
+    dma_channel_set_irq1_enabled(m_dma_packet_channel, true);
+    irq_add_shared_handler(DMA_IRQ_1, &dma_complete_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_1, true);
 }
 
 void St7789Display::init_display() {
@@ -87,43 +171,210 @@ void St7789Display::send_command(const uint8_t *cmd, size_t count) {
     set_dc_cs(true, true);
 }
 
-void St7789Display::fillScreen(uint16_t color) {
-    drawBuffer(0, 0, m_width, m_height, nullptr, color);
-}
-
-void St7789Display::drawBuffer(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint16_t* buffer, uint16_t fillColor) {
+void St7789Display::set_window(uint16_t x, uint16_t y, uint16_t width, uint16_t height) {
     uint8_t cmd_caset[] = {0x2A, (uint8_t)(x >> 8), (uint8_t)(x), (uint8_t)((x + width - 1) >> 8), (uint8_t)(x + width - 1)};
     send_command(cmd_caset, sizeof(cmd_caset));
     uint8_t cmd_raset[] = {0x2B, (uint8_t)(y >> 8), (uint8_t)(y), (uint8_t)((y + height - 1) >> 8), (uint8_t)(y + height - 1)};
     send_command(cmd_raset, sizeof(cmd_raset));
     uint8_t cmd_ramwr = 0x2C;
     send_command(&cmd_ramwr, 1);
-    set_dc_cs(true, false);
+}
+
+void St7789Display::fillScreen(uint16_t color) {
+    drawBuffer(0, 0, m_width, m_height, nullptr, color);
+}
+
+void St7789Display::drawBuffer(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint16_t* buffer, uint16_t fillColor) {
+    waitForIdle();
+    drawBufferAsync(x, y, width, height, buffer, fillColor);
+    waitForIdle();
+}
+
+// Packets for the framed program: CASET, RASET and RAMWR, then the tag that
+// announces pixel_count payload units (or one unit repeated pixel_count times).
+size_t St7789Display::build_window_packets(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint32_t pixel_count, bool repeat) {
+    const uint16_t DATA_TAG = 0x8000;
+    const uint16_t REPEAT_FLAG = 0x4000;
+    uint16_t x_end = x + width - 1;
+    uint16_t y_end = y + height - 1;
+    size_t n = 0;
+    m_packets[n++] = 0x2A;
+    m_packets[n++] = DATA_TAG; m_packets[n++] = 1; m_packets[n++] = x; m_packets[n++] = x_end;
+    m_packets[n++] = 0x2B;
+    m_packets[n++] = DATA_TAG; m_packets[n++] = 1; m_packets[n++] = y; m_packets[n++] = y_end;
+    m_packets[n++] = 0x2C;
+    m_packets[n++] = DATA_TAG | (repeat ? REPEAT_FLAG : 0) | (uint16_t)((pixel_count - 1) >> 16);
+    m_packets[n++] = (uint16_t)((pixel_count - 1) & 0xffff);
+    return n;
+}
+
+bool St7789Display::drawBufferAsync(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint16_t* buffer, uint16_t fillColor) {
+    // An empty window would underflow the framed count (pixel_count - 1).
+    if (width == 0 || height == 0) return false;
+    if (isBusy()) return false;
+
+    uint32_t pixel_count = (uint32_t)width * height;
+    m_fill_word = ((uint32_t)fillColor << 16) | fillColor;
+    const void* src = buffer ? (const void*)buffer : (const void*)&m_fill_word;
 
-    uint32_t total_pixels = (uint32_t)width * height;
-
-    if (buffer) {
-        for (uint32_t i = 0; i < total_pixels; ++i) {
-            st7789_lcd_put(m_pio, m_sm, buffer[i] >> 8);
-            st7789_lcd_put(m_pio, m_sm, buffer[i] & 0xff);
-            
-            // Every 64 pixels, yield to the background scheduler. This allows
-            // the network stack to process incoming packets and other timers to run.
-            if ((i & 0x3F) == 0) {
-                cyw43_arch_poll();
-            }
+    dma_channel_config c = dma_get_channel_config(m_dma_channel);
+    channel_config_set_read_increment(&c, buffer != nullptr);
+
+    if (m_transfer_mode == PixelTransferMode::FRAMED) {
+        // No waits at all: the packet channel starts the pixel channel when it is done.
+        // A fill is a single repeat packet, so the pixel channel is not used.
+        bool fill = (buffer == nullptr);
+        size_t packet_count = build_window_packets(x, y, width, height, pixel_count, fill);
+        if (fill) {
+            m_packets[packet_count++] = fillColor;
         }
-    } else {
-        for (uint32_t i = 0; i < total_pixels; ++i) {
-            st7789_lcd_put(m_pio, m_sm, fillColor >> 8);
-            st7789_lcd_put(m_pio, m_sm, fillColor & 0xff);
-            
-            // --- Also apply the fix here for fill operations ---
-            if ((i & 0x3F) == 0) {
-                cyw43_arch_poll();
-            }
+        dma_channel_config pc = dma_get_channel_config(m_dma_packet_channel);
+        channel_config_set_chain_to(&pc, fill ? m_dma_packet_channel : m_dma_channel);
+        dma_channel_set_config(m_dma_packet_channel, &pc, false);
+
+        gpio_put(m_pin_cs, 0);
+        m_transfer_active = true;
+        m_stall_cleared = false;
+        if (fill) {
+            m_dma_last_channel = m_dma_packet_channel;
+        } else {
+            m_dma_last_channel = m_dma_channel;
+            channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+            dma_channel_configure(m_dma_channel, &c, &m_pio->txf[m_sm], src, pixel_count, false);
         }
+        dma_channel_set_read_addr(m_dma_packet_channel, m_packets, false);
+        dma_channel_set_trans_count(m_dma_packet_channel, packet_count, true);
+        return true;
+    }
+
+    set_window(x, y, width, height);
+    set_dc_cs(true, false);
+
+    bool packed = m_transfer_mode == PixelTransferMode::PACKED_32 && (pixel_count % 2) == 0 &&
+                  (buffer == nullptr || ((uintptr_t)buffer & 3) == 0);
+
+    // Pixels go out as whole FIFO words. The CPU is free from here on;
+    // the DMA channel keeps the FIFO topped up.
+    if (packed) {
+        st7789_lcd_set_config(m_pio, m_sm, m_px32_offset, &m_px32_config);
+    } else {
+        st7789_lcd_set_config(m_pio, m_sm, m_offset, &m_pixel_config);
+    }
+
+    channel_config_set_transfer_data_size(&c, packed ? DMA_SIZE_32 : DMA_SIZE_16);
+    m_dma_last_channel = m_dma_channel;
+    m_transfer_active = true;
+    m_stall_cleared = false;
+    dma_channel_configure(m_dma_channel, &c, &m_pio->txf[m_sm], src,
+                          packed ? pixel_count / 2 : pixel_count, true);
+    return true;
+}
+
+void St7789Display::beginWrite(uint16_t x, uint16_t y, uint16_t width, uint16_t height) {
+    waitForIdle();
+    if (width == 0 || height == 0) return;
+    uint32_t pixel_count = (uint32_t)width * height;
+
+    if (m_transfer_mode == PixelTransferMode::FRAMED) {
+        size_t packet_count = build_window_packets(x, y, width, height, pixel_count, false);
+        dma_channel_config pc = dma_get_channel_config(m_dma_packet_channel);
+        channel_config_set_chain_to(&pc, m_dma_packet_channel);
+        dma_channel_set_config(m_dma_packet_channel, &pc, false);
+        gpio_put(m_pin_cs, 0);
+        dma_channel_set_read_addr(m_dma_packet_channel, m_packets, false);
+        dma_channel_set_trans_count(m_dma_packet_channel, packet_count, true);
+    } else {
+        set_window(x, y, width, height);
+        set_dc_cs(true, false);
+        st7789_lcd_set_config(m_pio, m_sm, m_offset, &m_pixel_config);
     }
+    m_dma_last_channel = m_dma_channel;
+    m_streaming = true;
+}
+
+void St7789Display::writePixels(const uint16_t* pixels, uint32_t count) {
+    // Both channels feed the same FIFO, so the window packets and the previous
+    // chunk must be fully queued first.
+    dma_channel_wait_for_finish_blocking(m_dma_packet_channel);
+    dma_channel_wait_for_finish_blocking(m_dma_channel);
+
+    dma_channel_config c = dma_get_channel_config(m_dma_channel);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    dma_channel_configure(m_dma_channel, &c, &m_pio->txf[m_sm], pixels, count, true);
+}
+
+bool St7789Display::isWriting() const {
+    return dma_channel_is_busy(m_dma_packet_channel) || dma_channel_is_busy(m_dma_channel);
+}
+
+void St7789Display::endWrite() {
+    dma_channel_wait_for_finish_blocking(m_dma_packet_channel);
+    dma_channel_wait_for_finish_blocking(m_dma_channel);
+    m_streaming = false;
     st7789_lcd_wait_idle(m_pio, m_sm);
-    set_dc_cs(true, true);
-}
\ No newline at end of file
+    finish_transfer();
+}
+
+// Until the packet channel chains to it, the pixel channel is idle with its
+// full transfer count still loaded, hence the count check.
+bool St7789Display::dma_done() const {
+    return !dma_channel_is_busy(m_dma_last_channel) && dma_channel_hw_addr(m_dma_last_channel)->transfer_count == 0;
+}
+
+// The DMA is done once the last word is in the FIFO. A framed fill is only a
+// few words, and the state machine goes on repeating the colour for up to a
+// frame time after that, so the state machine is checked too, without waiting.
+bool St7789Display::sm_idle() {
+    if (!m_stall_cleared) {
+        st7789_lcd_clear_stall(m_pio, m_sm);
+        m_stall_cleared = true;
+    }
+    return st7789_lcd_is_stalled(m_pio, m_sm);
+}
+
+bool St7789Display::isBusy() {
+    if (m_streaming) return true;
+    if (!m_transfer_active) return false;
+    if (!dma_done() || !sm_idle()) return true;
+    finish_transfer();
+    return false;
+}
+
+void St7789Display::waitForIdle() {
+    if (!m_transfer_active) return;
+    while (!dma_done()) {
+        tight_loop_contents();
+    }
+    st7789_lcd_wait_idle(m_pio, m_sm);
+    finish_transfer();
+}
+
+void St7789Display::setTransferCompleteCallback(TransferCompleteCallback callback, void* context) {
+    m_on_complete = callback;
+    m_on_complete_context = context;
+}
+
+// Releases CS and goes back to byte-wide commands. The state machine must
+// have shifted out the last word.
+void St7789Display::finish_transfer() {
+    if (m_framed_loaded) {
+        gpio_put(m_pin_cs, 1);
+    } else {
+        set_dc_cs(true, true);
+        st7789_lcd_set_config(m_pio, m_sm, m_offset, &m_command_config);
+    }
+    m_transfer_active = false;
+}
+
+void St7789Display::_dma_irq() {
+    bool packets_done = dma_channel_get_irq1_status(m_dma_packet_channel);
+    bool pixels_done = dma_channel_get_irq1_status(m_dma_channel);
+    if (packets_done) dma_channel_acknowledge_irq1(m_dma_packet_channel);
+    if (pixels_done) dma_channel_acknowledge_irq1(m_dma_channel);
+    // The packet channel also finishes ahead of every framed pixel transfer.
+    bool done = (m_dma_last_channel == m_dma_channel) ? pixels_done : packets_done;
+    if (done && m_on_complete) {
+        m_on_complete(m_on_complete_context);
+    }
+}
@@ -1,93 +1,385 @@
 // File: src/display/Drawing.cpp
 
 #include "Drawing.h"
+#include "FrameProtocol.h"
+#include "hardware/interp.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <cstdlib>
 
 Drawing::Drawing(St7789Display& display) : 
     m_display(display),
-    m_status(DrawStatus::IDLE),
-    m_async_y_offset(0) 
+    m_status(DrawStatus::IDLE)
 {
-    m_async_pixel_buffer.reserve(MAX_DRAW_BUFFER_PIXELS);
-}
-
-void Drawing::drawPixel(uint16_t x, uint16_t y, uint16_t color) {
-    if (x >= m_display.getWidth() || y >= m_display.getHeight()) return;
-    m_display.drawBuffer(x, y, 1, 1, &color);
 }
 
 void Drawing::fillRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t color) {
     if (x >= m_display.getWidth() || y >= m_display.getHeight()) return;
     if ((x + width) > m_display.getWidth()) width = m_display.getWidth() - x;
     if ((y + height) > m_display.getHeight()) height = m_display.getHeight() - y;
-    m_display.drawBuffer(x, y, width, height, nullptr, color);
-}
-
-void Drawing::drawChar(uint16_t x, uint16_t y, char c, uint16_t color, const custom_font_t* font) {
-    if (c < font->first_char || c > font->last_char) return;
-    uint32_t char_offset = (c - font->first_char) * font->height * font->bytes_per_row;
-    const uint8_t* char_data = font->data + char_offset;
-    for (uint8_t j = 0; j < font->height; ++j) {
-        for (uint8_t byte_idx = 0; byte_idx < font->bytes_per_row; ++byte_idx) {
-            uint8_t line = char_data[j * font->bytes_per_row + byte_idx];
-            for (uint8_t i = 0; i < 8; ++i) {
-                uint8_t x_offset = byte_idx * 8 + i;
-                if (x_offset >= font->width) continue;
-                if ((line >> i) & 1) drawPixel(x + x_offset, y + j, color);
-            }
+    if (width == 0 || height == 0) return;
+    if (m_framebuffer) {
+        m_framebuffer->fill(x, y, width, height, color);
+        return;
+    }
+    // The fill runs without the CPU; the next draw call waits for it if needed.
+    m_display.waitForIdle();
+    m_display.drawBufferAsync(x, y, width, height, nullptr, color);
+}
+
+uint16_t Drawing::text_width(uint16_t x, const char* str, const custom_font_t* font) const {
+    if (x >= m_display.getWidth()) return 0;
+    int32_t pen = 0;
+    int32_t width = 0;
+    for (; *str; ++str) {
+        const custom_glyph_t* glyph = font_find_glyph(font, *str);
+        if (!glyph) continue;
+        // Ink may reach past the advance.
+        width = std::max<int32_t>({width, pen + glyph->advance, pen + glyph->x_offset + glyph->width});
+        pen += glyph->advance;
+    }
+    return (uint16_t)std::min<int32_t>({width, m_display.getWidth() - x, (int32_t)MAX_ROW_PIXELS});
+}
+
+// Sets bits [from, to) of 'mask'.
+static void set_bits(uint32_t* mask, int32_t from, int32_t to) {
+    while (from < to) {
+        uint32_t shift = from % 32;
+        uint32_t count = std::min<int32_t>(32 - shift, to - from);
+        mask[from / 32] |= (count == 32 ? ~0u : (1u << count) - 1) << shift;
+        from += count;
+    }
+}
+
+void Drawing::text_mask(const char* str, const custom_font_t* font, uint16_t top, uint16_t width) {
+    memset(m_text_mask, 0, sizeof(m_text_mask));
+    int32_t pen = 0;
+    for (; *str; ++str) {
+        const custom_glyph_t* glyph = font_find_glyph(font, *str);
+        if (!glyph) continue;
+        int32_t left = pen + glyph->x_offset;
+        pen += glyph->advance;
+        // Only glyphs with ink in these rows are decoded.
+        if (left >= width || glyph->y_offset + glyph->height <= top || glyph->y_offset >= top + (int32_t)TEXT_MASK_ROWS) continue;
+        GlyphRuns runs(font, glyph);
+        uint8_t row, x0, x1;
+        while (runs.next(row, x0, x1)) {
+            int32_t line = glyph->y_offset + row - top;
+            if (line < 0) continue;
+            if (line >= (int32_t)TEXT_MASK_ROWS) break;
+            // Glyphs may overlap, so their runs are ORed in.
+            set_bits(m_text_mask[line], std::max<int32_t>(left + x0, 0), std::min<int32_t>(left + x1, width));
         }
     }
 }
 
+// Finds the next run of set bits at or after 'start'; false if there is none.
+static bool next_run(const uint32_t* mask, uint16_t width, uint16_t& start, uint16_t& end) {
+    auto bit = [mask](uint16_t i) { return (mask[i / 32] >> (i % 32)) & 1; };
+    while (start < width && !bit(start)) {
+        start = (start % 32 == 0 && mask[start / 32] == 0) ? start + 32 : start + 1;
+    }
+    if (start >= width) return false;
+    end = start;
+    while (end < width && bit(end)) end++;
+    return true;
+}
+
 void Drawing::drawString(uint16_t x, uint16_t y, const char* str, uint16_t color, const custom_font_t* font) {
-    uint16_t current_x = x;
-    while (*str) {
-        char c = *str++;
-        drawChar(current_x, y, c, color, font);
-        
-        // Use the specific width for this character, plus a 1-pixel gap
-        uint8_t char_width = font->widths[c - font->first_char];
-        current_x += char_width + 1;
+    if (y >= m_display.getHeight()) return;
+    uint16_t width = text_width(x, str, font);
+    uint16_t height = std::min<uint16_t>(font->height, m_display.getHeight() - y);
+    // Runs that started at row 'top' and have repeated unchanged on every
+    // row since, so a vertical stroke goes out as one rectangle. Both lists
+    // are in column order.
+    struct Span { uint16_t start, end, top; };
+    Span spans[2][MAX_OPEN_SPANS];
+    size_t open_count = 0;
+    for (uint16_t row = 0; row <= height; ++row) {
+        const Span* open = spans[row & 1];
+        Span* next = spans[(row + 1) & 1];
+        size_t next_count = 0;
+        size_t i = 0;
+        uint16_t start = 0, end = 0;
+        // One extra pass with no runs closes what is still open.
+        if (row < height && row % TEXT_MASK_ROWS == 0) text_mask(str, font, row, width);
+        const uint32_t* mask = m_text_mask[row % TEXT_MASK_ROWS];
+        while (row < height && next_run(mask, width, start, end)) {
+            for (; i < open_count && open[i].start < start; ++i) {
+                fillRect(x + open[i].start, y + open[i].top, open[i].end - open[i].start, row - open[i].top, color);
+            }
+            uint16_t top = row;
+            if (i < open_count && open[i].start == start && open[i].end == end) top = open[i++].top;
+            if (next_count < MAX_OPEN_SPANS) {
+                next[next_count++] = {start, end, top};
+            } else {
+                fillRect(x + start, y + top, end - start, row + 1 - top, color);
+            }
+            start = end;
+        }
+        for (; i < open_count; ++i) {
+            fillRect(x + open[i].start, y + open[i].top, open[i].end - open[i].start, row - open[i].top, color);
+        }
+        open_count = next_count;
     }
 }
 
-void Drawing::drawImage(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint16_t* image_data) {
-    if (x >= m_display.getWidth() || y >= m_display.getHeight()) return;
-    m_display.drawBuffer(x, y, width, height, image_data);
+void Drawing::drawString(uint16_t x, uint16_t y, const char* str, uint16_t color, uint16_t background, const custom_font_t* font) {
+    if (y >= m_display.getHeight()) return;
+    uint16_t width = text_width(x, str, font);
+    uint16_t height = std::min<uint16_t>(font->height, m_display.getHeight() - y);
+    if (width == 0 || height == 0) return;
+    beginWrite(x, y, width, height);
+    for (uint16_t row = 0; row < height; ++row) {
+        // writePixels only returns once the row before last has left this buffer.
+        uint16_t* out = m_row_buffers[row & 1];
+        std::fill_n(out, width, background);
+        if (row % TEXT_MASK_ROWS == 0) text_mask(str, font, row, width);
+        const uint32_t* mask = m_text_mask[row % TEXT_MASK_ROWS];
+        uint16_t start = 0, end = 0;
+        for (; next_run(mask, width, start, end); start = end) {
+            std::fill_n(out + start, end - start, color);
+        }
+        writePixels(out, width);
+    }
+    endWrite();
 }
 
 bool Drawing::drawImageAsync(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint16_t* image_data) {
     if (m_status == DrawStatus::BUSY) return false;
+    if (width == 0 || height == 0) return false;
+    if (x + width > m_display.getWidth() || y + height > m_display.getHeight()) return false;
     size_t pixel_count = (size_t)width * height;
     if (pixel_count > MAX_DRAW_BUFFER_PIXELS) return false;
+    if (m_framebuffer) {
+        for (uint16_t row = 0; row < height; ++row) {
+            m_framebuffer->writeRow(x, y + row, image_data + (size_t)row * width, width);
+        }
+        return true;
+    }
 
+    // The DMA reads the caller's buffer directly; no copy is taken.
+    m_display.waitForIdle(); // A fillRect may still be running
+    if (!m_display.drawBufferAsync(x, y, width, height, image_data)) {
+        return false;
+    }
     m_status = DrawStatus::BUSY;
-    m_async_x = x;
-    m_async_y = y;
-    m_async_width = width;
-    m_async_height = height;
-    m_async_y_offset = 0;
-    m_async_pixel_buffer.assign(image_data, image_data + pixel_count);
     return true;
 }
 
 Drawing::DrawStatus Drawing::processDrawing() {
-    if (m_status == DrawStatus::IDLE) return DrawStatus::IDLE;
+    if (m_status == DrawStatus::BUSY && !m_display.isBusy()) {
+        m_status = DrawStatus::IDLE;
+    }
+    return m_status;
+}
 
-    const int ROWS_PER_CHUNK = 4;
-    int rows_remaining = m_async_height - m_async_y_offset;
-    int rows_to_draw = (rows_remaining < ROWS_PER_CHUNK) ? rows_remaining : ROWS_PER_CHUNK;
+bool Drawing::flush() {
+    if (!m_framebuffer || m_status == DrawStatus::BUSY) return false;
+    uint16_t x, y, width, height;
+    if (!m_framebuffer->takeDirtyRect(x, y, width, height)) return false;
 
-    if (rows_to_draw > 0) {
-        uint16_t start_y = m_async_y + m_async_y_offset;
-        const uint16_t* chunk_pixel_data = m_async_pixel_buffer.data() + ((size_t)m_async_y_offset * m_async_width);
-        drawImage(m_async_x, start_y, m_async_width, rows_to_draw, chunk_pixel_data);
-        m_async_y_offset += rows_to_draw;
+    if (width == m_framebuffer->getWidth()) {
+        m_display.waitForIdle();
+        if (m_display.drawBufferAsync(x, y, width, height, m_framebuffer->row(y))) {
+            m_status = DrawStatus::BUSY;
+        }
+        return true;
+    }
+    // writePixels returns once the row before has been queued, and the rows
+    // stay put, so no copy is needed.
+    m_display.beginWrite(x, y, width, height);
+    for (uint16_t row = 0; row < height; ++row) {
+        m_display.writePixels(m_framebuffer->row(y + row) + x, width);
     }
+    m_display.endWrite();
+    return true;
+}
 
-    if (m_async_y_offset >= m_async_height) {
-        m_status = DrawStatus::IDLE;;
-        m_async_pixel_buffer.clear();
+void Drawing::beginWrite(uint16_t x, uint16_t y, uint16_t width, uint16_t height) {
+    if (!m_framebuffer) {
+        m_display.beginWrite(x, y, width, height);
+        return;
     }
-    return m_status;
-}
\ No newline at end of file
+    m_window_x = x;
+    m_window_y = y;
+    m_window_width = width;
+    m_window_height = height;
+    m_window_pos = 0;
+}
+
+void Drawing::writePixels(const uint16_t* pixels, uint32_t count) {
+    if (!m_framebuffer) {
+        m_display.writePixels(pixels, count);
+        return;
+    }
+    // Pixels beyond the window are dropped, as the panel would.
+    uint32_t window_pixels = (uint32_t)m_window_width * m_window_height;
+    while (count > 0 && m_window_pos < window_pixels) {
+        uint16_t row = m_window_pos / m_window_width;
+        uint16_t col = m_window_pos % m_window_width;
+        uint16_t n = (uint16_t)std::min<uint32_t>(count, m_window_width - col);
+        m_framebuffer->writeRow(m_window_x + col, m_window_y + row, pixels, n);
+        pixels += n;
+        count -= n;
+        m_window_pos += n;
+    }
+}
+
+void Drawing::endWrite() {
+    if (!m_framebuffer) m_display.endWrite();
+}
+
+bool Drawing::isWriting() const {
+    return !m_framebuffer && m_display.isWriting();
+}
+bool Drawing::drawRleImage(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint8_t* data, size_t length) {
+    if (m_status == DrawStatus::BUSY) return false;
+    if (x >= m_display.getWidth() || y >= m_display.getHeight()) return false;
+    if (width == 0 || height == 0 || width > MAX_ROW_PIXELS) return false;
+    if (x + width > m_display.getWidth() || y + height > m_display.getHeight()) return false;
+
+    const uint8_t* end = data + length;
+    bool ok = true;
+    beginWrite(x, y, width, height);
+    for (uint16_t row = 0; row < height; ++row) {
+        // writePixels only returns once the row before last has left this buffer.
+        uint16_t* out = m_row_buffers[row & 1];
+        const uint16_t* above = row ? m_row_buffers[(row - 1) & 1] : nullptr;
+        if (ok && !decode_rle_row(out, above, width, data, end)) {
+            ok = false;
+        }
+        if (!ok) {
+            // The window still expects every pixel.
+            memset(out, 0, width * sizeof(uint16_t));
+        }
+        writePixels(out, width);
+    }
+    endWrite();
+    return ok && data == end;
+}
+
+bool Drawing::decode_rle_row(uint16_t* out, const uint16_t* above, uint16_t width, const uint8_t*& data, const uint8_t* end) {
+    uint16_t x = 0;
+    while (x < width) {
+        if (data >= end) return false;
+        uint8_t op = *data++;
+        if (!(op & Protocol::RLE_OP_REPEAT)) {
+            size_t count = (op & 0x7F) + 1;
+            if (x + count > width || (size_t)(end - data) < count * 2) return false;
+            memcpy(out + x, data, count * 2);
+            data += count * 2;
+            x += count;
+        } else if (op & Protocol::RLE_OP_COPY_UP) {
+            size_t count = (op & 0x3F) + 1;
+            if (!above || x + count > width) return false;
+            memcpy(out + x, above + x, count * 2);
+            x += count;
+        } else {
+            size_t count = (op & 0x3F) + 1;
+            if (x + count > width || end - data < 2) return false;
+            uint16_t pixel = data[0] | (data[1] << 8);
+            data += 2;
+            for (uint16_t* p = out + x; p < out + x + count; ++p) *p = pixel;
+            x += count;
+        }
+    }
+    return true;
+}
+
+bool Drawing::drawPaletteImage(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t bits_per_pixel,
+                               const uint16_t* palette, size_t palette_count, const uint8_t* indices, size_t length) {
+    if (m_status == DrawStatus::BUSY) return false;
+    if (bits_per_pixel != 1 && bits_per_pixel != 2 && bits_per_pixel != 4 && bits_per_pixel != 8) return false;
+    if (palette_count == 0 || palette_count > 256) return false;
+    if (width == 0 || height == 0 || width > MAX_ROW_PIXELS) return false;
+    if (x + width > m_display.getWidth() || y + height > m_display.getHeight()) return false;
+    size_t bytes_per_row = ((size_t)width * bits_per_pixel + 7) / 8;
+    if (bytes_per_row * height != length) return false;
+
+    // A full-size, aligned copy of the palette keeps every index in bounds.
+    memcpy(m_palette, palette, palette_count * sizeof(uint16_t));
+    memset(m_palette + palette_count, 0, (256 - palette_count) * sizeof(uint16_t));
+
+    // Lane 1 shifts the current index byte down by one pixel on every pop.
+    // Lane 0 reads lane 1's accumulator and masks out the index, pre-scaled
+    // by 2 (the byte is loaded shifted left by one), so POP0 returns the
+    // address of the palette entry.
+    interp_config lane0 = interp_default_config();
+    interp_config_set_cross_input(&lane0, true);
+    interp_config_set_shift(&lane0, 0);
+    interp_config_set_mask(&lane0, 1, bits_per_pixel);
+    interp_set_config(interp0, 0, &lane0);
+    interp_config lane1 = interp_default_config();
+    interp_config_set_shift(&lane1, bits_per_pixel);
+    interp_set_config(interp0, 1, &lane1);
+    interp0->base[0] = (uintptr_t)m_palette;
+    interp0->base[1] = 0;
+
+    uint pixels_per_byte = 8 / bits_per_pixel;
+    beginWrite(x, y, width, height);
+    for (uint16_t row = 0; row < height; ++row) {
+        uint16_t* out = m_row_buffers[row & 1];
+        const uint8_t* src = indices + row * bytes_per_row;
+        uint16_t col = 0;
+        while (col < width) {
+            interp0->accum[1] = (uint32_t)*src++ << 1;
+            uint remaining = width - col;
+            uint n = remaining < pixels_per_byte ? remaining : pixels_per_byte;
+            for (uint i = 0; i < n; ++i) {
+                out[col++] = *(const uint16_t*)(uintptr_t)interp0->pop[0];
+            }
+        }
+        writePixels(out, width);
+    }
+    endWrite();
+    return true;
+}
+
+// --- Benchmark ---
+// The baseline: every inked pixel as its own 1x1 window, as drawString
+// plotted text before it rasterized spans.
+static void draw_string_per_pixel(Drawing& drawing, uint16_t x, uint16_t y, const char* str, uint16_t color, const custom_font_t* font) {
+    int32_t pen = x;
+    for (; *str; ++str) {
+        const custom_glyph_t* glyph = font_find_glyph(font, *str);
+        if (!glyph) continue;
+        GlyphRuns runs(font, glyph);
+        uint8_t row, x0, x1;
+        while (runs.next(row, x0, x1)) {
+            for (uint8_t col = x0; col < x1; ++col) {
+                int32_t px = pen + glyph->x_offset + col;
+                if (px >= 0) drawing.fillRect((uint16_t)px, y + glyph->y_offset + row, 1, 1, color);
+            }
+        }
+        pen += glyph->advance;
+    }
+}
+
+void text_benchmark(St7789Display& display, Drawing& drawing, const custom_font_t* font) {
+    static const char* const STRINGS[] = {"Connecting to Wi-Fi...", "Hello, World! 0123456789"};
+    constexpr int REPEATS = 8;
+    printf("drawString, us per string (per pixel / spans / spans with background):\n");
+    for (const char* str : STRINGS) {
+        uint32_t elapsed_us[3];
+        for (int mode = 0; mode < 3; mode++) {
+            uint32_t start_us = time_us_32();
+            for (int r = 0; r < REPEATS; r++) {
+                if (mode == 0) {
+                    draw_string_per_pixel(drawing, 0, 0, str, 0xFFFF, font);
+                } else if (mode == 1) {
+                    drawing.drawString(0, 0, str, 0xFFFF, font);
+                } else {
+                    drawing.drawString(0, 0, str, 0xFFFF, 0x0000, font);
+                }
+            }
+            display.waitForIdle();
+            elapsed_us[mode] = time_us_32() - start_us;
+        }
+        printf("  \"%s\": %lu %lu %lu\n", str, (unsigned long)(elapsed_us[0] / REPEATS),
+               (unsigned long)(elapsed_us[1] / REPEATS), (unsigned long)(elapsed_us[2] / REPEATS));
+    }
+    drawing.fillRect(0, 0, display.getWidth(), font->height, 0x0000);
+    display.waitForIdle();
+}
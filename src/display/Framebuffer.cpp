@@ -0,0 +1,124 @@
+// File: src/display/Framebuffer.cpp
+
+#include "Framebuffer.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+bool Framebuffer::init(uint16_t width, uint16_t height) {
+    m_pixels = new (std::nothrow) uint16_t[(size_t)width * height];
+    m_dirty_x0 = new (std::nothrow) uint16_t[height];
+    m_dirty_x1 = new (std::nothrow) uint16_t[height];
+    if (!m_pixels || !m_dirty_x0 || !m_dirty_x1) {
+        delete[] m_pixels;
+        delete[] m_dirty_x0;
+        delete[] m_dirty_x1;
+        m_pixels = m_dirty_x0 = m_dirty_x1 = nullptr;
+        return false;
+    }
+    m_width = width;
+    m_height = height;
+    memset(m_pixels, 0, (size_t)width * height * sizeof(uint16_t));
+    for (uint16_t y = 0; y < height; y++) {
+        m_dirty_x0[y] = width;
+        m_dirty_x1[y] = 0;
+    }
+    return true;
+}
+
+// Trims width and height so the rectangle ends inside the framebuffer.
+// False if nothing is left.
+bool Framebuffer::clip(uint16_t x, uint16_t y, uint16_t& width, uint16_t& height) const {
+    if (x >= m_width || y >= m_height) return false;
+    width = std::min<uint16_t>(width, m_width - x);
+    height = std::min<uint16_t>(height, m_height - y);
+    return width > 0 && height > 0;
+}
+
+void Framebuffer::markDirty(uint16_t x, uint16_t y, uint16_t width, uint16_t height) {
+    if (!clip(x, y, width, height)) return;
+    if (!isDirty()) {
+        m_dirty_since_us = time_us_32();
+        m_dirty_top = y;
+        m_dirty_bottom = y + height;
+    } else {
+        m_dirty_top = std::min<uint16_t>(m_dirty_top, y);
+        m_dirty_bottom = std::max<uint16_t>(m_dirty_bottom, y + height);
+    }
+    for (uint16_t row = y; row < y + height; row++) {
+        m_dirty_x0[row] = std::min<uint16_t>(m_dirty_x0[row], x);
+        m_dirty_x1[row] = std::max<uint16_t>(m_dirty_x1[row], x + width);
+    }
+}
+
+bool Framebuffer::takeDirtyRect(uint16_t& x, uint16_t& y, uint16_t& width, uint16_t& height) {
+    while (m_dirty_top < m_dirty_bottom && m_dirty_x0[m_dirty_top] >= m_dirty_x1[m_dirty_top]) {
+        m_dirty_top++;
+    }
+    if (!isDirty()) return false;
+
+    uint16_t x0 = m_width;
+    uint16_t x1 = 0;
+    uint16_t end = m_dirty_top;
+    while (end < m_dirty_bottom && m_dirty_x0[end] < m_dirty_x1[end]) {
+        x0 = std::min(x0, m_dirty_x0[end]);
+        x1 = std::max(x1, m_dirty_x1[end]);
+        m_dirty_x0[end] = m_width;
+        m_dirty_x1[end] = 0;
+        end++;
+    }
+    x = x0;
+    y = m_dirty_top;
+    width = x1 - x0;
+    height = end - m_dirty_top;
+    m_dirty_top = end;
+    return true;
+}
+
+void Framebuffer::fill(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t color) {
+    if (!clip(x, y, width, height)) return;
+    for (uint16_t row = y; row < y + height; row++) {
+        std::fill_n(m_pixels + (size_t)row * m_width + x, width, color);
+    }
+    markDirty(x, y, width, height);
+}
+
+void Framebuffer::setPixel(uint16_t x, uint16_t y, uint16_t color) {
+    if (x >= m_width || y >= m_height) return;
+    m_pixels[(size_t)y * m_width + x] = color;
+    markDirty(x, y, 1, 1);
+}
+
+void Framebuffer::writeRow(uint16_t x, uint16_t y, const uint16_t* pixels, uint16_t count) {
+    uint16_t height = 1;
+    if (!clip(x, y, count, height)) return;
+    memcpy(m_pixels + (size_t)y * m_width + x, pixels, count * sizeof(uint16_t));
+    markDirty(x, y, count, 1);
+}
+
+void Framebuffer::copy(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t dst_x, uint16_t dst_y) {
+    if (!clip(x, y, width, height) || !clip(dst_x, dst_y, width, height)) return;
+    // Rows are copied away from the destination so none is overwritten
+    // before it has been read; memmove takes care of each row.
+    for (uint16_t i = 0; i < height; i++) {
+        uint16_t row = dst_y > y ? height - 1 - i : i;
+        memmove(m_pixels + (size_t)(dst_y + row) * m_width + dst_x,
+                m_pixels + (size_t)(y + row) * m_width + x, width * sizeof(uint16_t));
+    }
+    markDirty(dst_x, dst_y, width, height);
+}
+
+void Framebuffer::scroll(uint16_t x, uint16_t y, uint16_t width, uint16_t height, int16_t dx, int16_t dy, uint16_t fill_color) {
+    if (!clip(x, y, width, height)) return;
+    uint16_t shift_x = std::abs(dx);
+    uint16_t shift_y = std::abs(dy);
+    if (shift_x >= width || shift_y >= height) {
+        fill(x, y, width, height, fill_color);
+        return;
+    }
+    copy(dx < 0 ? x + shift_x : x, dy < 0 ? y + shift_y : y, width - shift_x, height - shift_y,
+         dx > 0 ? x + shift_x : x, dy > 0 ? y + shift_y : y);
+    if (shift_y) fill(x, dy > 0 ? y : y + height - shift_y, width, shift_y, fill_color);
+    if (shift_x) fill(dx > 0 ? x : x + width - shift_x, y, shift_x, height, fill_color);
+}
@@ -24,6 +24,7 @@ void HidDevice::sendHidReport(const uint8_t* report, uint16_t size) { if (isConn
 void HidDevice::onReadyToSend_impl() {}
 void HidDevice::onHidSubscribed_impl() {}
 void HidDevice::onTypingTimer_impl(btstack_timer_source_t* ts) { (void)ts; }
+void HidDevice::onConnectionChanged_impl() {}
 
 void HidDevice::onReadyToSend() { onReadyToSend_impl(); }
 void HidDevice::onHidSubscribed() { onHidSubscribed_impl(); }
@@ -39,12 +40,14 @@ void HidDevice::handlePacket(uint8_t packet_type, uint16_t, uint8_t* packet, uin
             if (hci_event_connection_complete_get_status(packet) == 0) {
                 m_connection_handle = hci_event_connection_complete_get_connection_handle(packet);
                 printf("BT Connected (ACL), Handle: 0x%04X\n", m_connection_handle);
+                onConnectionChanged_impl();
             }
             break;
         // ---------------------
 
         case HCI_EVENT_DISCONNECTION_COMPLETE:
             m_connection_handle = HCI_CON_HANDLE_INVALID;
+            onConnectionChanged_impl();
             printf("Disconnected\n");
             break;
             
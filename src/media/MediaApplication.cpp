@@ -8,72 +8,24 @@
 #include "hardware/gpio.h"
 #include "pico/cyw43_arch.h"
 #include "lwip/ip4_addr.h"
+#include "lwip/stats.h"
 #include "hardware/watchdog.h"
+#include "pico/multicore.h"
+#include "pico/rand.h"
+#include "Crc32.h"
 #include <algorithm>
 
-// This pre-computed table is for the standard CRC-32 algorithm (as used in PNG, Ethernet)
-static const uint32_t crc32_table[256] = {
-	0x00000000L, 0x77073096L, 0xee0e612cL, 0x990951baL, 0x076dc419L,
-	0x706af48fL, 0xe963a535L, 0x9e6495a3L, 0x0edb8832L, 0x79dcb8a4L,
-	0xe0d5e91eL, 0x97d2d988L, 0x09b64c2bL, 0x7eb17cbdL, 0xe7b82d07L,
-	0x90bf1d91L, 0x1db71064L, 0x6ab020f2L, 0xf3b97148L, 0x84be41deL,
-	0x1adad47dL, 0x6ddde4ebL, 0xf4d4b551L, 0x83d385c7L, 0x136c9856L,
-	0x646ba8c0L, 0xfd62f97aL, 0x8a65c9ecL, 0x14015c4fL, 0x63066cd9L,
-	0xfa0f3d63L, 0x8d080df5L, 0x3b6e20c8L, 0x4c69105eL, 0xd56041e4L,
-	0xa2677172L, 0x3c03e4d1L, 0x4b04d447L, 0xd20d85fdL, 0xa50ab56bL,
-	0x35b5a8faL, 0x42b2986cL, 0xdbbbc9d6L, 0xacbcf940L, 0x32d86ce3L,
-	0x45df5c75L, 0xdcd60dcfL, 0xabd13d59L, 0x26d930acL, 0x51de003aL,
-	0xc8d75180L, 0xbfd06116L, 0x21b4f4b5L, 0x56b3c423L, 0xcfba9599L,
-	0xb8bda50fL, 0x2802b89eL, 0x5f058808L, 0xc60cd9b2L, 0xb10be924L,
-	0x2f6f7c87L, 0x58684c11L, 0xc1611dabL, 0xb6662d3dL, 0x76dc4190L,
-	0x01db7106L, 0x98d220bcL, 0xefd5102aL, 0x71b18589L, 0x06b6b51fL,
-	0x9fbfe4a5L, 0xe8b8d433L, 0x7807c9a2L, 0x0f00f934L, 0x9609a88eL,
-	0xe10e9818L, 0x7f6a0dbbL, 0x086d3d2dL, 0x91646c97L, 0xe6635c01L,
-	0x6b6b51f4L, 0x1c6c6162L, 0x856530d8L, 0xf262004eL, 0x6c0695edL,
-	0x1b01a57bL, 0x8208f4c1L, 0xf50fc457L, 0x65b0d9c6L, 0x12b7e950L,
-	0x8bbeb8eaL, 0xfcb9887c, 0x62dd1ddfL, 0x15da2d49L, 0x8cd37cf3L,
-	0xfbd44c65L, 0x4db26158L, 0x3ab551ceL, 0xa3bc0074L, 0xd4bb30e2L,
-	0x4adfa541L, 0x3dd895d7L, 0xa4d1c46dL, 0xd3d6f4fbL, 0x4369e96aL,
-	0x346ed9fcL, 0xad678846L, 0xda60b8d0L, 0x44042d73L, 0x33031de5L,
-	0xaa0a4c5fL, 0xdd0d7cc9L, 0x5005713c, 0x270241aaL, 0xbe0b1010L,
-	0xc90c2086L, 0x5768b525L, 0x206f85b3L, 0xb966d409L, 0xce61e49fL,
-	0x5edef90eL, 0x29d9c998L, 0xb0d09822L, 0xc7d7a8b4L, 0x59b33d17L,
-	0x2eb40d81L, 0xb7bd5c3bL, 0xc0ba6cadL, 0xedb88320L, 0x9abfb3b6L,
-	0x03b6e20cL, 0x74b1d29aL, 0xead54739L, 0x9dd277afL, 0x04db2615L,
-	0x73dc1683L, 0xe3630b12L, 0x94643b84L, 0x0d6d6a3eL, 0x7a6a5aa8L,
-	0xe40ecf0bL, 0x9309ff9dL, 0x0a00ae27L, 0x7d079eb1L, 0xf00f9344L,
-	0x8708a3d2L, 0x1e01f268L, 0x6906c2feL, 0xf762575dL, 0x806567cbL,
-	0x196c3671L, 0x6e6b06e7L, 0xfed41b76L, 0x89d32be0L, 0x10da7a5aL,
-	0x67dd4accL, 0xf9b9df6fL, 0x8ebeeff9L, 0x17b7be43L, 0x60b08ed5L,
-	0xd6d6a3e8L, 0xa1d1937eL, 0x38d8c2c4L, 0x4fdff252L, 0xd1bb67f1L,
-	0xa6bc5767L, 0x3fb506ddL, 0x48b2364bL, 0xd80d2bdaL, 0xaf0a1b4c,
-	0x36034af6L, 0x41047a60L, 0xdf60efc3L, 0xa867df55L, 0x316e8eefL,
-	0x4669be79L, 0xcb61b38cL, 0xbc66831aL, 0x256fd2a0L, 0x5268e236L,
-	0xcc0c7795L, 0xbb0b4703L, 0x220216b9L, 0x5505262fL, 0xc5ba3bbeL,
-	0xb2bd0b28L, 0x2bb45a92L, 0x5cb36a04L, 0xc2d7ffa7L, 0xb5d0cf31L,
-	0x2cd99e8bL, 0x5bdeae1dL, 0x9b64c2b0L, 0xec63f226L, 0x756aa39cL,
-	0x026d930aL, 0x9c0906a9L, 0xeb0e363fL, 0x72076785L, 0x05005713L,
-	0x95bf4a82L, 0xe2b87a14L, 0x7bb12baeL, 0x0cb61b38L, 0x92d28e9bL,
-	0xe5d5be0dL, 0x7cdcefb7L, 0x0bdbdf21L, 0x86d3d2d4L, 0xf1d4e242L,
-	0x68ddb3f8L, 0x1fda836eL, 0x81be16cdL, 0xf6b9265bL, 0x6fb077e1L,
-	0x18b74777L, 0x88085ae6L, 0xff0f6a70L, 0x66063bcaL, 0x11010b5cL,
-	0x8f659effL, 0xf862ae69L, 0x616bffd3L, 0x166ccf45L, 0xa00ae278L,
-	0xd70dd2eeL, 0x4e048354L, 0x3903b3c2L, 0xa7672661L, 0xd06016f7L,
-	0x4969474dL, 0x3e6e77dbL, 0xaed16a4aL, 0xd9d65adcL, 0x40df0b66L,
-	0x37d83bf0L, 0xa9bcae53L, 0xdebb9ec5L, 0x47b2cf7fL, 0x30b5ffe9L,
-	0xbdbdf21cL, 0xcabac28aL, 0x53b39330L, 0x24b4a3a6L, 0xbad03605L,
-	0xcdd70693L, 0x54de5729L, 0x23d967bfL, 0xb3667a2eL, 0xc4614ab8L,
-	0x5d681b02L, 0x2a6f2b94L, 0xb40bbe37L, 0xc30c8ea1L, 0x5a05df1bL,
-	0x2d02ef8dL
-};
-
-// --- CRC32 Table ---
-uint32_t calculate_crc32(const uint8_t *data, size_t length) {
-    uint32_t crc = 0xffffffff;
-    for (size_t i = 0; i < length; i++) {
-        crc = crc32_table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
-    }
-    return crc ^ 0xffffffff;
+static MediaApplication* g_media_app_instance = nullptr;
+
+static void core1_entry() {
+    g_media_app_instance->core1_main();
+}
+
+// Schedules process_events() on the BTstack run loop (core0). Safe to call
+// from interrupts and from core1.
+static void wake_run_loop(void* context) {
+    (void)context;
+    btstack_run_loop_poll_data_sources_from_irq();
 }
 
 // --- Class Implementation ---
@@ -81,24 +33,44 @@ MediaApplication::MediaApplication() :
     m_encoder(ENCODER_PIN_A, ENCODER_PIN_B, ENCODER_PIN_KEY),
     m_display(pio1, DISPLAY_PIN_SDA, DISPLAY_PIN_SCL, DISPLAY_PIN_CS, DISPLAY_PIN_DC, DISPLAY_PIN_RESET, DisplayOrientation::LANDSCAPE),
     m_drawing(m_display),
+    m_band_renderer(m_drawing),
     m_tcp_server(this),
     m_battery_level(100),
     m_button_state(ButtonState::IDLE),
     m_button_armed_time_us(0)
 {
-    critical_section_init(&m_tile_queue_crit_sec);
+    g_media_app_instance = this;
 }
 
 // --- The run() function ---
 void MediaApplication::setup() {
     // --- STAGE 1: HARDWARE INITIALIZATION ---
+    m_crc_copier.init();
+    m_session_id = get_rand_32();
+    if (CRC_BENCHMARK_AT_BOOT) {
+        crc32_benchmark(m_crc_copier);
+    }
+
     printf("Initializing Rotary Encoder...\n");
     m_encoder.init();
+    m_encoder.setEventCallback(&wake_run_loop, this);
 
     printf("Initializing Display...\n");
-    m_display.init();
-    m_display.fillScreen(0);
-
+    if (SHADOW_FRAMEBUFFER) {
+        // Before core1 starts, so both cores agree on the drawing mode.
+        if (m_framebuffer.init(m_display.getWidth(), m_display.getHeight())) {
+            m_drawing.setFramebuffer(&m_framebuffer);
+        } else {
+            printf("WARN: Not enough memory for a %ux%u framebuffer. Drawing straight to the panel.\n",
+                   m_display.getWidth(), m_display.getHeight());
+        }
+    }
+    if (DISPLAY_ON_CORE1) {
+        // The display (and its DMA interrupt) must be set up on the core that uses it.
+        multicore_launch_core1(core1_entry);
+    } else {
+        init_display();
+    }
 
     // Check Flash for Credentials
     WifiCredentials creds;
@@ -123,47 +95,724 @@ void MediaApplication::setup() {
     btstack_run_loop_set_timer(&m_battery_timer, 30000);
     btstack_run_loop_add_timer(&m_battery_timer);
 
+    // Encoder, TCP receive and the display wake this source so their work is
+    // handled on the next run loop pass instead of the next poll tick.
+    btstack_run_loop_set_data_source_handler(&m_wakeup_source, &MediaApplication::wakeup_handler_forwarder);
+    btstack_run_loop_enable_data_source_callbacks(&m_wakeup_source, DATA_SOURCE_CALLBACK_POLL);
+    btstack_run_loop_add_data_source(&m_wakeup_source);
+
     // Set up the main polling timer, which will be the application's heartbeat
     m_poll_timer.context = this;
     btstack_run_loop_set_timer_handler(&m_poll_timer, &MediaApplication::poll_handler_forwarder);
-    btstack_run_loop_set_timer(&m_poll_timer, 10); // Start the first poll in 10ms
+    btstack_run_loop_set_timer(&m_poll_timer, POLL_INTERVAL_MS); // Start the first poll in 10ms
     btstack_run_loop_add_timer(&m_poll_timer);
 
     // --- STAGE 3: WI-FI CONNECTION (Blocking call, safe to do here) ---
     cyw43_arch_enable_sta_mode();
-    m_drawing.drawString(10, 10, "Connecting to Wi-Fi...", 0xFFFF, &font_freesans_16);
+    show_status("Connecting to Wi-Fi...", 0xFFFF);
     printf("Connecting to Wi-Fi network: %s\n", target_ssid);
 
     if (cyw43_arch_wifi_connect_timeout_ms(target_ssid, target_pass, CYW43_AUTH_WPA2_AES_PSK, 30000)) {
         printf("Failed to connect to Wi-Fi.\n");
-        m_drawing.fillRect(0, 10, 320, 20, 0);
-        m_drawing.drawString(10, 10, "Wi-Fi connection failed. Use BLE to configure.", 0xF800, &font_freesans_16);
+        show_status("Wi-Fi connection failed. Use BLE to configure.", 0xF800);
     } else {
         printf("Connected to Wi-Fi. IP: %s\n", ip4addr_ntoa(netif_ip4_addr(&cyw43_state.netif[0])));
         cyw43_wifi_pm(&cyw43_state, CYW43_PERFORMANCE_PM);
         m_tcp_server.init(4242);
-        m_drawing.fillRect(0, 10, 320, 20, 0);
-        m_drawing.drawString(10, 10, "Waiting for host...", 0x07E0, &font_freesans_16);
+        show_status("Waiting for host...", 0x07E0);
+    }
+}
+
+// Called from the lwIP receive callback on core0. This is the only producer
+// for the tile queue. Tiles are queued strictly in sequence order. The payload
+// is copied from the pbuf chain straight into its queue slot and checked there.
+// Returns true if the tile was queued; its bytes are returned to the TCP
+// window when the display side releases the slot.
+bool MediaApplication::on_tile_frame(const Protocol::FrameHeader& frame_header, const struct pbuf* p, uint16_t offset) {
+    // Stream chunks carry a short header; everything else an ImageTileHeader.
+    // Both hold the CRC of the bytes that follow and the sequence number.
+    uint8_t header_bytes[sizeof(Protocol::ImageTileHeader)];
+    size_t header_size;
+    uint32_t seq, crc32;
+    if (frame_header.type == Protocol::FrameType::IMAGE_STREAM_DATA) {
+        Protocol::StreamChunkHeader chunk_header;
+        header_size = sizeof(chunk_header);
+        if (frame_header.payload_length < header_size) return false;
+        pbuf_copy_partial(p, header_bytes, header_size, offset);
+        memcpy(&chunk_header, header_bytes, header_size);
+        seq = chunk_header.seq;
+        crc32 = chunk_header.crc32;
+    } else {
+        Protocol::ImageTileHeader tile_header;
+        header_size = sizeof(tile_header);
+        if (frame_header.payload_length < header_size) return false;
+        pbuf_copy_partial(p, header_bytes, header_size, offset);
+        memcpy(&tile_header, header_bytes, header_size);
+        seq = tile_header.seq;
+        crc32 = tile_header.crc32;
+    }
+    if (seq != m_next_tile_seq) {
+        // A resend of a tile we already have, or a tile that followed a NACKed
+        // one. The host resends everything from the NACKed tile onwards.
+        m_stats.tiles_dropped++;
+        return false;
+    }
+
+    Protocol::Frame* tile_slot = m_tile_queue.reserve(frame_header.payload_length);
+    if (!tile_slot) {
+        printf("WARN: Tile queue is full. Dropping tile %lu.\n", (unsigned long)seq);
+        m_stats.tiles_dropped++;
+        send_tile_nack(seq);
+        return false;
+    }
+    // The header is not covered by the CRC; everything after it is checked by
+    // the copier on its way into the slot.
+    memcpy(tile_slot->payload(), header_bytes, header_size);
+    size_t data_len = frame_header.payload_length - header_size;
+    uint32_t calc_crc = copy_from_chain(tile_slot->payload() + header_size, p, offset + header_size, data_len);
+    if (calc_crc != crc32) {
+        printf("CRC Mismatch! Exp: %08X, Calc: %08X. Len: %d\n", crc32, calc_crc, data_len);
+        m_stats.crc_failures++;
+        send_tile_nack(seq);
+        return false;
+    }
+
+    tile_slot->header = frame_header;
+    tile_slot->seq = seq;
+    tile_slot->received_us = time_us_32();
+    tile_slot->connection = m_connection.load(std::memory_order_relaxed);
+    tile_slot->timed = m_timestamp_pending && m_pending_timestamp.seq == seq;
+    if (tile_slot->timed) {
+        tile_slot->host_time = m_pending_timestamp.host_time;
+        m_timestamp_pending = false;
+    }
+    m_tile_queue.commit();
+    m_tile_bytes_queued += sizeof(Protocol::FrameHeader) + frame_header.payload_length;
+    m_next_tile_seq++;
+    if (!m_update_open) {
+        m_update_open = true;
+        m_update_local_draws = m_local_draws.load(std::memory_order_acquire);
+    }
+    m_stats.tiles_received++;
+    m_stats.queue_high_water = std::max<uint8_t>(m_stats.queue_high_water, std::min<size_t>(m_tile_queue.size(), UINT8_MAX));
+    if (!DISPLAY_ON_CORE1) {
+        wake_run_loop(this);
+    }
+    return true;
+}
+
+// Copies 'len' bytes starting 'skip' bytes into the pbuf chain to 'dst' and
+// returns their CRC-32.
+uint32_t MediaApplication::copy_from_chain(uint8_t* dst, const struct pbuf* p, size_t skip, size_t len) {
+    m_crc_copier.begin();
+    for (const struct pbuf* q = p; q && len > 0; q = q->next) {
+        if (skip >= q->len) {
+            skip -= q->len;
+            continue;
+        }
+        size_t chunk = std::min<size_t>(q->len - skip, len);
+        m_crc_copier.copy(dst, static_cast<const uint8_t*>(q->payload) + skip, chunk);
+        dst += chunk;
+        len -= chunk;
+        skip = 0;
+    }
+    return m_crc_copier.end();
+}
+
+// THROUGHPUT_TEST in sink mode (lwIP context, core0). With THROUGHPUT_FLAG_CRC
+// the filler goes through the same copy and check as a tile, into tile queue
+// space that is reserved but never committed, so the reply isolates the cost of the
+// tile receive path from the network and the panel.
+void MediaApplication::on_throughput_sink(const Protocol::FrameHeader& frame_header, const Protocol::ThroughputTest& test,
+                                          const struct pbuf* p, uint16_t offset) {
+    Protocol::ThroughputReply reply = {};
+    reply.id = test.id;
+    reply.bytes = frame_header.payload_length - sizeof(test);
+    if (test.flags & Protocol::THROUGHPUT_FLAG_CRC) {
+        Protocol::Frame* scratch = m_tile_queue.reserve(reply.bytes);
+        if (scratch) {
+            uint32_t start_us = time_us_32();
+            reply.crc32 = copy_from_chain(scratch->payload(), p, offset + sizeof(test), reply.bytes);
+            reply.crc_us = time_us_32() - start_us;
+        } else {
+            reply.crc_us = UINT32_MAX; // No free queue space to copy into
+        }
+    }
+    m_tcp_server.send_frame(Protocol::FrameType::THROUGHPUT_TEST, reinterpret_cast<const uint8_t*>(&reply), sizeof(reply));
+}
+
+// Remembers the host time for the tile that follows. Only the latest one is
+// kept; the host sends it immediately before its tile.
+void MediaApplication::on_tile_timestamp(const Protocol::TileTimestamp& timestamp) {
+    m_pending_timestamp = timestamp;
+    m_timestamp_pending = true;
+}
+
+// The tiles queued since the last commit make up image 'epoch'. They are
+// drawn even if the connection drops, so the panel will show it.
+void MediaApplication::on_epoch_commit(const Protocol::EpochCommit& commit) {
+    if (commit.flags & Protocol::EPOCH_FULL_FRAME) {
+        // Anything drawn locally after the update began may not be covered.
+        m_epoch_valid = true;
+        m_epoch_local_draws = m_update_open ? m_update_local_draws : m_local_draws.load(std::memory_order_acquire);
+    }
+    m_content_epoch = commit.epoch;
+    m_update_open = false;
+}
+
+void MediaApplication::on_stats_request() {
+    Protocol::DeviceStats stats;
+    fill_stats(stats);
+    m_tcp_server.send_frame(Protocol::FrameType::STATS, reinterpret_cast<const uint8_t*>(&stats), sizeof(stats));
+}
+
+// Merges the core0 counters with the display side's and lwIP's (core0).
+void MediaApplication::fill_stats(Protocol::DeviceStats& stats) {
+    stats = m_stats;
+    stats.uptime_ms = to_ms_since_boot(get_absolute_time());
+    stats.bytes_received = m_tcp_server.bytes_received();
+    stats.tiles_drawn = m_tiles_released.load(std::memory_order_acquire);
+    stats.draw_us_max = m_draw_us_max.load(std::memory_order_relaxed);
+#if MEM_STATS
+    stats.lwip_mem_used = lwip_stats.mem.used;
+    stats.lwip_mem_max = lwip_stats.mem.max;
+#endif
+#if MEMP_STATS
+    stats.pbuf_pool_used = lwip_stats.memp[MEMP_PBUF_POOL]->used;
+    stats.pbuf_pool_max = lwip_stats.memp[MEMP_PBUF_POOL]->max;
+#endif
+    stats.queue_depth = TILE_QUEUE_DEPTH;
+    stats.queue_used = std::min<size_t>(m_tile_queue.size(), UINT8_MAX);
+}
+
+// A new host starts counting from zero. Queued tiles from the previous
+// connection are still drawn; the first ACK tells the host how much queue space is free.
+// Their bytes were never part of this connection's receive window, so none of
+// them are returned to it.
+void MediaApplication::on_client_connected() {
+    m_tile_bytes_returned = m_tile_bytes_queued;
+    m_next_tile_seq = 0;
+    m_timestamp_pending = false;
+    m_ack_pending = true;
+    wake_run_loop(this);
+}
+
+// Tiles already queued are still drawn, but a stream the client left open
+// will get no more chunks. The display side closes it once it has drawn
+// everything the client sent.
+void MediaApplication::on_client_disconnected() {
+    m_connection.store(m_connection.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    wake_run_loop(this);
+}
+
+// Tells the host what this firmware supports, so it can pick its encodings
+// and tile sizes instead of relying on constants compiled into both sides.
+void MediaApplication::on_hello(const Protocol::Hello& hello) {
+    printf("Host HELLO, protocol version %u\n", hello.protocol_version);
+    Protocol::Capabilities caps = {};
+    caps.protocol_version = Protocol::PROTOCOL_VERSION;
+    caps.pixel_formats = Protocol::PIXEL_FORMAT_RGB565_LE;
+    caps.codecs = Protocol::CODEC_RLE | Protocol::CODEC_PALETTE | Protocol::CODEC_STREAM | Protocol::CODEC_BATCH;
+    caps.panel_width = m_display.getWidth();
+    caps.panel_height = m_display.getHeight();
+    caps.max_payload = Protocol::MAX_PAYLOAD_SIZE;
+    caps.max_tile_pixels = MAX_DRAW_BUFFER_PIXELS;
+    caps.queue_depth = TILE_QUEUE_DEPTH;
+    caps.features = Protocol::FEATURE_STATS | Protocol::FEATURE_DRAW_TIMING | Protocol::FEATURE_SESSION;
+    if (m_framebuffer.isValid()) {
+        caps.features |= Protocol::FEATURE_RETAINED;
+    }
+    // Full-width tiles need one window per tile and keep each row contiguous.
+    caps.preferred_tile_width = m_display.getWidth();
+    caps.preferred_tile_height = MAX_DRAW_BUFFER_PIXELS / m_display.getWidth();
+    m_tcp_server.send_frame(Protocol::FrameType::CAPS, reinterpret_cast<const uint8_t*>(&caps), sizeof(caps));
+
+    Protocol::SessionInfo session = {};
+    session.session_id = m_session_id;
+    session.epoch = m_content_epoch;
+    if (m_epoch_valid && !m_update_open && m_local_draws.load(std::memory_order_acquire) == m_epoch_local_draws) {
+        session.flags |= Protocol::SESSION_EPOCH_VALID;
+    }
+    m_tcp_server.send_frame(Protocol::FrameType::SESSION, reinterpret_cast<const uint8_t*>(&session), sizeof(session));
+}
+
+void MediaApplication::send_tile_nack(uint32_t seq) {
+    Protocol::TileNack nack;
+    nack.seq = seq;
+    m_tcp_server.send_frame(Protocol::FrameType::TILE_NACK, reinterpret_cast<const uint8_t*>(&nack), sizeof(nack));
+}
+
+// --- Display side ---
+void MediaApplication::init_display() {
+    m_display.init();
+    if (!DISPLAY_ON_CORE1) {
+        // Start the next queued tile as soon as the DMA is done with this one.
+        m_display.setTransferCompleteCallback(&wake_run_loop, this);
+    }
+    m_display.setPixelTransferMode(PixelTransferMode::FRAMED);
+    m_display.fillScreen(0);
+    if (TEXT_BENCHMARK_AT_BOOT) {
+        text_benchmark(m_display, m_drawing, &font_freesans_16);
+    }
+}
+
+void MediaApplication::core1_main() {
+    // Lets core0 pause this core while it writes flash (Wi-Fi config, BTstack bonds).
+    multicore_lockout_victim_init();
+    init_display();
+    while (true) {
+        update_display();
+        tight_loop_contents();
+    }
+}
+
+// Runs the display pipeline until there is nothing left to do or budget_us has
+// been spent. Used on core0, where the time comes out of the BTstack run loop.
+// Returns true if work is still pending.
+bool MediaApplication::run_display(uint32_t budget_us) {
+    absolute_time_t deadline = make_timeout_time_us(budget_us);
+    bool pending;
+    do {
+        pending = update_display();
+    } while (pending && !time_reached(deadline));
+    return pending;
+}
+
+// Posts a one-line status message. The display side picks it up on its next update.
+void MediaApplication::show_status(const char* text, uint16_t color) {
+    m_status_text.store(text, std::memory_order_relaxed);
+    m_status_color.store(color, std::memory_order_relaxed);
+    m_status_seq.store(m_status_seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    if (!DISPLAY_ON_CORE1) {
+        update_display();
+    }
+}
+
+// One step of the display pipeline: status line first, then the next tile.
+// Returns true while a tile is being drawn or waiting in the queue.
+bool MediaApplication::update_display() {
+    uint32_t status_seq = m_status_seq.load(std::memory_order_acquire);
+    // An open stream owns the panel window; the status line waits for it.
+    if (status_seq != m_status_drawn_seq && !m_stream_open) {
+        m_status_drawn_seq = status_seq;
+        m_local_draws.store(m_local_draws.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        // Composited in bands so the old text is never cleared on screen first.
+        m_band_renderer.clear();
+        m_band_renderer.fillRect(0, 10, 320, 20, 0);
+        m_band_renderer.drawString(10, 10, m_status_text.load(std::memory_order_relaxed),
+                                   m_status_color.load(std::memory_order_relaxed), &font_freesans_16);
+        if (!m_band_renderer.render(0, 10, 320, 20)) {
+            printf("WARN: Status line was not drawn.\n");
+        }
+    }
+
+    if (m_drawing.processDrawing() != Drawing::DrawStatus::IDLE) return true;
+
+    if (m_tile_leased) {
+        // Stream chunks are read by writePixels rather than a Drawing call.
+        if (m_stream_open && m_drawing.isWriting()) return true;
+        if (m_batch_rect < m_batch_rect_count) {
+            draw_next_batch_rect(m_tile_queue.front());
+            return true;
+        }
+        // The DMA has finished reading the slot; hand it back to core0.
+        release_tile();
+    }
+    if (m_stream_open && m_stream_remaining == 0) {
+        close_stream();
+    }
+
+    Protocol::Frame* tile = m_tile_queue.front();
+    if (m_stream_open) {
+        // The client that opened the stream has disconnected: nothing left
+        // from it, or the next frame is already from a new connection.
+        uint8_t connection = tile ? tile->connection : m_connection.load(std::memory_order_acquire);
+        if (connection != m_stream_connection) {
+            close_stream();
+        }
+    }
+    // Retained mode: the panel catches up once the queue has drained, or
+    // after FRAMEBUFFER_FLUSH_DELAY_US while tiles keep coming.
+    if (m_framebuffer.isDirty() &&
+        (!tile || time_us_32() - m_framebuffer.dirtySinceUs() >= FRAMEBUFFER_FLUSH_DELAY_US)) {
+        m_drawing.flush();
+        return true;
+    }
+    if (!tile) return false;
+    m_tile_start_us = time_us_32();
+
+    if (tile->header.type == Protocol::FrameType::IMAGE_STREAM_DATA) {
+        if (!m_stream_open) {
+            printf("WARN: Stream data without an open window. Dropping chunk.\n");
+            release_tile();
+            return true;
+        }
+        write_stream_pixels(tile, sizeof(Protocol::StreamChunkHeader));
+        return true;
+    }
+    if (m_stream_open) {
+        // The host gave up on the stream (e.g. it reconnected).
+        close_stream();
+    }
+
+    const uint8_t* payload = tile->payload();
+    Protocol::ImageTileHeader tile_header;
+    memcpy(&tile_header, payload, sizeof(Protocol::ImageTileHeader));
+
+    if (tile->header.type == Protocol::FrameType::IMAGE_STREAM_BEGIN) {
+        begin_stream(tile_header, tile);
+        return true;
+    }
+
+    if (tile->header.type == Protocol::FrameType::IMAGE_BATCH) {
+        begin_batch(tile);
+        return true;
+    }
+
+    if (tile->header.type == Protocol::FrameType::COPY_RECT ||
+        tile->header.type == Protocol::FrameType::SCROLL_RECT ||
+        tile->header.type == Protocol::FrameType::REDRAW_REGION) {
+        apply_retained_op(tile_header, tile);
+        release_tile();
+        return true;
+    }
+
+    if (tile->header.type == Protocol::FrameType::IMAGE_TILE_RLE) {
+        // Decoded straight to the panel; the slot is free again once this returns.
+        const uint8_t* data = payload + sizeof(Protocol::ImageTileHeader);
+        size_t length = tile->header.payload_length - sizeof(Protocol::ImageTileHeader);
+        uint32_t start_us = time_us_32();
+        if (!m_drawing.drawRleImage(tile_header.x, tile_header.y, tile_header.width, tile_header.height, data, length)) {
+            printf("WARN: Malformed RLE tile at (%u,%u).\n", tile_header.x, tile_header.y);
+        }
+        uint32_t elapsed_us = time_us_32() - start_us;
+        m_rle_pixels.store(m_rle_pixels.load(std::memory_order_relaxed) + (uint32_t)tile_header.width * tile_header.height, std::memory_order_relaxed);
+        m_rle_decode_us.store(m_rle_decode_us.load(std::memory_order_relaxed) + elapsed_us, std::memory_order_release);
+        m_rows_drawn.store(m_rows_drawn.load(std::memory_order_relaxed) + tile_header.height, std::memory_order_release);
+        release_tile();
+        return true;
+    }
+
+    if (tile->header.type == Protocol::FrameType::IMAGE_TILE_PALETTE) {
+        const uint8_t* data = payload + sizeof(Protocol::ImageTileHeader);
+        size_t length = tile->header.payload_length - sizeof(Protocol::ImageTileHeader);
+        Protocol::PaletteTileHeader palette_header;
+        size_t palette_count = 0;
+        bool ok = length >= sizeof(palette_header);
+        if (ok) {
+            memcpy(&palette_header, data, sizeof(palette_header));
+            palette_count = (size_t)palette_header.palette_size + 1;
+            ok = length >= sizeof(palette_header) + palette_count * sizeof(uint16_t);
+        }
+        if (ok) {
+            // The palette starts 18 bytes into the word-aligned payload, so it is halfword aligned.
+            const uint16_t* palette = reinterpret_cast<const uint16_t*>(data + sizeof(palette_header));
+            const uint8_t* indices = data + sizeof(palette_header) + palette_count * sizeof(uint16_t);
+            size_t index_bytes = length - sizeof(palette_header) - palette_count * sizeof(uint16_t);
+            ok = m_drawing.drawPaletteImage(tile_header.x, tile_header.y, tile_header.width, tile_header.height,
+                                            palette_header.bits_per_pixel, palette, palette_count, indices, index_bytes);
+        }
+        if (ok) {
+            m_rows_drawn.store(m_rows_drawn.load(std::memory_order_relaxed) + tile_header.height, std::memory_order_release);
+        } else {
+            printf("WARN: Malformed palette tile at (%u,%u). Dropping tile.\n", tile_header.x, tile_header.y);
+        }
+        release_tile();
+        return true;
+    }
+
+    if (tile_header.width == 0 || tile_header.height == 0 ||
+        tile_header.x + tile_header.width > m_display.getWidth() ||
+        tile_header.y + tile_header.height > m_display.getHeight()) {
+        printf("WARN: Tile %ux%u at (%u,%u) is off screen. Dropping tile.\n",
+               tile_header.width, tile_header.height, tile_header.x, tile_header.y);
+        release_tile();
+        return true;
     }
+    size_t pixel_bytes = (size_t)tile_header.width * tile_header.height * sizeof(uint16_t);
+    if (sizeof(Protocol::ImageTileHeader) + pixel_bytes > tile->header.payload_length) {
+        printf("WARN: Tile %ux%u larger than its payload. Dropping tile.\n", tile_header.width, tile_header.height);
+        release_tile();
+        return true;
+    }
+
+    // The payload is word aligned (see FrameRing.h) and the pixels start 16
+    // bytes in, so the DMA can read them in place.
+    static_assert(sizeof(Protocol::ImageTileHeader) % 4 == 0, "tile pixels must stay word aligned");
+    const uint16_t* pixel_data = reinterpret_cast<const uint16_t*>(payload + sizeof(Protocol::ImageTileHeader));
+    m_tile_leased = true;
+    if (!m_drawing.drawImageAsync(tile_header.x, tile_header.y, tile_header.width, tile_header.height, pixel_data)) {
+        release_tile();
+        return true;
+    }
+    m_rows_drawn.store(m_rows_drawn.load(std::memory_order_relaxed) + tile_header.height, std::memory_order_release);
+    return true;
 }
 
-void MediaApplication::on_valid_tile_received(const Protocol::FrameHeader& frame_header, const uint8_t* payload) {
-    // This is called from the ISR. It must be fast. It just queues the data.
-    critical_section_enter_blocking(&m_tile_queue_crit_sec);
-    uint8_t next_head = (m_queue_head + 1) % TILE_QUEUE_SIZE;
-    if (next_head == m_queue_tail) {
-        printf("WARN: Tile queue is full. Dropping tile.\n");
+// Opens the panel window for a streamed tile and writes the pixels that came
+// with it. Later chunks are written as they are dequeued.
+void MediaApplication::begin_stream(const Protocol::ImageTileHeader& tile_header, Protocol::Frame* tile) {
+    if (tile_header.width == 0 || tile_header.height == 0 ||
+        tile_header.x + tile_header.width > m_display.getWidth() ||
+        tile_header.y + tile_header.height > m_display.getHeight()) {
+        printf("WARN: Stream window %ux%u at (%u,%u) is off screen. Dropping.\n",
+               tile_header.width, tile_header.height, tile_header.x, tile_header.y);
+        release_tile();
+        return;
+    }
+    m_drawing.beginWrite(tile_header.x, tile_header.y, tile_header.width, tile_header.height);
+    m_stream_open = true;
+    m_stream_remaining = (uint32_t)tile_header.width * tile_header.height;
+    m_stream_connection = tile->connection;
+    m_rows_drawn.store(m_rows_drawn.load(std::memory_order_relaxed) + tile_header.height, std::memory_order_release);
+    write_stream_pixels(tile, sizeof(Protocol::ImageTileHeader));
+}
+
+// Sends the pixels in a stream slot to the panel. The slot stays leased until
+// the DMA has read it; bytes beyond the window are ignored.
+void MediaApplication::write_stream_pixels(Protocol::Frame* tile, size_t header_size) {
+    size_t bytes = tile->header.payload_length - header_size;
+    uint32_t count = std::min<uint32_t>(bytes / sizeof(uint16_t), m_stream_remaining);
+    if (count == 0) {
+        release_tile();
+        return;
+    }
+    m_tile_leased = true;
+    m_drawing.writePixels(reinterpret_cast<const uint16_t*>(tile->payload() + header_size), count);
+    m_stream_remaining -= count;
+}
+
+// Ends the stream window. If it was abandoned early, the rest is written
+// black so the panel and the PIO program both see the pixel count they expect.
+void MediaApplication::close_stream() {
+    static const uint16_t padding[64] = {};
+    if (m_stream_remaining > 0) {
+        printf("WARN: Stream closed with %lu pixels missing.\n", (unsigned long)m_stream_remaining);
+    }
+    while (m_stream_remaining > 0) {
+        uint32_t count = std::min<uint32_t>(m_stream_remaining, 64);
+        m_drawing.writePixels(padding, count);
+        m_stream_remaining -= count;
+    }
+    m_drawing.endWrite();
+    m_stream_open = false;
+}
+
+// Checks every rectangle of a batch before drawing the first one, so a bad
+// batch is dropped as a whole. The slot stays leased until the last
+// rectangle has been drawn.
+void MediaApplication::begin_batch(Protocol::Frame* tile) {
+    const uint8_t* data = tile->payload() + sizeof(Protocol::ImageTileHeader);
+    size_t length = tile->header.payload_length - sizeof(Protocol::ImageTileHeader);
+    Protocol::BatchHeader batch_header;
+    bool ok = length >= sizeof(batch_header);
+    size_t pixel_offset = 0;
+    if (ok) {
+        memcpy(&batch_header, data, sizeof(batch_header));
+        pixel_offset = sizeof(batch_header) + (size_t)batch_header.rect_count * sizeof(Protocol::BatchRect);
+        ok = pixel_offset <= length;
+    }
+    size_t pixel_end = pixel_offset;
+    for (uint16_t i = 0; ok && i < batch_header.rect_count; i++) {
+        Protocol::BatchRect rect;
+        memcpy(&rect, data + sizeof(batch_header) + i * sizeof(rect), sizeof(rect));
+        size_t pixel_count = (size_t)rect.width * rect.height;
+        ok = rect.width > 0 && rect.height > 0 && pixel_count <= MAX_DRAW_BUFFER_PIXELS &&
+             rect.x + rect.width <= m_display.getWidth() && rect.y + rect.height <= m_display.getHeight();
+        pixel_end += pixel_count * sizeof(uint16_t);
+    }
+    if (!ok || pixel_end > length) {
+        printf("WARN: Malformed batch tile. Dropping tile.\n");
+        release_tile();
+        return;
+    }
+
+    m_batch_rect = 0;
+    m_batch_rect_count = batch_header.rect_count;
+    m_batch_pixel_offset = pixel_offset;
+    m_tile_leased = true;
+    if (m_batch_rect_count > 0) {
+        draw_next_batch_rect(tile);
+    }
+}
+
+// Starts the next rectangle of the leased batch; its pixels are read in place.
+void MediaApplication::draw_next_batch_rect(Protocol::Frame* tile) {
+    const uint8_t* data = tile->payload() + sizeof(Protocol::ImageTileHeader);
+    Protocol::BatchRect rect;
+    memcpy(&rect, data + sizeof(Protocol::BatchHeader) + m_batch_rect * sizeof(rect), sizeof(rect));
+    const uint16_t* pixels = reinterpret_cast<const uint16_t*>(data + m_batch_pixel_offset);
+    m_batch_rect++;
+    m_batch_pixel_offset += (size_t)rect.width * rect.height * sizeof(uint16_t);
+    if (m_drawing.drawImageAsync(rect.x, rect.y, rect.width, rect.height, pixels)) {
+        m_rows_drawn.store(m_rows_drawn.load(std::memory_order_relaxed) + rect.height, std::memory_order_release);
+    }
+}
+
+// COPY_RECT / SCROLL_RECT / REDRAW_REGION work on the framebuffer; without
+// one there is nothing to copy from, and the host should not have sent them.
+void MediaApplication::apply_retained_op(const Protocol::ImageTileHeader& tile_header, const Protocol::Frame* tile) {
+    if (!m_framebuffer.isValid()) {
+        printf("WARN: Retained-mode frame without a framebuffer. Dropping.\n");
+        return;
+    }
+    const uint8_t* data = tile->payload() + sizeof(Protocol::ImageTileHeader);
+    size_t length = tile->header.payload_length - sizeof(Protocol::ImageTileHeader);
+    bool ok = true;
+    if (tile->header.type == Protocol::FrameType::COPY_RECT) {
+        Protocol::CopyRect copy;
+        ok = length >= sizeof(copy);
+        if (ok) {
+            memcpy(&copy, data, sizeof(copy));
+            m_framebuffer.copy(tile_header.x, tile_header.y, tile_header.width, tile_header.height, copy.dst_x, copy.dst_y);
+        }
+    } else if (tile->header.type == Protocol::FrameType::SCROLL_RECT) {
+        Protocol::ScrollRect scroll;
+        ok = length >= sizeof(scroll);
+        if (ok) {
+            memcpy(&scroll, data, sizeof(scroll));
+            m_framebuffer.scroll(tile_header.x, tile_header.y, tile_header.width, tile_header.height,
+                                 scroll.dx, scroll.dy, scroll.fill_color);
+        }
     } else {
-        Protocol::Frame& tile_slot = m_tile_queue[m_queue_head];
-        tile_slot.header = frame_header;
-        memcpy(tile_slot.payload.data(), payload, frame_header.payload_length);
-        m_queue_head = next_head;
+        m_framebuffer.markDirty(tile_header.x, tile_header.y, tile_header.width, tile_header.height);
     }
-    critical_section_exit(&m_tile_queue_crit_sec);
+    if (!ok) {
+        printf("WARN: Malformed retained-mode frame. Dropping.\n");
+    }
+}
+
+// Hands the front slot back to core0, which returns it to the host as a credit.
+void MediaApplication::release_tile() {
+    m_tile_leased = false;
+    uint32_t draw_us = time_us_32() - m_tile_start_us;
+    m_draw_us_total.store(m_draw_us_total.load(std::memory_order_relaxed) + draw_us, std::memory_order_relaxed);
+    if (draw_us > m_draw_us_max.load(std::memory_order_relaxed)) {
+        m_draw_us_max.store(draw_us, std::memory_order_relaxed);
+    }
+    Protocol::Frame* tile = m_tile_queue.front();
+    if (tile->timed) {
+        // Dropped if core0 has fallen that far behind; the host times out.
+        Protocol::DrawComplete* done = m_draw_completions.reserve();
+        if (done) {
+            done->seq = tile->seq;
+            done->host_time = tile->host_time;
+            done->received_us = tile->received_us;
+            done->dequeued_us = m_tile_start_us;
+            done->completed_us = m_tile_start_us + draw_us;
+            m_draw_completions.commit();
+        }
+    }
+    uint32_t frame_bytes = sizeof(Protocol::FrameHeader) + tile->header.payload_length;
+    m_tile_queue.pop();
+    m_tile_bytes_released.store(m_tile_bytes_released.load(std::memory_order_relaxed) + frame_bytes, std::memory_order_relaxed);
+    m_tiles_released.store(m_tiles_released.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    if (DISPLAY_ON_CORE1) {
+        wake_run_loop(this);
+    }
+}
+
+// Sends one cumulative ACK for all slots freed since the last one, so a burst
+// of small tiles costs a single frame.
+void MediaApplication::send_pending_acks() {
+    uint32_t released = m_tiles_released.load(std::memory_order_acquire);
+    if (released != m_tiles_acked) {
+        m_tiles_acked = released;
+        m_ack_pending = true;
+
+        // The drawn tiles' bytes can come back into the TCP receive window.
+        // The queue is drained in order, so while the count is still short of
+        // m_tile_bytes_returned the tiles being released are a previous
+        // connection's.
+        uint32_t bytes = m_tile_bytes_released.load(std::memory_order_relaxed);
+        if ((int32_t)(bytes - m_tile_bytes_returned) > 0) {
+            m_tcp_server.release_rx_window(bytes - m_tile_bytes_returned);
+            m_tile_bytes_returned = bytes;
+        }
+    }
+    if (!m_ack_pending) return;
+
+    Protocol::TileAck ack;
+    ack.next_seq = m_next_tile_seq;
+    ack.credit_bytes = m_tile_queue.guaranteed_space();
+    ack.credits = ack.credit_bytes / TileQueue::MAX_RECORD;
+    err_t err = m_tcp_server.send_frame(Protocol::FrameType::TILE_ACK, reinterpret_cast<const uint8_t*>(&ack), sizeof(ack));
+    // Out of send buffer: try again on the next pass.
+    if (err != ERR_MEM) {
+        m_ack_pending = false;
+    }
+}
+
+// Reports timed tiles that have finished drawing (core0).
+void MediaApplication::send_draw_completions() {
+    while (const Protocol::DrawComplete* done = m_draw_completions.front()) {
+        err_t err = m_tcp_server.send_frame(Protocol::FrameType::DRAW_COMPLETE, reinterpret_cast<const uint8_t*>(done), sizeof(*done));
+        // Out of send buffer: try again on the next pass.
+        if (err == ERR_MEM) return;
+        m_draw_completions.pop();
+    }
+}
+
+// Logs the achieved display throughput once per DRAW_STATS_INTERVAL_MS.
+void MediaApplication::update_draw_stats(uint32_t now_ms) {
+    uint32_t elapsed_ms = now_ms - m_stats_window_start_ms;
+    if (elapsed_ms < DRAW_STATS_INTERVAL_MS) return;
+
+    uint32_t rows = m_rows_drawn.load(std::memory_order_acquire);
+    m_rows_per_second = (rows - m_stats_window_rows) * 1000 / elapsed_ms;
+    m_stats_window_rows = rows;
+    m_stats_window_start_ms = now_ms;
+    if (m_rows_per_second > 0) {
+        printf("Display: %lu rows/s\n", (unsigned long)m_rows_per_second);
+    }
+
+    // RLE decode rate, including the time spent waiting on the panel.
+    uint32_t rle_us = m_rle_decode_us.load(std::memory_order_acquire);
+    uint32_t rle_pixels = m_rle_pixels.load(std::memory_order_relaxed);
+    if (rle_us != m_stats_window_rle_us) {
+        uint64_t pixels_per_second = (uint64_t)(rle_pixels - m_stats_window_rle_pixels) * 1000000 / (rle_us - m_stats_window_rle_us);
+        printf("Display: RLE decode %lu pixels/s\n", (unsigned long)pixels_per_second);
+        m_stats_window_rle_us = rle_us;
+        m_stats_window_rle_pixels = rle_pixels;
+    }
+
+    // Telemetry for this interval, then push it to a BLE subscriber.
+    uint32_t draws = m_tiles_released.load(std::memory_order_acquire);
+    uint32_t draw_us = m_draw_us_total.load(std::memory_order_relaxed);
+    m_stats.draw_us_avg = draws != m_stats_window_draws ? (draw_us - m_stats_window_draw_us) / (draws - m_stats_window_draws) : 0;
+    m_stats_window_draws = draws;
+    m_stats_window_draw_us = draw_us;
+    m_stats.poll_jitter_us = m_poll_jitter_window_us;
+    m_poll_jitter_window_us = 0;
+
+    Protocol::DeviceStats stats;
+    fill_stats(stats);
+    m_media_controller.updateStats(stats);
 }
 
-// --- poll_handler (The Consumer) ---
+// Event-driven work, run from the wakeup data source and the poll timer.
+void MediaApplication::process_events() {
+    handle_encoder();
+    if (!DISPLAY_ON_CORE1 && run_display(DRAW_BUDGET_US)) {
+        // Budget spent with tiles still pending: let BTstack and lwIP run,
+        // then come straight back.
+        wake_run_loop(this);
+    }
+    send_pending_acks();
+    send_draw_completions();
+}
+
+// --- Housekeeping: watchdog, TCP timeouts, Wi-Fi link ---
 void MediaApplication::poll_handler() {
+    // How late this tick is, measured from when the timer was armed.
+    if (m_poll_armed_us != 0) {
+        int32_t late_us = (int32_t)(time_us_32() - m_poll_armed_us) - (int32_t)(POLL_INTERVAL_MS * 1000);
+        if (late_us > 0) {
+            m_poll_jitter_window_us = std::max<uint32_t>(m_poll_jitter_window_us, late_us);
+            m_stats.poll_jitter_max_us = std::max<uint32_t>(m_stats.poll_jitter_max_us, late_us);
+        }
+    }
+
     watchdog_update();
     cyw43_arch_poll();
     
@@ -171,7 +820,6 @@ void MediaApplication::poll_handler() {
     if (m_tcp_server_active) {
         m_tcp_server.poll();
     }
-    handle_encoder();
 
     uint32_t now = to_ms_since_boot(get_absolute_time());
     if (now - m_last_wifi_check > 1000) { 
@@ -203,53 +851,15 @@ void MediaApplication::poll_handler() {
         }
     }
 
-    auto current_draw_status = m_drawing.processDrawing();
-    if (current_draw_status == Drawing::DrawStatus::IDLE) {
-        bool has_new_tile = false;
-        Protocol::Frame tile_to_draw;
-        
-        critical_section_enter_blocking(&m_tile_queue_crit_sec);
-        if (m_queue_head != m_queue_tail) {
-            has_new_tile = true;
-            tile_to_draw = m_tile_queue[m_queue_tail];
-            m_queue_tail = (m_queue_tail + 1) % TILE_QUEUE_SIZE;
-        }
-        critical_section_exit(&m_tile_queue_crit_sec);
-
-        if (has_new_tile) {
-            // We have successfully dequeued the tile and are about to process it.
-            // Now is the correct time to tell the host it can send the next one.
-            m_tcp_server.send_frame(Protocol::FrameType::TILE_ACK, nullptr, 0);
-
-            const uint8_t* payload = tile_to_draw.payload.data();
-            Protocol::ImageTileHeader tile_header;
-            memcpy(&tile_header, payload, sizeof(Protocol::ImageTileHeader));
-            const uint16_t* pixel_data = reinterpret_cast<const uint16_t*>(payload + sizeof(Protocol::ImageTileHeader));
-            m_drawing.drawImageAsync(tile_header.x, tile_header.y, tile_header.width, tile_header.height, pixel_data);
-        }
-    }
-    btstack_run_loop_set_timer(&m_poll_timer, 10);
-    btstack_run_loop_add_timer(&m_poll_timer);
-}
+    // Catches anything a missed wakeup left behind.
+    process_events();
+    update_draw_stats(now);
 
-// --- on_image_tile_received (The Producer) ---
-void MediaApplication::on_image_tile_received(const Protocol::FrameHeader& frame_header, const uint8_t* payload) {
-    critical_section_enter_blocking(&m_tile_queue_crit_sec);
-    
-    uint8_t next_head = (m_queue_head + 1) % TILE_QUEUE_SIZE;
-    if (next_head == m_queue_tail) {
-        printf("WARN: Tile queue is full. Dropping tile.\n");
-    } else {
-        Protocol::Frame& tile_slot = m_tile_queue[m_queue_head];
-        tile_slot.header = frame_header;
-        memcpy(tile_slot.payload.data(), payload, frame_header.payload_length);
-        m_queue_head = next_head;
-    }
-    
-    critical_section_exit(&m_tile_queue_crit_sec);
+    btstack_run_loop_set_timer(&m_poll_timer, POLL_INTERVAL_MS);
+    btstack_run_loop_add_timer(&m_poll_timer);
+    m_poll_armed_us = time_us_32();
 }
 
-
 void MediaApplication::handle_encoder() {
     bool connected = m_media_controller.isConnected();
 
@@ -324,6 +934,10 @@ void MediaApplication::handle_encoder() {
 
 // --- Timer Forwarders ---
 void MediaApplication::poll_handler_forwarder(btstack_timer_source_t* ts) { static_cast<MediaApplication*>(ts->context)->poll_handler(); }
+void MediaApplication::wakeup_handler_forwarder(btstack_data_source_t* ds, btstack_data_source_callback_type_t callback_type) {
+    (void)ds;
+    if (callback_type == DATA_SOURCE_CALLBACK_POLL) g_media_app_instance->process_events();
+}
 void MediaApplication::release_handler_forwarder(btstack_timer_source_t* ts) { static_cast<MediaApplication*>(ts->context)->release_handler(); }
 void MediaApplication::battery_timer_handler_forwarder(btstack_timer_source_t* ts) { static_cast<MediaApplication*>(ts->context)->battery_timer_handler(); }
 
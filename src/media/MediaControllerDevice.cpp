@@ -11,6 +11,7 @@
 #include <string>
 #include <cstring>
 #include <cstdio>
+#include <algorithm>
 
 namespace {
     // Bitmasks for HID reports
@@ -33,6 +34,17 @@ const uint8_t setup_adv_data[] = {
     0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x00, 0xff, 0x00, 0x00
 };
 
+// The ATT callbacks are plain functions; there is only one controller.
+static MediaControllerDevice* s_media_controller = nullptr;
+
+uint16_t att_read_callback(hci_con_handle_t con_handle, uint16_t att_handle, uint16_t offset, uint8_t *buffer, uint16_t buffer_size) {
+    if (att_handle == ATT_CHARACTERISTIC_0000FF02_0000_1000_8000_00805F9B34FB_01_VALUE_HANDLE && s_media_controller) {
+        const Protocol::DeviceStats& stats = s_media_controller->m_stats;
+        return att_read_callback_handle_blob(reinterpret_cast<const uint8_t*>(&stats), sizeof(stats), offset, buffer, buffer_size);
+    }
+    return 0;
+}
+
 int att_write_callback(hci_con_handle_t con_handle, uint16_t att_handle, uint16_t transaction_mode, uint16_t offset, uint8_t *buffer, uint16_t buffer_size) {
     
     // Debug Print
@@ -61,15 +73,24 @@ int att_write_callback(hci_con_handle_t con_handle, uint16_t att_handle, uint16_
         }
         return 0; 
     }
+
+    if (att_handle == ATT_CHARACTERISTIC_0000FF02_0000_1000_8000_00805F9B34FB_01_CLIENT_CONFIGURATION_HANDLE && s_media_controller) {
+        if (buffer_size >= 2) {
+            s_media_controller->m_stats_notify = little_endian_read_16(buffer, 0) == GATT_CLIENT_CHARACTERISTICS_CONFIGURATION_NOTIFICATION;
+            printf("Telemetry notifications %s\n", s_media_controller->m_stats_notify ? "on" : "off");
+        }
+        return 0;
+    }
     return 0;
 }
 
 void MediaControllerDevice::setup() {
     HidDevice::setup();
 
-    printf("Registering ATT Write Callback...\n");
+    printf("Registering ATT Callbacks...\n");
 
-    att_server_init(profile_data, nullptr, att_write_callback);
+    s_media_controller = this;
+    att_server_init(profile_data, att_read_callback, att_write_callback);
     hids_device_init(0, getHidDescriptor(), getHidDescriptorSize());
     battery_service_server_init(100);
     device_information_service_server_init();
@@ -86,11 +107,25 @@ void MediaControllerDevice::setBatteryLevel(uint8_t level) {
     battery_service_server_set_battery_value(level);
 }
 
+void MediaControllerDevice::updateStats(const Protocol::DeviceStats& stats) {
+    m_stats = stats;
+    if (!m_stats_notify || !isConnected()) return;
+    // Dropped if the ACL buffers are full; the next update follows shortly.
+    uint16_t length = std::min<uint16_t>(sizeof(m_stats), att_server_get_mtu(m_connection_handle) - 3);
+    att_server_notify(m_connection_handle, ATT_CHARACTERISTIC_0000FF02_0000_1000_8000_00805F9B34FB_01_VALUE_HANDLE,
+                      reinterpret_cast<const uint8_t*>(&m_stats), length);
+}
+
 const uint8_t* MediaControllerDevice::getHidDescriptor() const { return BleDescriptors::Media::hid_descriptor; }
 uint16_t MediaControllerDevice::getHidDescriptorSize() const { return sizeof(BleDescriptors::Media::hid_descriptor); }
 const uint8_t* MediaControllerDevice::getAdvertisingData() const { return BleDescriptors::Media::advertising_data; }
 uint16_t MediaControllerDevice::getAdvertisingDataSize() const { return sizeof(BleDescriptors::Media::advertising_data); }
 
+void MediaControllerDevice::onConnectionChanged_impl() {
+    // CCCD subscriptions belong to the link; a new central has to subscribe again.
+    m_stats_notify = false;
+}
+
 void MediaControllerDevice::increaseVolume() { uint8_t report[] = {REPORT_MASK_VOLUME_UP}; sendHidReport(report, sizeof(report)); }
 void MediaControllerDevice::decreaseVolume() { uint8_t report[] = {REPORT_MASK_VOLUME_DOWN}; sendHidReport(report, sizeof(report)); }
 void MediaControllerDevice::mute() { uint8_t report[] = {REPORT_MASK_MUTE}; sendHidReport(report, sizeof(report)); }
@@ -0,0 +1,191 @@
+// File: src/net/Crc32.cpp
+
+#include "Crc32.h"
+#include <cstdio>
+#include <cstring>
+#include <new>
+
+#if PICO_ON_DEVICE
+#include "hardware/dma.h"
+#include "pico/time.h"
+#endif
+
+// --- Tables ---
+// Slice-by-8 tables for the reflected polynomial 0xEDB88320, generated at
+// compile time. tables[0] is the classic byte-at-a-time table.
+struct Crc32Tables {
+    uint32_t t[8][256];
+};
+
+static constexpr Crc32Tables make_crc32_tables() {
+    Crc32Tables tables{};
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+        }
+        tables.t[0][i] = crc;
+    }
+    for (int n = 1; n < 8; n++) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t prev = tables.t[n - 1][i];
+            tables.t[n][i] = (prev >> 8) ^ tables.t[0][prev & 0xFF];
+        }
+    }
+    return tables;
+}
+
+static constexpr Crc32Tables s_crc32_tables = make_crc32_tables();
+
+// --- Software CRC ---
+uint32_t crc32_update_bytewise(uint32_t crc, const uint8_t* data, size_t length) {
+    const uint32_t* t0 = s_crc32_tables.t[0];
+    for (size_t i = 0; i < length; i++) {
+        crc = t0[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+uint32_t crc32_update(uint32_t crc, const uint8_t* data, size_t length) {
+    const auto& t = s_crc32_tables.t;
+
+    // Align to a word so the main loop can use two word loads per 8 bytes.
+    size_t head = (4 - ((uintptr_t)data & 3)) & 3;
+    if (head > length) head = length;
+    crc = crc32_update_bytewise(crc, data, head);
+    data += head;
+    length -= head;
+
+    const uint32_t* words = reinterpret_cast<const uint32_t*>(data);
+    for (; length >= 8; length -= 8) {
+        // Little-endian: the low byte of each word is the first byte in memory.
+        uint32_t one = *words++ ^ crc;
+        uint32_t two = *words++;
+        crc = t[7][one & 0xFF] ^ t[6][(one >> 8) & 0xFF] ^ t[5][(one >> 16) & 0xFF] ^ t[4][one >> 24] ^
+              t[3][two & 0xFF] ^ t[2][(two >> 8) & 0xFF] ^ t[1][(two >> 16) & 0xFF] ^ t[0][two >> 24];
+    }
+    return crc32_update_bytewise(crc, reinterpret_cast<const uint8_t*>(words), length);
+}
+
+uint32_t calculate_crc32(const uint8_t* data, size_t length) {
+    return crc32_update(0xFFFFFFFF, data, length) ^ 0xFFFFFFFF;
+}
+
+// --- Copy with CRC ---
+void Crc32Copier::init() {
+#if PICO_ON_DEVICE
+    if (m_dma_channel >= 0) return;
+    m_dma_channel = dma_claim_unused_channel(false);
+    if (m_dma_channel < 0) {
+        printf("WARN: No DMA channel for CRC. Using the software CRC.\n");
+        return;
+    }
+
+    // The sniffer's CRC32R mode is the reflected (zlib) CRC. Check it once
+    // rather than NACK every tile if that ever stops being true.
+    static const uint8_t check[] = "123456789";
+    uint8_t scratch[sizeof(check)];
+    begin();
+    copy(scratch, check, sizeof(check) - 1);
+    if (end() != 0xCBF43926) {
+        printf("WARN: DMA sniffer CRC mismatch. Using the software CRC.\n");
+        dma_channel_unclaim(m_dma_channel);
+        m_dma_channel = -1;
+    }
+#endif
+}
+
+void Crc32Copier::begin() {
+#if PICO_ON_DEVICE
+    if (m_dma_channel >= 0) {
+        dma_sniffer_enable(m_dma_channel, DMA_SNIFF_CTRL_CALC_VALUE_CRC32R, true);
+        dma_sniffer_set_data_accumulator(0xFFFFFFFF);
+        return;
+    }
+#endif
+    m_crc = 0xFFFFFFFF;
+}
+
+void Crc32Copier::copy(void* dst, const void* src, size_t length) {
+    if (length == 0) return;
+#if PICO_ON_DEVICE
+    if (m_dma_channel >= 0) {
+        // Byte transfers: pbuf payloads have no particular alignment, and the
+        // sniffer then sees the bytes in stream order.
+        dma_channel_config config = dma_channel_get_default_config(m_dma_channel);
+        channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+        channel_config_set_read_increment(&config, true);
+        channel_config_set_write_increment(&config, true);
+        channel_config_set_sniff_enable(&config, true);
+        dma_channel_configure(m_dma_channel, &config, dst, src, length, true);
+        dma_channel_wait_for_finish_blocking(m_dma_channel);
+        return;
+    }
+#endif
+    memcpy(dst, src, length);
+    m_crc = crc32_update(m_crc, static_cast<const uint8_t*>(dst), length);
+}
+
+uint32_t Crc32Copier::end() {
+#if PICO_ON_DEVICE
+    if (m_dma_channel >= 0) {
+        return dma_sniffer_get_data_accumulator() ^ 0xFFFFFFFF;
+    }
+#endif
+    return m_crc ^ 0xFFFFFFFF;
+}
+
+// --- Benchmark ---
+void crc32_benchmark(Crc32Copier& copier) {
+#if PICO_ON_DEVICE
+    constexpr size_t MAX_SIZE = 8192;
+    constexpr int REPEATS = 8;
+    uint8_t* src = new (std::nothrow) uint8_t[MAX_SIZE * 2];
+    if (!src) {
+        printf("WARN: Not enough memory for the CRC benchmark.\n");
+        return;
+    }
+    uint8_t* dst = src + MAX_SIZE;
+    for (size_t i = 0; i < MAX_SIZE; i++) {
+        src[i] = (uint8_t)(i * 131 + 7);
+    }
+
+    printf("CRC32 copy+check, KB/s (byte loop / slice-by-8 / %s):\n", copier.usesDma() ? "DMA sniffer" : "copier");
+    for (size_t size = 1024; size <= MAX_SIZE; size *= 2) {
+        uint32_t results[3];
+        uint32_t elapsed_us[3];
+
+        uint32_t start_us = time_us_32();
+        for (int r = 0; r < REPEATS; r++) {
+            memcpy(dst, src, size);
+            results[0] = crc32_update_bytewise(0xFFFFFFFF, dst, size) ^ 0xFFFFFFFF;
+        }
+        elapsed_us[0] = time_us_32() - start_us;
+
+        start_us = time_us_32();
+        for (int r = 0; r < REPEATS; r++) {
+            memcpy(dst, src, size);
+            results[1] = calculate_crc32(dst, size);
+        }
+        elapsed_us[1] = time_us_32() - start_us;
+
+        start_us = time_us_32();
+        for (int r = 0; r < REPEATS; r++) {
+            copier.begin();
+            copier.copy(dst, src, size);
+            results[2] = copier.end();
+        }
+        elapsed_us[2] = time_us_32() - start_us;
+
+        printf("  %2u KB: ", (unsigned)(size / 1024));
+        for (int i = 0; i < 3; i++) {
+            uint32_t us = elapsed_us[i] ? elapsed_us[i] : 1;
+            printf("%lu ", (unsigned long)((uint64_t)size * REPEATS * 1000000 / 1024 / us));
+        }
+        printf("%s\n", (results[0] == results[1] && results[1] == results[2]) ? "" : "(MISMATCH)");
+    }
+    delete[] src;
+#else
+    (void)copier;
+#endif
+}
@@ -6,14 +6,10 @@
 #include <cstring>
 #include <algorithm>
 
-// CRC32 function must be visible here or included
-extern uint32_t calculate_crc32(const uint8_t *data, size_t length);
-
 static TcpServer* g_tcp_server_instance = nullptr;
 
 TcpServer::TcpServer(MediaApplication* app) : m_app_context(app) {
     g_tcp_server_instance = this;
-    critical_section_init(&m_buffer_crit_sec);
 }
 
 // --- Lifecycle Management ---
@@ -35,12 +31,6 @@ bool TcpServer::init(uint16_t port) {
     tcp_arg(m_server_pcb, this);
     tcp_accept(m_server_pcb, &TcpServer::tcp_accept_callback);
     
-    // Reset buffer state
-    critical_section_enter_blocking(&m_buffer_crit_sec);
-    m_rx_head = 0;
-    m_rx_tail = 0;
-    critical_section_exit(&m_buffer_crit_sec);
-    
     return true;
 }
 
@@ -69,13 +59,12 @@ err_t TcpServer::tcp_accept_callback(void *arg, struct tcp_pcb *newpcb, err_t er
     
     tcp_arg(newpcb, g_tcp_server_instance);
     tcp_recv(newpcb, &TcpServer::tcp_recv_callback);
+    tcp_sent(newpcb, &TcpServer::tcp_sent_callback);
     tcp_err(newpcb, &TcpServer::tcp_err_callback);
+    g_tcp_server_instance->m_app_context->on_client_connected();
     
-    // Important: Clear buffer on new connection to prevent processing old garbage
-    critical_section_enter_blocking(&g_tcp_server_instance->m_buffer_crit_sec);
-    g_tcp_server_instance->m_rx_head = 0;
-    g_tcp_server_instance->m_rx_tail = 0;
-    critical_section_exit(&g_tcp_server_instance->m_buffer_crit_sec);
+    // Important: Drop anything left from the previous client
+    g_tcp_server_instance->_reset_rx();
 
     return ERR_OK;
 }
@@ -95,82 +84,150 @@ err_t TcpServer::_recv_callback(struct tcp_pcb *tpcb, struct pbuf *p, err_t err)
     }
 
     m_last_activity_time_ms = to_ms_since_boot(get_absolute_time());
-    tcp_recved(tpcb, p->tot_len);
 
-    // 1. Copy data into linear buffer (Protected)
-    critical_section_enter_blocking(&m_buffer_crit_sec);
-    if (m_rx_head + p->tot_len <= RX_BUFFER_SIZE) {
-        pbuf_copy_partial(p, m_rx_buffer.data() + m_rx_head, p->tot_len, 0);
-        m_rx_head += p->tot_len;
+    // Keep the pbufs and parse them in place. The receive window is only
+    // reopened (tcp_recved) as frames are consumed, so a slow consumer throttles
+    // the sender through TCP itself instead of overflowing a staging buffer.
+    if (m_rx_chain) {
+        pbuf_cat(m_rx_chain, p);
     } else {
-        printf("ERROR: RX Buffer Overflow! Resetting connection.\n");
-        critical_section_exit(&m_buffer_crit_sec);
-        pbuf_free(p);
-        _close_client_connection(); // Nuclear option
-        return ERR_MEM;
+        m_rx_chain = p;
     }
-    critical_section_exit(&m_buffer_crit_sec);
-    pbuf_free(p);
+    m_rx_unacked += p->tot_len;
+    m_rx_bytes_total += p->tot_len;
 
-    // 2. Process Buffer Loop
-    while (true) {
-        // Snapshot indices for reading (head is volatile)
-        size_t head = m_rx_head;
-        size_t tail = m_rx_tail;
-        size_t data_len = head - tail;
+    _process_rx();
+    return ERR_OK;
+}
 
-        if (data_len < sizeof(Protocol::FrameHeader)) break;
+// Send buffer space was freed. Parsing may have stopped at an echo frame
+// that did not fit.
+err_t TcpServer::tcp_sent_callback(void *arg, struct tcp_pcb *tpcb, u16_t len) {
+    auto* server = static_cast<TcpServer*>(arg);
+    if (server && server->m_rx_chain) server->_process_rx();
+    return ERR_OK;
+}
 
+// Parses and dispatches every complete frame in the receive chain.
+void TcpServer::_process_rx() {
+    while (m_rx_chain && m_rx_chain->tot_len >= sizeof(Protocol::FrameHeader)) {
         Protocol::FrameHeader header;
-        memcpy(&header, m_rx_buffer.data() + tail, sizeof(header));
+        pbuf_copy_partial(m_rx_chain, &header, sizeof(header), 0);
 
-        // Resync if magic is wrong
-        if (header.magic != Protocol::FRAME_MAGIC) {
-            printf("Bad Magic: %02x, skipping byte\n", header.magic);
-            m_rx_tail++; 
+        // Resync if magic is wrong, or the length cannot be a valid frame
+        if (header.magic != Protocol::FRAME_MAGIC || header.payload_length > Protocol::MAX_PAYLOAD_SIZE) {
+            printf("Bad frame header: %02x, skipping byte\n", header.magic);
+            _consume_rx(1, true);
             continue;
         }
 
         size_t frame_len = sizeof(header) + header.payload_length;
-        if (data_len < frame_len) break; // Wait for more data
-
-        // We have a full frame. Validate and Dispatch.
-        const uint8_t* payload = m_rx_buffer.data() + tail + sizeof(Protocol::FrameHeader);
-
-        if (header.type == Protocol::FrameType::IMAGE_TILE) {
-            Protocol::ImageTileHeader tile_header;
-            memcpy(&tile_header, payload, sizeof(Protocol::ImageTileHeader));
-            const uint8_t* pixel_data = payload + sizeof(Protocol::ImageTileHeader);
-            size_t pixel_len = header.payload_length - sizeof(Protocol::ImageTileHeader);
-            
-            uint32_t calc_crc = calculate_crc32(pixel_data, pixel_len);
-            if (calc_crc == tile_header.crc32) {
-                m_app_context->on_valid_tile_received(header, payload);
-            } else {
-                printf("CRC Mismatch! Exp: %08X, Calc: %08X. Len: %d\n", 
-                       tile_header.crc32, calc_crc, pixel_len);
-                send_frame(Protocol::FrameType::TILE_NACK, nullptr, 0);
+        if (m_rx_chain->tot_len < frame_len) break; // Wait for more data
+
+        // We have a full frame. Dispatch it straight from the pbuf chain.
+        bool held = false;
+        if (Protocol::is_tile_frame(header.type)) {
+            held = m_app_context->on_tile_frame(header, m_rx_chain, sizeof(header));
+        } else if (header.type == Protocol::FrameType::HELLO) {
+            Protocol::Hello hello = {};
+            pbuf_copy_partial(m_rx_chain, &hello, std::min<size_t>(sizeof(hello), header.payload_length), sizeof(header));
+            m_app_context->on_hello(hello);
+        } else if (header.type == Protocol::FrameType::TILE_TIMESTAMP) {
+            Protocol::TileTimestamp timestamp = {};
+            if (header.payload_length >= sizeof(timestamp)) {
+                pbuf_copy_partial(m_rx_chain, &timestamp, sizeof(timestamp), sizeof(header));
+                m_app_context->on_tile_timestamp(timestamp);
+            }
+        } else if (header.type == Protocol::FrameType::EPOCH_COMMIT) {
+            Protocol::EpochCommit commit = {};
+            if (header.payload_length >= sizeof(commit)) {
+                pbuf_copy_partial(m_rx_chain, &commit, sizeof(commit), sizeof(header));
+                m_app_context->on_epoch_commit(commit);
             }
+        } else if (header.type == Protocol::FrameType::STATS) {
+            m_app_context->on_stats_request();
+        } else if (header.type == Protocol::FrameType::THROUGHPUT_TEST) {
+            // Leave the frame in the chain until its echo fits in the send
+            // buffer; that also stops the window from reopening.
+            if (!_handle_throughput_test(header)) break;
         }
-        
-        // Move tail past this frame
-        m_rx_tail += frame_len;
+
+        // A queued tile keeps its share of the window until it has been drawn.
+        _consume_rx(frame_len, !held);
+    }
+}
+
+// Returns false if the reply cannot be queued yet.
+bool TcpServer::_handle_throughput_test(const Protocol::FrameHeader& header) {
+    Protocol::ThroughputTest test = {};
+    if (header.payload_length < sizeof(test)) return true;
+    pbuf_copy_partial(m_rx_chain, &test, sizeof(test), sizeof(header));
+
+    if (test.mode == Protocol::THROUGHPUT_ECHO) {
+        return _echo_frame(sizeof(header) + header.payload_length);
     }
+    m_app_context->on_throughput_sink(header, test, m_rx_chain, sizeof(header));
+    return true;
+}
 
-    // 3. Compact Buffer (Protected)
-    // Only compact if tail is significant to save cycles
-    if (m_rx_tail > 1024) {
-        critical_section_enter_blocking(&m_buffer_crit_sec);
-        size_t remaining = m_rx_head - m_rx_tail;
-        if (remaining > 0) {
-            memmove(m_rx_buffer.data(), m_rx_buffer.data() + m_rx_tail, remaining);
+// Sends the first 'len' bytes of the receive chain back to the client, all
+// or nothing, so a full send buffer cannot leave half a frame on the wire.
+bool TcpServer::_echo_frame(size_t len) {
+    if (!m_client_pcb) return true;
+
+    // Each tcp_write may queue up to two pbufs per segment it touches.
+    size_t segments = 0;
+    size_t seen = 0;
+    for (const struct pbuf* q = m_rx_chain; q && seen < len; q = q->next) {
+        seen += q->len;
+        segments++;
+    }
+    if (tcp_sndbuf(m_client_pcb) < len ||
+        tcp_sndqueuelen(m_client_pcb) + 2 * segments + 1 > TCP_SND_QUEUELEN) {
+        return false;
+    }
+
+    size_t remaining = len;
+    for (const struct pbuf* q = m_rx_chain; q && remaining > 0; q = q->next) {
+        uint16_t chunk = (uint16_t)std::min<size_t>(q->len, remaining);
+        remaining -= chunk;
+        u8_t flags = TCP_WRITE_FLAG_COPY | (remaining > 0 ? TCP_WRITE_FLAG_MORE : 0);
+        if (tcp_write(m_client_pcb, q->payload, chunk, flags) != ERR_OK) {
+            printf("WARN: Throughput echo truncated.\n");
+            break;
         }
-        m_rx_head = remaining;
-        m_rx_tail = 0;
-        critical_section_exit(&m_buffer_crit_sec);
     }
-    
-    return ERR_OK;
+    tcp_output(m_client_pcb);
+    return true;
+}
+
+// Drops 'len' parsed bytes from the front of the chain, freeing pbufs that
+// are fully consumed.
+void TcpServer::_consume_rx(size_t len, bool reopen_window) {
+    m_rx_chain = pbuf_free_header(m_rx_chain, len);
+    if (reopen_window) {
+        release_rx_window(len);
+    }
+}
+
+// Returns 'len' bytes of receive window to the client. Called once data that
+// on_tile_frame() kept has been drawn.
+void TcpServer::release_rx_window(size_t len) {
+    len = std::min(len, m_rx_unacked);
+    m_rx_unacked -= len;
+    while (m_client_pcb && len > 0) {
+        uint16_t chunk = (uint16_t)std::min<size_t>(len, UINT16_MAX);
+        tcp_recved(m_client_pcb, chunk);
+        len -= chunk;
+    }
+}
+
+void TcpServer::_reset_rx() {
+    if (m_rx_chain) {
+        pbuf_free(m_rx_chain);
+        m_rx_chain = nullptr;
+    }
+    m_rx_unacked = 0;
 }
 
 // --- Cleanup & Error Handling ---
@@ -182,11 +239,9 @@ void TcpServer::tcp_err_callback(void *arg, err_t err) {
         // Do NOT call tcp_close here, PCB is already freed by LWIP
         server->m_client_pcb = nullptr; 
         
-        // Just reset buffer state
-        critical_section_enter_blocking(&server->m_buffer_crit_sec);
-        server->m_rx_head = 0;
-        server->m_rx_tail = 0;
-        critical_section_exit(&server->m_buffer_crit_sec);
+        // Just release the receive chain
+        server->_reset_rx();
+        server->m_app_context->on_client_disconnected();
     }
 }
 
@@ -200,10 +255,8 @@ void TcpServer::_close_client_connection() {
         m_client_pcb = nullptr;
         printf("TCP Client Disconnected\n");
 
-        critical_section_enter_blocking(&m_buffer_crit_sec);
-        m_rx_head = 0;
-        m_rx_tail = 0;
-        critical_section_exit(&m_buffer_crit_sec);
+        _reset_rx();
+        m_app_context->on_client_disconnected();
     }
 }
 
@@ -74,8 +74,14 @@ void RotaryEncoder::init()
     gpio_set_irq_enabled(m_pin_Key, GPIO_IRQ_EDGE_FALL, true);
 }
 
+void RotaryEncoder::setEventCallback(EventCallback callback, void* context) {
+    m_on_event = callback;
+    m_on_event_context = context;
+}
+
 void RotaryEncoder::_key_isr() {
     m_key_event_occurred = true;
+    if (m_on_event) m_on_event(m_on_event_context);
 }
 
 void RotaryEncoder::_rotation_isr() {
@@ -89,6 +95,7 @@ void RotaryEncoder::_rotation_isr() {
     else m_rotation_count++;
     critical_section_exit(&m_crit_sec);
     m_last_rotation_interrupt_time_us = now_us;
+    if (m_on_event) m_on_event(m_on_event_context);
 }
 
 bool RotaryEncoder::read_and_clear_raw_press_event() {
@@ -4,6 +4,7 @@
 #include "pico/stdlib.h"
 #include "hardware/flash.h"
 #include "hardware/sync.h"
+#include "pico/flash.h"
 #include <cstring>
 #include <cstdio> // For printf
 
@@ -53,19 +54,24 @@ public:
         strncpy(creds.password, password, 64);
         creds.password[64] = 0;
 
-        // Writing to flash requires disabling interrupts on BOTH cores in some cases,
-        // but primarily we need to ensure XIP is not accessed.
-        uint32_t ints = save_and_disable_interrupts();
+        // XIP must not be accessed while the flash is written. flash_safe_execute
+        // disables interrupts and, when the display runs on core1, parks that core too.
+        int rc = flash_safe_execute(&WifiConfig::write_flash, &creds, UINT32_MAX);
+        if (rc != PICO_OK) {
+            printf("[WifiConfig] Save failed (%d).\n", rc);
+            return;
+        }
         
+        printf("[WifiConfig] Save Complete.\n");
+    }
+
+private:
+    static void write_flash(void* param) {
         // 1. Erase the sector
         flash_range_erase(FLASH_TARGET_OFFSET, FLASH_SECTOR_SIZE);
         
         // 2. Program the page
-        flash_range_program(FLASH_TARGET_OFFSET, (const uint8_t*)&creds, FLASH_PAGE_SIZE);
-        
-        restore_interrupts(ints);
-        
-        printf("[WifiConfig] Save Complete.\n");
+        flash_range_program(FLASH_TARGET_OFFSET, (const uint8_t*)param, FLASH_PAGE_SIZE);
     }
 };
 
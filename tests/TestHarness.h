@@ -0,0 +1,69 @@
+// File: tests/TestHarness.h
+
+#ifndef TEST_HARNESS_H
+#define TEST_HARNESS_H
+
+#include <cstdio>
+#include <vector>
+
+// Minimal test runner for the host tests: TEST(name) registers a case,
+// CHECK/CHECK_EQ record failures without stopping the case, and
+// run_all_tests() returns a non-zero exit code if anything failed.
+
+struct TestCase {
+    const char* name;
+    void (*fn)();
+};
+
+inline std::vector<TestCase>& test_registry() {
+    static std::vector<TestCase> cases;
+    return cases;
+}
+
+inline int& test_failures() {
+    static int failures = 0;
+    return failures;
+}
+
+struct TestRegistrar {
+    TestRegistrar(const char* name, void (*fn)()) { test_registry().push_back({name, fn}); }
+};
+
+#define TEST(name)                                              \
+    static void name();                                         \
+    static TestRegistrar name##_registrar(#name, name);         \
+    static void name()
+
+#define CHECK(cond)                                                             \
+    do {                                                                        \
+        if (!(cond)) {                                                          \
+            std::printf("  %s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            test_failures()++;                                                  \
+        }                                                                       \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                              \
+    do {                                                                        \
+        long long a_ = (long long)(actual);                                     \
+        long long e_ = (long long)(expected);                                   \
+        if (a_ != e_) {                                                         \
+            std::printf("  %s:%d: %s == %lld, expected %s == %lld\n", __FILE__,   \
+                        __LINE__, #actual, a_, #expected, e_);                  \
+            test_failures()++;                                                  \
+        }                                                                       \
+    } while (0)
+
+inline int run_all_tests() {
+    int failed_cases = 0;
+    for (const TestCase& t : test_registry()) {
+        int before = test_failures();
+        t.fn();
+        bool ok = test_failures() == before;
+        std::printf("%s %s\n", ok ? "PASS" : "FAIL", t.name);
+        if (!ok) failed_cases++;
+    }
+    std::printf("%d/%d passed\n", (int)test_registry().size() - failed_cases, (int)test_registry().size());
+    return failed_cases ? 1 : 0;
+}
+
+#endif // TEST_HARNESS_H
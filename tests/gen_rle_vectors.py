@@ -0,0 +1,81 @@
+# File: tests/gen_rle_vectors.py
+"""
+Writes rle_vectors.h for test_drawing: test images, their encoding by
+scripts/tile_codec.py and the offset of each encoded row, so the device
+decoder is checked against the host encoder rather than a copy of it.
+
+Usage: gen_rle_vectors.py <scripts dir> <output header>
+"""
+import random
+import struct
+import sys
+
+
+def images():
+    rng = random.Random(2024)
+    # Identical gradient rows: copy-up after the first row.
+    width, height = 40, 6
+    yield "gradient", width, height, [(x * 0x0841) & 0xFFFF for _ in range(height) for x in range(width)]
+
+    # Flat background, a noisy band longer than one literal op, runs of
+    # every length up to past MAX_REPEAT, and a row that half repeats the one above.
+    width, height = 320, 5
+    pixels = [0x001F] * width
+    pixels += [rng.randrange(0x10000) if 10 <= x < 290 else 0x001F for x in range(width)]
+    row, color = [], 0
+    while len(row) < width:
+        run = 1 + len(row) % 70
+        row += [color] * run
+        color = (color + 0x1111) & 0xFFFF
+    pixels += row[:width]
+    pixels += [p if x % 50 < 25 else 0xF800 for x, p in enumerate(row[:width])]
+    pixels += [rng.randrange(4) for _ in range(width)]
+    yield "mixed", width, height, pixels
+
+    width, height = 17, 3
+    yield "noise", width, height, [rng.randrange(0x10000) for _ in range(width * height)]
+
+
+def c_array(ctype, name, values, per_line):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append("    " + ", ".join(f"0x{v:0{2 if ctype == 'uint8_t' else 4}x}" for v in values[i:i + per_line]) + ",")
+    return f"static const {ctype} {name}[] = {{\n" + "\n".join(lines) + "\n};\n"
+
+
+def main():
+    sys.path.insert(0, sys.argv[1])
+    import tile_codec
+
+    out = ["// Generated by tests/gen_rle_vectors.py from scripts/tile_codec.py. Do not edit.",
+           "#pragma once", "#include <cstddef>", "#include <cstdint>", ""]
+    table = []
+    for name, width, height, pixels in images():
+        raw = struct.pack(f"<{len(pixels)}H", *pixels)
+        rows = list(tile_codec.encode_rows(raw, width, height))
+        data = b"".join(rows)
+        assert tile_codec.decode(data, width, height) == raw
+        offsets, pos = [], 0
+        for row in rows:
+            offsets.append(pos)
+            pos += len(row)
+        out.append(c_array("uint16_t", f"{name}_pixels", pixels, 12))
+        out.append(c_array("uint8_t", f"{name}_data", list(data), 16))
+        out.append(c_array("uint32_t", f"{name}_rows", offsets, 12))
+        table.append(f'    {{"{name}", {width}, {height}, {name}_pixels, {name}_data, sizeof({name}_data), {name}_rows}},')
+
+    out += ["struct RleVector {",
+            "    const char* name;",
+            "    uint16_t width, height;",
+            "    const uint16_t* pixels;",
+            "    const uint8_t* data;",
+            "    size_t length;",
+            "    const uint32_t* row_offsets;",
+            "};", "",
+            "static const RleVector rle_vectors[] = {"] + table + ["};", ""]
+    with open(sys.argv[2], "w") as f:
+        f.write("\n".join(out))
+
+
+if __name__ == "__main__":
+    main()
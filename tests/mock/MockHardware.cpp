@@ -0,0 +1,651 @@
+// File: tests/mock/MockHardware.cpp
+
+#include "MockHardware.h"
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include "hardware/gpio.h"
+#include "hardware/interp.h"
+#include "hardware/irq.h"
+
+#ifndef ST7789_PIO_PATH
+#error "ST7789_PIO_PATH must point at st7789_lcd.pio"
+#endif
+
+namespace {
+
+constexpr uint NUM_DMA_CHANNELS = 12;
+constexpr uint NUM_PIOS = 2;
+constexpr uint NUM_SMS = 4;
+constexpr uint NUM_GPIOS = 30;
+constexpr uint PIO_INSTRUCTION_COUNT = 32;
+// State machine cycles that pass during one poll of FDEBUG with PIO held.
+constexpr uint64_t CYCLES_PER_STALL_POLL = 64;
+
+struct Channel {
+    bool claimed = false;
+    dma_channel_config config{};
+    volatile void* write_addr = nullptr;
+    const volatile void* read_addr = nullptr;
+    bool busy = false;
+    bool irq1_enabled = false;
+    bool irq1_status = false;
+};
+
+struct StateMachine {
+    PioStateMachine sim;
+    bool claimed = false;
+    bool enabled = false;
+    bool pending = false; // Has words from while PIO was held
+};
+
+struct Pio {
+    StateMachine sms[NUM_SMS];
+    uint used_instructions = 0;
+    uint next_offset = 0;
+    std::map<uint, uint> loaded; // offset -> length
+};
+
+struct Panel {
+    bool attached = false;
+    uint sda = 0, scl = 0, cs = 0, dc = 0;
+};
+
+Channel g_channels[NUM_DMA_CHANNELS];
+dma_channel_hw_t g_channel_hw[NUM_DMA_CHANNELS];
+bool g_hold_dma = false;
+std::deque<uint> g_held;
+
+Pio g_pios[NUM_PIOS];
+std::map<std::string, PioProgram>* g_programs = nullptr;
+pio_txf_reg* g_pending_byte = nullptr;
+uint64_t g_cycle_budget = 1ull << 26;
+bool g_hung = false;
+bool g_hold_pio = false;
+uint64_t g_stall_polls = 0;
+
+bool g_gpio_level[NUM_GPIOS];
+bool g_gpio_pio[NUM_GPIOS];
+Panel g_panel_pins;
+std::unique_ptr<St7789Model> g_panel;
+
+irq_handler_t g_dma_irq1_handler = nullptr;
+bool g_dma_irq1_enabled = false;
+uint64_t g_now_us = 0;
+
+std::vector<mock::FifoWrite> g_fifo_writes;
+std::vector<mock::DmaRun> g_dma_runs;
+
+interp_hw_t g_interp;
+
+const std::map<std::string, PioProgram>& programs() {
+    if (!g_programs) {
+        g_programs = new std::map<std::string, PioProgram>(pio_assemble_file(ST7789_PIO_PATH));
+    }
+    return *g_programs;
+}
+
+uint pio_index(PIO pio) {
+    return (uint)(pio - mock_pio_instances);
+}
+
+void on_clock(uint32_t pins) {
+    const Panel& p = g_panel_pins;
+    if (!p.attached) return;
+    bool data = (pins >> p.sda) & 1;
+    bool dc = g_gpio_pio[p.dc] ? ((pins >> p.dc) & 1) : g_gpio_level[p.dc];
+    g_panel->clock(data, dc);
+}
+
+void run_sm(StateMachine& s) {
+    if (!s.enabled) return;
+    if (g_hold_pio) {
+        s.pending = true;
+        return;
+    }
+    if (!s.sim.run(g_cycle_budget)) g_hung = true;
+    s.pending = false;
+}
+
+// Runs a held state machine for a while, as it would while the CPU polls.
+void advance_sm(StateMachine& s, uint64_t cycles) {
+    if (!s.enabled || !s.pending) return;
+    if (s.sim.run(cycles)) s.pending = false;
+}
+
+void fifo_write(pio_txf_reg* reg, uint32_t value, uint bits, bool from_dma) {
+    for (uint p = 0; p < NUM_PIOS; ++p) {
+        for (uint sm = 0; sm < NUM_SMS; ++sm) {
+            if (std::addressof(mock_pio_instances[p].txf[sm]) != reg) continue;
+            uint32_t word = bits == 8 ? (value & 0xff) * 0x01010101u
+                          : bits == 16 ? (value & 0xffff) * 0x00010001u
+                          : value;
+            g_fifo_writes.push_back({p, sm, word, value, bits, from_dma});
+            StateMachine& s = g_pios[p].sms[sm];
+            s.sim.push(word);
+            run_sm(s);
+            return;
+        }
+    }
+    std::abort();
+}
+
+// Pushes a CPU byte write through '*(volatile uint8_t*)&txf[sm] = x'. Every
+// mock entry point calls this first, so it lands in program order.
+void flush() {
+    if (g_pending_byte) {
+        pio_txf_reg* reg = g_pending_byte;
+        g_pending_byte = nullptr;
+        fifo_write(reg, reg->bytes[0], 8, false);
+    }
+}
+
+bool is_txf(const volatile void* addr) {
+    for (uint p = 0; p < NUM_PIOS; ++p) {
+        for (uint sm = 0; sm < NUM_SMS; ++sm) {
+            if (std::addressof(mock_pio_instances[p].txf[sm]) == addr) return true;
+        }
+    }
+    return false;
+}
+
+void trigger(uint ch);
+
+void execute(uint ch) {
+    Channel& c = g_channels[ch];
+    dma_channel_hw_t& hw = g_channel_hw[ch];
+    uint32_t count = hw.transfer_count;
+    uint size = 1u << c.config.data_size;
+    g_dma_runs.push_back({ch, count, c.config.data_size, c.config.read_increment});
+
+    const volatile uint8_t* src = (const volatile uint8_t*)c.read_addr;
+    volatile uint8_t* dst = (volatile uint8_t*)c.write_addr;
+    bool to_fifo = is_txf(c.write_addr);
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t value = 0;
+        std::memcpy(&value, (const void*)src, size);
+        if (c.config.read_increment) src += size;
+        if (to_fifo) {
+            fifo_write((pio_txf_reg*)c.write_addr, value, size * 8, true);
+        } else {
+            std::memcpy((void*)dst, &value, size);
+            if (c.config.write_increment) dst += size;
+        }
+    }
+    c.read_addr = src;
+    if (!to_fifo) c.write_addr = dst;
+    hw.transfer_count = 0;
+    c.busy = false;
+
+    if (c.irq1_enabled) {
+        c.irq1_status = true;
+        if (g_dma_irq1_enabled && g_dma_irq1_handler) g_dma_irq1_handler();
+    }
+    if (c.config.chain_to != ch) trigger(c.config.chain_to);
+}
+
+void trigger(uint ch) {
+    if (g_hold_dma) {
+        g_channels[ch].busy = true;
+        g_held.push_back(ch);
+    } else {
+        execute(ch);
+    }
+}
+
+void set_gpio(uint pin, bool level) {
+    g_gpio_level[pin] = level;
+    if (g_panel_pins.attached && pin == g_panel_pins.cs) g_panel->setChipSelect(level);
+}
+
+} // namespace
+
+// --- Test control ---
+
+namespace mock {
+
+void reset() {
+    g_pending_byte = nullptr;
+    for (Channel& c : g_channels) c = Channel();
+    std::memset(g_channel_hw, 0, sizeof(g_channel_hw));
+    g_hold_dma = false;
+    g_held.clear();
+    for (uint p = 0; p < NUM_PIOS; ++p) {
+        g_pios[p] = Pio();
+        for (uint sm = 0; sm < NUM_SMS; ++sm) {
+            g_pios[p].sms[sm].sim.setListener(on_clock);
+        }
+    }
+    g_hung = false;
+    g_cycle_budget = 1ull << 26;
+    g_hold_pio = false;
+    g_stall_polls = 0;
+    std::memset(g_gpio_level, 0, sizeof(g_gpio_level));
+    std::memset(g_gpio_pio, 0, sizeof(g_gpio_pio));
+    g_panel_pins = Panel();
+    g_panel.reset(new St7789Model());
+    g_dma_irq1_handler = nullptr;
+    g_dma_irq1_enabled = false;
+    g_now_us = 0;
+    g_fifo_writes.clear();
+    g_dma_runs.clear();
+}
+
+void attachPanel(uint pin_sda, uint pin_scl, uint pin_cs, uint pin_dc) {
+    g_panel_pins = {true, pin_sda, pin_scl, pin_cs, pin_dc};
+    g_gpio_level[pin_cs] = true;
+}
+
+St7789Model& panel() {
+    flush();
+    return *g_panel;
+}
+
+const std::vector<FifoWrite>& fifoWrites() {
+    flush();
+    return g_fifo_writes;
+}
+
+const std::vector<DmaRun>& dmaRuns() {
+    flush();
+    return g_dma_runs;
+}
+
+void clearLogs() {
+    flush();
+    g_fifo_writes.clear();
+    g_dma_runs.clear();
+    g_panel->clearLog();
+}
+
+void holdDma(bool hold) {
+    flush();
+    g_hold_dma = hold;
+}
+
+void releaseDma() {
+    flush();
+    while (!g_held.empty()) {
+        uint ch = g_held.front();
+        g_held.pop_front();
+        execute(ch);
+    }
+}
+
+void holdPio(bool hold) {
+    flush();
+    g_hold_pio = hold;
+}
+
+void releasePio() {
+    flush();
+    g_hold_pio = false;
+    for (Pio& p : g_pios) {
+        for (StateMachine& s : p.sms) {
+            if (s.pending) run_sm(s);
+        }
+    }
+}
+
+uint64_t stallPolls() {
+    return g_stall_polls;
+}
+
+PioStateMachine& stateMachine(PIO pio, uint sm) {
+    flush();
+    return g_pios[pio_index(pio)].sms[sm].sim;
+}
+
+bool stateMachineHung() {
+    flush();
+    return g_hung;
+}
+
+void setCycleBudget(uint64_t cycles) {
+    g_cycle_budget = cycles;
+}
+
+bool gpioLevel(uint pin) {
+    flush();
+    return g_gpio_level[pin];
+}
+
+uint64_t nowUs() {
+    return g_now_us;
+}
+
+} // namespace mock
+
+// --- pico/stdlib.h ---
+
+uint32_t time_us_32() {
+    flush();
+    return (uint32_t)++g_now_us;
+}
+
+uint64_t time_us_64() {
+    flush();
+    return ++g_now_us;
+}
+
+void sleep_ms(uint32_t ms) {
+    flush();
+    g_now_us += (uint64_t)ms * 1000;
+}
+
+void busy_wait_us_32(uint32_t us) {
+    flush();
+    g_now_us += us;
+}
+
+// Polling loops are where the firmware waits for DMA; let held transfers finish.
+void tight_loop_contents() {
+    mock::releaseDma();
+}
+
+// --- hardware/gpio.h ---
+
+void gpio_init(uint pin) {
+    flush();
+    g_gpio_pio[pin] = false;
+    set_gpio(pin, false);
+}
+
+void gpio_init_mask(uint32_t mask) {
+    for (uint pin = 0; pin < NUM_GPIOS; ++pin) {
+        if (mask & (1u << pin)) gpio_init(pin);
+    }
+}
+
+void gpio_set_dir(uint pin, bool out) {
+    (void)pin;
+    (void)out;
+    flush();
+}
+
+void gpio_set_dir_out_masked(uint32_t mask) {
+    (void)mask;
+    flush();
+}
+
+void gpio_put(uint pin, bool value) {
+    flush();
+    set_gpio(pin, value);
+}
+
+void gpio_put_masked(uint32_t mask, uint32_t value) {
+    flush();
+    for (uint pin = 0; pin < NUM_GPIOS; ++pin) {
+        if (mask & (1u << pin)) set_gpio(pin, (value >> pin) & 1);
+    }
+}
+
+// --- hardware/irq.h ---
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority) {
+    (void)order_priority;
+    flush();
+    if (num == DMA_IRQ_1) g_dma_irq1_handler = handler;
+}
+
+void irq_set_enabled(uint num, bool enabled) {
+    flush();
+    if (num == DMA_IRQ_1) g_dma_irq1_enabled = enabled;
+}
+
+// --- hardware/pio.h ---
+
+pio_hw_t mock_pio_instances[2];
+
+pio_txf_reg::address::operator volatile uint8_t*() const {
+    flush();
+    g_pending_byte = reg;
+    return reg->bytes;
+}
+
+void pio_fdebug_reg::operator=(uint32_t value) {
+    (void)value;
+    flush();
+}
+
+// TXSTALL reads as set for every state machine that has run out of words.
+// A held one gets CYCLES_PER_STALL_POLL cycles further per read.
+pio_fdebug_reg::operator uint32_t() const {
+    flush();
+    const pio_hw_t* hw = reinterpret_cast<const pio_hw_t*>(reinterpret_cast<const char*>(this) - offsetof(pio_hw_t, fdebug));
+    Pio& p = g_pios[hw - mock_pio_instances];
+    uint32_t flags = 0xffffffffu;
+    for (uint sm = 0; sm < NUM_SMS; ++sm) {
+        StateMachine& s = p.sms[sm];
+        if (!s.pending) continue;
+        g_stall_polls++;
+        advance_sm(s, CYCLES_PER_STALL_POLL);
+        if (s.pending) flags &= ~(1u << (sm + PIO_FDEBUG_TXSTALL_LSB));
+    }
+    return flags;
+}
+
+pio_sm_config pio_get_default_sm_config() {
+    pio_sm_config c{};
+    c.out_shift_right = true;
+    c.pull_threshold = 32;
+    c.in_shift_right = true;
+    c.push_threshold = 32;
+    c.clkdiv = 1.0f;
+    return c;
+}
+
+uint pio_add_program(PIO pio, const pio_program_t* program) {
+    flush();
+    Pio& p = g_pios[pio_index(pio)];
+    auto it = programs().find(program->name);
+    if (it == programs().end()) std::abort();
+    uint length = (uint)it->second.code.size();
+    // The SDK panics when instruction memory is full.
+    if (p.used_instructions + length > PIO_INSTRUCTION_COUNT) std::abort();
+    p.used_instructions += length;
+    uint offset = p.next_offset++;
+    p.loaded[offset] = length;
+    return offset;
+}
+
+void pio_remove_program(PIO pio, const pio_program_t* program, uint offset) {
+    (void)program;
+    flush();
+    Pio& p = g_pios[pio_index(pio)];
+    auto it = p.loaded.find(offset);
+    if (it == p.loaded.end()) std::abort();
+    p.used_instructions -= it->second;
+    p.loaded.erase(it);
+}
+
+int pio_claim_unused_sm(PIO pio, bool required) {
+    flush();
+    Pio& p = g_pios[pio_index(pio)];
+    for (uint sm = 0; sm < NUM_SMS; ++sm) {
+        if (!p.sms[sm].claimed) {
+            p.sms[sm].claimed = true;
+            return (int)sm;
+        }
+    }
+    if (required) std::abort();
+    return -1;
+}
+
+void pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config* config) {
+    (void)initial_pc;
+    flush();
+    StateMachine& s = g_pios[pio_index(pio)].sms[sm];
+    auto it = programs().find(config->program->name);
+    if (it == programs().end()) std::abort();
+    s.enabled = false;
+    s.pending = false;
+    s.sim.init(&it->second, *config);
+}
+
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled) {
+    flush();
+    StateMachine& s = g_pios[pio_index(pio)].sms[sm];
+    s.enabled = enabled;
+    run_sm(s);
+}
+
+void pio_gpio_init(PIO pio, uint pin) {
+    (void)pio;
+    flush();
+    g_gpio_pio[pin] = true;
+}
+
+void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin, uint count, bool is_out) {
+    (void)pio;
+    (void)sm;
+    (void)pin;
+    (void)count;
+    (void)is_out;
+    flush();
+}
+
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm) {
+    (void)pio;
+    (void)sm;
+    flush();
+    return false;
+}
+
+uint pio_get_dreq(PIO pio, uint sm, bool is_tx) {
+    (void)is_tx;
+    return pio_index(pio) * 8 + sm;
+}
+
+// --- hardware/dma.h ---
+
+int dma_claim_unused_channel(bool required) {
+    flush();
+    for (uint ch = 0; ch < NUM_DMA_CHANNELS; ++ch) {
+        if (!g_channels[ch].claimed) {
+            g_channels[ch].claimed = true;
+            return (int)ch;
+        }
+    }
+    if (required) std::abort();
+    return -1;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+    dma_channel_config c{};
+    c.read_increment = true;
+    c.write_increment = false;
+    c.data_size = DMA_SIZE_32;
+    c.chain_to = channel;
+    c.dreq = 0x3f;
+    return c;
+}
+
+dma_channel_config dma_get_channel_config(uint channel) {
+    flush();
+    return g_channels[channel].config;
+}
+
+void dma_channel_set_config(uint channel, const dma_channel_config* config, bool trigger_now) {
+    flush();
+    g_channels[channel].config = *config;
+    if (trigger_now) trigger(channel);
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config* config, volatile void* write_addr,
+                           const volatile void* read_addr, uint transfer_count, bool trigger_now) {
+    flush();
+    Channel& c = g_channels[channel];
+    c.config = *config;
+    c.write_addr = write_addr;
+    c.read_addr = read_addr;
+    g_channel_hw[channel].transfer_count = transfer_count;
+    if (trigger_now) trigger(channel);
+}
+
+void dma_channel_set_read_addr(uint channel, const volatile void* read_addr, bool trigger_now) {
+    flush();
+    g_channels[channel].read_addr = read_addr;
+    if (trigger_now) trigger(channel);
+}
+
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger_now) {
+    flush();
+    g_channel_hw[channel].transfer_count = trans_count;
+    if (trigger_now) trigger(channel);
+}
+
+bool dma_channel_is_busy(uint channel) {
+    flush();
+    return g_channels[channel].busy;
+}
+
+void dma_channel_wait_for_finish_blocking(uint channel) {
+    flush();
+    if (g_channels[channel].busy) mock::releaseDma();
+}
+
+dma_channel_hw_t* dma_channel_hw_addr(uint channel) {
+    flush();
+    return &g_channel_hw[channel];
+}
+
+void dma_channel_set_irq1_enabled(uint channel, bool enabled) {
+    flush();
+    g_channels[channel].irq1_enabled = enabled;
+}
+
+bool dma_channel_get_irq1_status(uint channel) {
+    return g_channels[channel].irq1_status;
+}
+
+void dma_channel_acknowledge_irq1(uint channel) {
+    g_channels[channel].irq1_status = false;
+}
+
+// --- hardware/interp.h ---
+
+interp_hw_t* interp0 = &g_interp;
+
+interp_config interp_default_config() {
+    return interp_config{0, 0, 31, false};
+}
+
+void interp_config_set_shift(interp_config* c, uint shift) {
+    c->shift = shift;
+}
+
+void interp_config_set_mask(interp_config* c, uint lsb, uint msb) {
+    c->mask_lsb = lsb;
+    c->mask_msb = msb;
+}
+
+void interp_config_set_cross_input(interp_config* c, bool cross_input) {
+    c->cross_input = cross_input;
+}
+
+void interp_set_config(interp_hw_t* interp, uint lane, interp_config* config) {
+    interp->ctrl[lane] = *config;
+}
+
+// Lane result: the (possibly crossed) accumulator shifted right, masked and
+// added to the lane's base. Reading POPn returns lane n's result and writes
+// both lanes' results back to their accumulators.
+interp_pop_reg::operator uintptr_t() {
+    interp_hw_t* interp = &g_interp;
+    uint lane = (uint)(this - interp->pop);
+    uintptr_t result[2];
+    for (uint i = 0; i < 2; ++i) {
+        const interp_config& c = interp->ctrl[i];
+        uint32_t input = (uint32_t)interp->accum[c.cross_input ? 1 - i : i];
+        uint32_t mask = (c.mask_msb - c.mask_lsb == 31 ? ~0u : ((1u << (c.mask_msb - c.mask_lsb + 1)) - 1)) << c.mask_lsb;
+        result[i] = interp->base[i] + ((input >> c.shift) & mask);
+    }
+    interp->accum[0] = result[0];
+    interp->accum[1] = result[1];
+    return lane < 2 ? result[lane] : interp->base[2] + result[0] + result[1];
+}
@@ -0,0 +1,68 @@
+// File: tests/mock/MockHardware.h
+
+#ifndef MOCK_HARDWARE_H
+#define MOCK_HARDWARE_H
+
+#include <vector>
+#include "pico/stdlib.h"
+#include "hardware/dma.h"
+#include "hardware/pio.h"
+#include "PioSim.h"
+#include "St7789Model.h"
+
+// Test-side control of the mocked SDK. DMA channels run as soon as they are
+// triggered and push into the PIO state machines, which run the assembled
+// .pio programs and clock the panel model. With DMA held, triggered channels
+// stay busy until released, to test code that polls for completion. With PIO
+// held, words wait in the FIFO and the state machines only run while FDEBUG
+// is polled, or once released.
+namespace mock {
+
+struct FifoWrite {
+    uint pio;
+    uint sm;
+    uint32_t word;  // As it lands in the FIFO, after bus replication
+    uint32_t value; // As written, before replication
+    uint bits;      // Bus width of the write: 8, 16 or 32
+    bool from_dma;
+};
+
+struct DmaRun {
+    uint channel;
+    uint32_t count;
+    dma_channel_transfer_size size;
+    bool read_increment;
+};
+
+// Back to power-on state: nothing claimed, no programs, a blank panel, empty logs.
+void reset();
+// Wires the panel model to the display's pins.
+void attachPanel(uint pin_sda, uint pin_scl, uint pin_cs, uint pin_dc);
+St7789Model& panel();
+
+const std::vector<FifoWrite>& fifoWrites();
+const std::vector<DmaRun>& dmaRuns();
+void clearLogs();
+
+void holdDma(bool hold);
+// Completes every held transfer, including the ones they chain to.
+void releaseDma();
+
+void holdPio(bool hold);
+// Runs every held state machine until it stalls.
+void releasePio();
+// FDEBUG reads that found a held state machine still running.
+uint64_t stallPolls();
+
+PioStateMachine& stateMachine(PIO pio, uint sm);
+// Set if a state machine was still running after the cycle budget of a
+// single FIFO write, e.g. a transfer count that underflowed.
+bool stateMachineHung();
+void setCycleBudget(uint64_t cycles);
+
+bool gpioLevel(uint pin);
+uint64_t nowUs();
+
+} // namespace mock
+
+#endif // MOCK_HARDWARE_H
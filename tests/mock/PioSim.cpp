@@ -0,0 +1,411 @@
+// File: tests/mock/PioSim.cpp
+
+#include "PioSim.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+using Loc = PioInstr::Loc;
+using Cond = PioInstr::Cond;
+
+[[noreturn]] void fail(int line, const std::string& what) {
+    throw std::runtime_error("pio line " + std::to_string(line) + ": " + what);
+}
+
+std::string trim(const std::string& s) {
+    size_t begin = s.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) return "";
+    size_t end = s.find_last_not_of(" \t\r");
+    return s.substr(begin, end - begin + 1);
+}
+
+std::string strip_comment(const std::string& s) {
+    size_t cut = std::min(s.find(';'), s.find("//"));
+    return cut == std::string::npos ? s : s.substr(0, cut);
+}
+
+std::vector<std::string> split_args(const std::string& s) {
+    std::vector<std::string> args;
+    std::stringstream ss(s);
+    std::string arg;
+    while (std::getline(ss, arg, ',')) {
+        arg = trim(arg);
+        if (!arg.empty()) args.push_back(arg);
+    }
+    return args;
+}
+
+uint32_t parse_number(int line, const std::string& s) {
+    try {
+        size_t used = 0;
+        unsigned long v = std::stoul(s, &used, 0);
+        if (used != s.size()) fail(line, "bad number '" + s + "'");
+        return (uint32_t)v;
+    } catch (const std::logic_error&) {
+        fail(line, "bad number '" + s + "'");
+    }
+}
+
+Loc parse_loc(int line, const std::string& s) {
+    if (s == "pins") return Loc::PINS;
+    if (s == "x") return Loc::X;
+    if (s == "y") return Loc::Y;
+    if (s == "null") return Loc::NUL;
+    if (s == "isr") return Loc::ISR;
+    if (s == "osr") return Loc::OSR;
+    fail(line, "unsupported operand '" + s + "'");
+}
+
+Cond parse_cond(int line, const std::string& s) {
+    if (s == "!x") return Cond::NOT_X;
+    if (s == "x--") return Cond::X_DEC;
+    if (s == "!y") return Cond::NOT_Y;
+    if (s == "y--") return Cond::Y_DEC;
+    if (s == "x!=y") return Cond::X_NE_Y;
+    if (s == "!osre") return Cond::NOT_OSRE;
+    fail(line, "unsupported jmp condition '" + s + "'");
+}
+
+uint32_t bit_reverse(uint32_t v) {
+    uint32_t r = 0;
+    for (int i = 0; i < 32; ++i) {
+        r = (r << 1) | (v & 1);
+        v >>= 1;
+    }
+    return r;
+}
+
+struct PendingJump {
+    size_t index;
+    std::string label;
+    int line;
+};
+
+struct ProgramBuilder {
+    PioProgram program;
+    std::map<std::string, uint32_t> labels;
+    std::vector<PendingJump> jumps;
+    int sideset_bits = 0;
+    bool sideset_optional = false;
+    bool has_wrap = false;
+
+    void finish() {
+        for (const PendingJump& j : jumps) {
+            auto it = labels.find(j.label);
+            if (it == labels.end()) fail(j.line, "unknown label '" + j.label + "'");
+            program.code[j.index].value = it->second;
+        }
+        if (!has_wrap && !program.code.empty()) {
+            program.wrap = (uint32_t)program.code.size() - 1;
+        }
+    }
+};
+
+// Splits "out pins, 1 side 0 [3]" into the operation and its side/delay.
+PioInstr parse_instruction(ProgramBuilder& b, int line, std::string text) {
+    PioInstr in;
+    in.line = line;
+
+    size_t bracket = text.find('[');
+    if (bracket != std::string::npos) {
+        size_t close = text.find(']', bracket);
+        if (close == std::string::npos) fail(line, "unterminated delay");
+        in.delay = parse_number(line, trim(text.substr(bracket + 1, close - bracket - 1)));
+        text = text.substr(0, bracket) + text.substr(close + 1);
+    }
+    std::stringstream words(text);
+    std::vector<std::string> tokens;
+    std::string token;
+    while (words >> token) tokens.push_back(token);
+    for (size_t i = 0; i + 1 < tokens.size(); ++i) {
+        if (tokens[i] == "side") {
+            in.side = (int)parse_number(line, tokens[i + 1]);
+            tokens.resize(i);
+            break;
+        }
+    }
+    if (tokens.empty()) fail(line, "missing instruction");
+    if (b.sideset_bits > 0 && in.side < 0 && !b.sideset_optional) fail(line, "missing side-set");
+    if (in.side >= 0 && b.sideset_bits == 0) fail(line, "side-set without .side_set");
+
+    std::string mnemonic = tokens[0];
+    std::string rest;
+    for (size_t i = 1; i < tokens.size(); ++i) rest += tokens[i] + " ";
+    std::vector<std::string> args = split_args(rest);
+
+    if (mnemonic == "nop") {
+        in.op = PioInstr::Op::MOV;
+        in.dst = Loc::Y;
+        in.src = Loc::Y;
+    } else if (mnemonic == "pull") {
+        in.op = PioInstr::Op::PULL;
+        if (!args.empty() && args[0] != "block") fail(line, "unsupported pull option '" + args[0] + "'");
+    } else if (mnemonic == "out" || mnemonic == "in") {
+        if (args.size() != 2) fail(line, mnemonic + " needs two operands");
+        in.op = mnemonic == "out" ? PioInstr::Op::OUT : PioInstr::Op::IN;
+        (mnemonic == "out" ? in.dst : in.src) = parse_loc(line, args[0]);
+        in.value = parse_number(line, args[1]);
+        if (in.value < 1 || in.value > 32) fail(line, "bit count out of range");
+    } else if (mnemonic == "mov") {
+        if (args.size() != 2) fail(line, "mov needs two operands");
+        in.op = PioInstr::Op::MOV;
+        in.dst = parse_loc(line, args[0]);
+        std::string src = args[1];
+        if (src.compare(0, 2, "::") == 0) {
+            in.mov_op = PioInstr::MovOp::REVERSE;
+            src = trim(src.substr(2));
+        } else if (src[0] == '!' || src[0] == '~') {
+            in.mov_op = PioInstr::MovOp::INVERT;
+            src = trim(src.substr(1));
+        }
+        in.src = parse_loc(line, src);
+    } else if (mnemonic == "set") {
+        if (args.size() != 2) fail(line, "set needs two operands");
+        in.op = PioInstr::Op::SET;
+        in.dst = parse_loc(line, args[0]);
+        in.value = parse_number(line, args[1]);
+    } else if (mnemonic == "jmp") {
+        in.op = PioInstr::Op::JMP;
+        // "jmp !osre bit" or "jmp packet"; the condition has no comma.
+        std::stringstream jmp_words(rest);
+        std::vector<std::string> jmp_tokens;
+        while (jmp_words >> token) jmp_tokens.push_back(token);
+        if (jmp_tokens.size() == 2) {
+            in.cond = parse_cond(line, jmp_tokens[0]);
+        } else if (jmp_tokens.size() != 1) {
+            fail(line, "bad jmp");
+        }
+        b.jumps.push_back({b.program.code.size(), jmp_tokens.back(), line});
+    } else {
+        fail(line, "unsupported instruction '" + mnemonic + "'");
+    }
+    return in;
+}
+
+} // namespace
+
+std::map<std::string, PioProgram> pio_assemble(const std::string& source) {
+    std::map<std::string, PioProgram> programs;
+    ProgramBuilder* current = nullptr;
+    ProgramBuilder builder;
+    bool in_code_block = false;
+
+    auto close_program = [&]() {
+        if (current) {
+            current->finish();
+            programs[current->program.name] = current->program;
+            current = nullptr;
+        }
+    };
+
+    std::stringstream lines(source);
+    std::string raw;
+    int line = 0;
+    while (std::getline(lines, raw)) {
+        ++line;
+        if (in_code_block) {
+            if (trim(raw) == "%}") in_code_block = false;
+            continue;
+        }
+        std::string text = trim(strip_comment(raw));
+        if (text.empty()) continue;
+        if (text[0] == '%') {
+            in_code_block = true;
+            continue;
+        }
+        if (text[0] == '.') {
+            std::stringstream words(text);
+            std::string directive;
+            words >> directive;
+            if (directive == ".program") {
+                close_program();
+                builder = ProgramBuilder();
+                words >> builder.program.name;
+                current = &builder;
+            } else if (directive == ".pio_version") {
+                // Only version 0 instructions are supported anyway.
+            } else if (!current) {
+                fail(line, directive + " outside a program");
+            } else if (directive == ".side_set") {
+                words >> current->sideset_bits;
+                std::string option;
+                while (words >> option) {
+                    if (option == "opt") current->sideset_optional = true;
+                    else fail(line, "unsupported side_set option '" + option + "'");
+                }
+            } else if (directive == ".wrap_target") {
+                current->program.wrap_target = (uint32_t)current->program.code.size();
+            } else if (directive == ".wrap") {
+                if (current->program.code.empty()) fail(line, ".wrap before any instruction");
+                current->program.wrap = (uint32_t)current->program.code.size() - 1;
+                current->has_wrap = true;
+            } else {
+                fail(line, "unsupported directive " + directive);
+            }
+            continue;
+        }
+        if (!current) fail(line, "instruction outside a program");
+
+        size_t colon = text.find(':');
+        if (colon != std::string::npos && text.compare(colon, 2, "::") != 0) {
+            std::string label = trim(text.substr(0, colon));
+            if (label.compare(0, 7, "public ") == 0) label = trim(label.substr(7));
+            current->labels[label] = (uint32_t)current->program.code.size();
+            text = trim(text.substr(colon + 1));
+            if (text.empty()) continue;
+        }
+        current->program.code.push_back(parse_instruction(*current, line, text));
+    }
+    close_program();
+    return programs;
+}
+
+std::map<std::string, PioProgram> pio_assemble_file(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error("cannot open " + path);
+    std::stringstream source;
+    source << file.rdbuf();
+    return pio_assemble(source.str());
+}
+
+void PioStateMachine::init(const PioProgram* program, const pio_sm_config& config) {
+    m_program = program;
+    m_config = config;
+    m_fifo.clear();
+    m_pc = 0;
+    m_osr = m_isr = m_x = m_y = 0;
+    m_osr_count = 32;
+    m_isr_count = 0;
+}
+
+void PioStateMachine::set_pin(uint pin, bool level) {
+    m_pins = (m_pins & ~(1u << pin)) | ((uint32_t)level << pin);
+}
+
+uint32_t PioStateMachine::read(PioInstr::Loc src) const {
+    switch (src) {
+        case Loc::X: return m_x;
+        case Loc::Y: return m_y;
+        case Loc::ISR: return m_isr;
+        case Loc::OSR: return m_osr;
+        case Loc::NUL: return 0;
+        default: throw std::runtime_error("unsupported source");
+    }
+}
+
+bool PioStateMachine::step() {
+    const PioInstr& in = m_program->code[m_pc];
+    const uint32_t threshold = m_config.pull_threshold;
+
+    if (in.side >= 0) {
+        bool was_high = (m_pins >> m_config.sideset_pin) & 1;
+        set_pin(m_config.sideset_pin, in.side & 1);
+        if (!was_high && (in.side & 1) && m_listener) m_listener(m_pins);
+    }
+
+    bool jumped = false;
+    switch (in.op) {
+        case PioInstr::Op::PULL:
+            if (m_fifo.empty()) return false;
+            m_osr = m_fifo.front();
+            m_fifo.pop_front();
+            m_osr_count = 0;
+            break;
+        case PioInstr::Op::OUT: {
+            if (m_config.autopull && m_osr_count >= threshold) {
+                if (m_fifo.empty()) return false;
+                m_osr = m_fifo.front();
+                m_fifo.pop_front();
+                m_osr_count = 0;
+            }
+            uint32_t n = in.value;
+            uint32_t data;
+            if (m_config.out_shift_right) {
+                data = n == 32 ? m_osr : m_osr & ((1u << n) - 1);
+                m_osr = n == 32 ? 0 : m_osr >> n;
+            } else {
+                data = n == 32 ? m_osr : m_osr >> (32 - n);
+                m_osr = n == 32 ? 0 : m_osr << n;
+            }
+            m_osr_count = std::min<uint32_t>(32, m_osr_count + n);
+            switch (in.dst) {
+                case Loc::PINS: set_pin(m_config.out_pin, data & 1); break;
+                case Loc::X: m_x = data; break;
+                case Loc::Y: m_y = data; break;
+                case Loc::ISR: m_isr = data; m_isr_count = n; break;
+                case Loc::NUL: break;
+                default: throw std::runtime_error("unsupported out destination");
+            }
+            break;
+        }
+        case PioInstr::Op::IN: {
+            uint32_t n = in.value;
+            uint32_t data = read(in.src);
+            if (n < 32) data &= (1u << n) - 1;
+            if (m_config.in_shift_right) {
+                m_isr = n == 32 ? data : (m_isr >> n) | (data << (32 - n));
+            } else {
+                m_isr = n == 32 ? data : (m_isr << n) | data;
+            }
+            m_isr_count = std::min<uint32_t>(32, m_isr_count + n);
+            break;
+        }
+        case PioInstr::Op::MOV: {
+            uint32_t v = read(in.src);
+            if (in.mov_op == PioInstr::MovOp::INVERT) v = ~v;
+            if (in.mov_op == PioInstr::MovOp::REVERSE) v = bit_reverse(v);
+            switch (in.dst) {
+                case Loc::PINS: set_pin(m_config.out_pin, v & 1); break;
+                case Loc::X: m_x = v; break;
+                case Loc::Y: m_y = v; break;
+                case Loc::ISR: m_isr = v; m_isr_count = 0; break;
+                case Loc::OSR: m_osr = v; m_osr_count = 0; break;
+                default: throw std::runtime_error("unsupported mov destination");
+            }
+            break;
+        }
+        case PioInstr::Op::SET:
+            switch (in.dst) {
+                case Loc::PINS: set_pin(m_config.set_pin, in.value & 1); break;
+                case Loc::X: m_x = in.value; break;
+                case Loc::Y: m_y = in.value; break;
+                default: throw std::runtime_error("unsupported set destination");
+            }
+            break;
+        case PioInstr::Op::JMP: {
+            bool take = false;
+            switch (in.cond) {
+                case Cond::ALWAYS: take = true; break;
+                case Cond::NOT_X: take = m_x == 0; break;
+                case Cond::X_DEC: take = m_x != 0; m_x--; break;
+                case Cond::NOT_Y: take = m_y == 0; break;
+                case Cond::Y_DEC: take = m_y != 0; m_y--; break;
+                case Cond::X_NE_Y: take = m_x != m_y; break;
+                case Cond::NOT_OSRE: take = m_osr_count < threshold; break;
+            }
+            if (take) {
+                m_pc = in.value;
+                jumped = true;
+            }
+            break;
+        }
+    }
+
+    m_cycles += 1 + in.delay;
+    if (!jumped) {
+        m_pc = (m_pc == m_program->wrap) ? m_program->wrap_target : m_pc + 1;
+    }
+    return true;
+}
+
+bool PioStateMachine::run(uint64_t max_cycles) {
+    if (!m_program) return true;
+    uint64_t start = m_cycles;
+    while (step()) {
+        if (m_cycles - start > max_cycles) return false;
+    }
+    return true;
+}
@@ -0,0 +1,86 @@
+// File: tests/mock/PioSim.h
+
+#ifndef PIO_SIM_H
+#define PIO_SIM_H
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+#include "hardware/pio.h"
+
+// Assembles .pio source text and runs it one instruction per cycle, so the
+// display's PIO programs are tested as written rather than from a listing.
+// Covers the instructions and options the display programs use: JMP (all
+// conditions), IN, OUT, PULL, MOV (with ! and :: operators), SET and NOP,
+// side-set, delays, wrap, autopull and the shift directions and thresholds.
+
+struct PioInstr {
+    enum class Op { JMP, IN, OUT, PULL, MOV, SET };
+    enum class Loc { PINS, X, Y, NUL, ISR, OSR, PC };
+    enum class Cond { ALWAYS, NOT_X, X_DEC, NOT_Y, Y_DEC, X_NE_Y, NOT_OSRE };
+    enum class MovOp { NONE, INVERT, REVERSE };
+
+    Op op = Op::MOV;
+    Cond cond = Cond::ALWAYS;
+    Loc dst = Loc::NUL;    // OUT/MOV/SET destination
+    Loc src = Loc::NUL;    // IN/MOV source
+    MovOp mov_op = MovOp::NONE;
+    uint32_t value = 0;    // Bit count (IN/OUT), SET data, JMP target
+    int side = -1;         // Side-set value, -1 if none
+    uint32_t delay = 0;
+    int line = 0;
+};
+
+struct PioProgram {
+    std::string name;
+    std::vector<PioInstr> code;
+    uint32_t wrap_target = 0;
+    uint32_t wrap = 0;
+};
+
+// Parses every .program in the file. Throws std::runtime_error with the line
+// number on anything it does not understand.
+std::map<std::string, PioProgram> pio_assemble_file(const std::string& path);
+std::map<std::string, PioProgram> pio_assemble(const std::string& source);
+
+class PioStateMachine {
+public:
+    // Called for every instruction that raises the side-set pin, with the
+    // pin levels the state machine drives at that moment.
+    using ClockListener = std::function<void(uint32_t pins)>;
+
+    // Restarts the state machine as pio_sm_init does: empty FIFO, empty OSR,
+    // cleared ISR and scratch registers, PC at the start of the program.
+    void init(const PioProgram* program, const pio_sm_config& config);
+    void setListener(ClockListener listener) { m_listener = std::move(listener); }
+
+    void push(uint32_t word) { m_fifo.push_back(word); }
+    // Runs until the state machine stalls on an empty FIFO. Returns false if
+    // it is still running after max_cycles.
+    bool run(uint64_t max_cycles);
+
+    uint64_t cycles() const { return m_cycles; }
+    uint32_t pins() const { return m_pins; }
+    bool isLoaded() const { return m_program != nullptr; }
+
+private:
+    // False if the instruction stalled.
+    bool step();
+    void set_pin(uint pin, bool level);
+    uint32_t read(PioInstr::Loc src) const;
+
+    const PioProgram* m_program = nullptr;
+    pio_sm_config m_config{};
+    ClockListener m_listener;
+    std::deque<uint32_t> m_fifo;
+    uint32_t m_pc = 0;
+    uint32_t m_osr = 0, m_isr = 0, m_x = 0, m_y = 0;
+    uint32_t m_osr_count = 32, m_isr_count = 0;
+    uint32_t m_pins = 0;
+    uint64_t m_cycles = 0;
+};
+
+#endif // PIO_SIM_H
@@ -0,0 +1,93 @@
+// File: tests/mock/St7789Model.cpp
+
+#include "St7789Model.h"
+
+namespace {
+constexpr uint8_t CASET = 0x2A;
+constexpr uint8_t RASET = 0x2B;
+constexpr uint8_t RAMWR = 0x2C;
+}
+
+St7789Model::St7789Model() : m_memory(MEMORY_WIDTH * MEMORY_HEIGHT, 0) {}
+
+void St7789Model::setChipSelect(bool high) {
+    if (high && !m_cs_high && m_bits != 0) {
+        m_framing_errors++;
+    }
+    if (high) {
+        m_bits = 0;
+        m_shift = 0;
+    }
+    m_cs_high = high;
+}
+
+void St7789Model::clock(bool data, bool dc) {
+    if (m_cs_high) return;
+    m_shift = (uint8_t)((m_shift << 1) | (data ? 1 : 0));
+    if (++m_bits == 8) {
+        byte(m_shift, dc);
+        m_bits = 0;
+        m_shift = 0;
+    }
+}
+
+void St7789Model::byte(uint8_t value, bool dc) {
+    if (!dc) {
+        m_commands.push_back({value, {}, 0});
+        m_have_high = false;
+        if (value == RAMWR) {
+            m_cx = m_x_start;
+            m_cy = m_y_start;
+        }
+        return;
+    }
+    if (m_commands.empty()) {
+        m_framing_errors++;
+        return;
+    }
+    Command& cmd = m_commands.back();
+    uint32_t index = cmd.data_bytes++;
+    if (cmd.params.size() < 8) cmd.params.push_back(value);
+
+    if (cmd.opcode == CASET || cmd.opcode == RASET) {
+        if (index >= 4) return;
+        uint16_t& start = cmd.opcode == CASET ? m_x_start : m_y_start;
+        uint16_t& end = cmd.opcode == CASET ? m_x_end : m_y_end;
+        switch (index) {
+            case 0: start = (uint16_t)((start & 0x00ff) | (value << 8)); break;
+            case 1: start = (uint16_t)((start & 0xff00) | value); break;
+            case 2: end = (uint16_t)((end & 0x00ff) | (value << 8)); break;
+            case 3: end = (uint16_t)((end & 0xff00) | value); break;
+        }
+    } else if (cmd.opcode == RAMWR) {
+        if (!m_have_high) {
+            m_pixel_high = value;
+            m_have_high = true;
+            return;
+        }
+        m_have_high = false;
+        if (m_cx < MEMORY_WIDTH && m_cy < MEMORY_HEIGHT) {
+            m_memory[m_cy * MEMORY_WIDTH + m_cx] = (uint16_t)((m_pixel_high << 8) | value);
+        }
+        m_pixels_written++;
+        // The address counter wraps inside the window, as on the panel.
+        if (m_cx++ >= m_x_end) {
+            m_cx = m_x_start;
+            if (m_cy++ >= m_y_end) m_cy = m_y_start;
+        }
+    }
+}
+
+int St7789Model::windows() const {
+    int n = 0;
+    for (const Command& c : m_commands) {
+        if (c.opcode == RAMWR) n++;
+    }
+    return n;
+}
+
+void St7789Model::clearLog() {
+    m_commands.clear();
+    m_pixels_written = 0;
+    m_framing_errors = 0;
+}
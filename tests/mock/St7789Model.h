@@ -0,0 +1,55 @@
+// File: tests/mock/St7789Model.h
+
+#ifndef ST7789_MODEL_H
+#define ST7789_MODEL_H
+
+#include <cstdint>
+#include <vector>
+
+// The panel side of the serial bus: bits are sampled on the rising clock edge
+// while CS is low, DC is sampled with the last bit of each byte, and raising
+// CS discards a partial byte. Decodes CASET/RASET/RAMWR into frame memory
+// (RGB565, high byte first) and logs every command with its parameters.
+class St7789Model {
+public:
+    static constexpr int MEMORY_WIDTH = 320;
+    static constexpr int MEMORY_HEIGHT = 320;
+
+    struct Command {
+        uint8_t opcode;
+        std::vector<uint8_t> params; // First 8 data bytes only
+        uint32_t data_bytes;
+    };
+
+    St7789Model();
+
+    void clock(bool data, bool dc);
+    void setChipSelect(bool high);
+
+    uint16_t pixel(int x, int y) const { return m_memory[y * MEMORY_WIDTH + x]; }
+    const std::vector<Command>& commands() const { return m_commands; }
+    // Number of RAMWR commands, i.e. windows opened.
+    int windows() const;
+    uint64_t pixelsWritten() const { return m_pixels_written; }
+    // Partial bytes cut off by CS and data bytes before any command.
+    int framingErrors() const { return m_framing_errors; }
+    void clearLog();
+
+private:
+    void byte(uint8_t value, bool dc);
+
+    std::vector<uint16_t> m_memory;
+    std::vector<Command> m_commands;
+    bool m_cs_high = true;
+    uint8_t m_shift = 0;
+    int m_bits = 0;
+    uint16_t m_x_start = 0, m_x_end = MEMORY_WIDTH - 1;
+    uint16_t m_y_start = 0, m_y_end = MEMORY_HEIGHT - 1;
+    uint16_t m_cx = 0, m_cy = 0;
+    uint8_t m_pixel_high = 0;
+    bool m_have_high = false;
+    uint64_t m_pixels_written = 0;
+    int m_framing_errors = 0;
+};
+
+#endif // ST7789_MODEL_H
@@ -0,0 +1,49 @@
+// File: tests/mock/hardware/dma.h
+
+#ifndef MOCK_HARDWARE_DMA_H
+#define MOCK_HARDWARE_DMA_H
+
+#include "pico/stdlib.h"
+
+enum dma_channel_transfer_size {
+    DMA_SIZE_8 = 0,
+    DMA_SIZE_16 = 1,
+    DMA_SIZE_32 = 2
+};
+
+typedef struct {
+    bool read_increment;
+    bool write_increment;
+    dma_channel_transfer_size data_size;
+    uint chain_to; // Itself for no chaining
+    uint dreq;
+} dma_channel_config;
+
+typedef struct {
+    volatile uint32_t read_addr;
+    volatile uint32_t write_addr;
+    volatile uint32_t transfer_count;
+    volatile uint32_t ctrl_trig;
+} dma_channel_hw_t;
+
+int dma_claim_unused_channel(bool required);
+dma_channel_config dma_channel_get_default_config(uint channel);
+dma_channel_config dma_get_channel_config(uint channel);
+static inline void channel_config_set_transfer_data_size(dma_channel_config* c, dma_channel_transfer_size size) { c->data_size = size; }
+static inline void channel_config_set_read_increment(dma_channel_config* c, bool incr) { c->read_increment = incr; }
+static inline void channel_config_set_write_increment(dma_channel_config* c, bool incr) { c->write_increment = incr; }
+static inline void channel_config_set_dreq(dma_channel_config* c, uint dreq) { c->dreq = dreq; }
+static inline void channel_config_set_chain_to(dma_channel_config* c, uint chain_to) { c->chain_to = chain_to; }
+void dma_channel_set_config(uint channel, const dma_channel_config* config, bool trigger);
+void dma_channel_configure(uint channel, const dma_channel_config* config, volatile void* write_addr,
+                           const volatile void* read_addr, uint transfer_count, bool trigger);
+void dma_channel_set_read_addr(uint channel, const volatile void* read_addr, bool trigger);
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger);
+bool dma_channel_is_busy(uint channel);
+void dma_channel_wait_for_finish_blocking(uint channel);
+dma_channel_hw_t* dma_channel_hw_addr(uint channel);
+void dma_channel_set_irq1_enabled(uint channel, bool enabled);
+bool dma_channel_get_irq1_status(uint channel);
+void dma_channel_acknowledge_irq1(uint channel);
+
+#endif // MOCK_HARDWARE_DMA_H
@@ -0,0 +1,18 @@
+// File: tests/mock/hardware/gpio.h
+
+#ifndef MOCK_HARDWARE_GPIO_H
+#define MOCK_HARDWARE_GPIO_H
+
+#include "pico/stdlib.h"
+
+#define GPIO_OUT true
+#define GPIO_IN false
+
+void gpio_init(uint pin);
+void gpio_init_mask(uint32_t mask);
+void gpio_set_dir(uint pin, bool out);
+void gpio_set_dir_out_masked(uint32_t mask);
+void gpio_put(uint pin, bool value);
+void gpio_put_masked(uint32_t mask, uint32_t value);
+
+#endif // MOCK_HARDWARE_GPIO_H
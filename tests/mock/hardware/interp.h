@@ -0,0 +1,37 @@
+// File: tests/mock/hardware/interp.h
+
+#ifndef MOCK_HARDWARE_INTERP_H
+#define MOCK_HARDWARE_INTERP_H
+
+#include "pico/stdlib.h"
+
+// interp0 lanes as far as the palette path uses them: shift, mask, cross
+// input and the base add, with POP writing both results back to the
+// accumulators. Bases and results are pointer sized so the addresses the
+// firmware builds are valid on a 64-bit host.
+struct interp_pop_reg {
+    operator uintptr_t();
+};
+
+typedef struct {
+    uint shift;
+    uint mask_lsb, mask_msb;
+    bool cross_input;
+} interp_config;
+
+typedef struct {
+    uintptr_t accum[2];
+    uintptr_t base[3];
+    interp_pop_reg pop[3];
+    interp_config ctrl[2];
+} interp_hw_t;
+
+extern interp_hw_t* interp0;
+
+interp_config interp_default_config();
+void interp_config_set_shift(interp_config* c, uint shift);
+void interp_config_set_mask(interp_config* c, uint lsb, uint msb);
+void interp_config_set_cross_input(interp_config* c, bool cross_input);
+void interp_set_config(interp_hw_t* interp, uint lane, interp_config* config);
+
+#endif // MOCK_HARDWARE_INTERP_H
@@ -0,0 +1,84 @@
+// File: tests/mock/hardware/pio.h
+
+#ifndef MOCK_HARDWARE_PIO_H
+#define MOCK_HARDWARE_PIO_H
+
+#include "pico/stdlib.h"
+
+// Programs are identified by name; PioSim assembles them from the .pio source.
+typedef struct {
+    const char* name;
+} pio_program_t;
+
+typedef struct {
+    const pio_program_t* program;
+    uint out_pin, set_pin, sideset_pin;
+    bool out_shift_right, autopull;
+    uint pull_threshold;
+    bool in_shift_right, autopush;
+    uint push_threshold;
+    float clkdiv;
+} pio_sm_config;
+
+#define PIO_FIFO_JOIN_TX 1
+#define PIO_FDEBUG_TXSTALL_LSB 24
+
+// TX FIFO register. DMA is handed its address as a write target; a CPU byte
+// write (*(volatile uint8_t*)&txf[sm] = x, as in the .pio helpers) lands in
+// 'bytes' and is pushed to the FIFO by the next mock call.
+struct pio_txf_reg {
+    struct address {
+        pio_txf_reg* reg;
+        operator volatile void*() const { return reg; }
+        operator volatile uint8_t*() const;
+    };
+    address operator&() { return {this}; }
+    uint8_t bytes[4];
+};
+
+// FDEBUG. Writes clear flags; TXSTALL reads as set unless the state machine
+// is held with words still to run (see mock::holdPio).
+struct pio_fdebug_reg {
+    void operator=(uint32_t value);
+    operator uint32_t() const;
+};
+
+struct pio_hw_t {
+    pio_txf_reg txf[4];
+    pio_fdebug_reg fdebug;
+};
+
+typedef pio_hw_t* PIO;
+
+extern pio_hw_t mock_pio_instances[2];
+#define pio0 (&mock_pio_instances[0])
+#define pio1 (&mock_pio_instances[1])
+
+pio_sm_config pio_get_default_sm_config();
+static inline void sm_config_set_sideset_pins(pio_sm_config* c, uint pin) { c->sideset_pin = pin; }
+static inline void sm_config_set_out_pins(pio_sm_config* c, uint base, uint count) { (void)count; c->out_pin = base; }
+static inline void sm_config_set_set_pins(pio_sm_config* c, uint base, uint count) { (void)count; c->set_pin = base; }
+static inline void sm_config_set_fifo_join(pio_sm_config* c, int join) { (void)c; (void)join; }
+static inline void sm_config_set_clkdiv(pio_sm_config* c, float div) { c->clkdiv = div; }
+static inline void sm_config_set_out_shift(pio_sm_config* c, bool shift_right, bool autopull, uint threshold) {
+    c->out_shift_right = shift_right;
+    c->autopull = autopull;
+    c->pull_threshold = threshold;
+}
+static inline void sm_config_set_in_shift(pio_sm_config* c, bool shift_right, bool autopush, uint threshold) {
+    c->in_shift_right = shift_right;
+    c->autopush = autopush;
+    c->push_threshold = threshold;
+}
+
+uint pio_add_program(PIO pio, const pio_program_t* program);
+void pio_remove_program(PIO pio, const pio_program_t* program, uint offset);
+int pio_claim_unused_sm(PIO pio, bool required);
+void pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config* config);
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled);
+void pio_gpio_init(PIO pio, uint pin);
+void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin, uint count, bool is_out);
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm);
+uint pio_get_dreq(PIO pio, uint sm, bool is_tx);
+
+#endif // MOCK_HARDWARE_PIO_H
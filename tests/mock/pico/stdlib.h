@@ -0,0 +1,21 @@
+// File: tests/mock/pico/stdlib.h
+
+#ifndef MOCK_PICO_STDLIB_H
+#define MOCK_PICO_STDLIB_H
+
+// Host stand-in for the parts of the Pico SDK the display code uses. Time
+// only moves when the code under test waits, so runs are deterministic.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+typedef unsigned int uint;
+
+uint32_t time_us_32();
+uint64_t time_us_64();
+void sleep_ms(uint32_t ms);
+void busy_wait_us_32(uint32_t us);
+void tight_loop_contents();
+
+#endif // MOCK_PICO_STDLIB_H
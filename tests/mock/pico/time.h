@@ -0,0 +1,8 @@
+// File: tests/mock/pico/time.h
+
+#ifndef MOCK_PICO_TIME_H
+#define MOCK_PICO_TIME_H
+
+#include "pico/stdlib.h"
+
+#endif // MOCK_PICO_TIME_H
@@ -0,0 +1,352 @@
+// File: tests/test_display.cpp
+//
+// St7789Display against the mocked DMA and PIO: which transfers are started
+// in which order, what reaches the FIFO, and what the panel ends up showing.
+
+#include "TestHarness.h"
+#include "MockHardware.h"
+#include "Display.h"
+#include "config.h"
+#include <vector>
+
+namespace {
+
+constexpr uint PIXEL_CHANNEL = 0;  // Claimed first by init_dma
+constexpr uint PACKET_CHANNEL = 1;
+
+struct Fixture {
+    St7789Display display{pio0, DISPLAY_PIN_SDA, DISPLAY_PIN_SCL, DISPLAY_PIN_CS,
+                          DISPLAY_PIN_DC, DISPLAY_PIN_RESET, DisplayOrientation::LANDSCAPE};
+    int completions = 0;
+
+    explicit Fixture(PixelTransferMode mode) {
+        mock::reset();
+        mock::attachPanel(DISPLAY_PIN_SDA, DISPLAY_PIN_SCL, DISPLAY_PIN_CS, DISPLAY_PIN_DC);
+        display.init();
+        display.setPixelTransferMode(mode);
+        display.setTransferCompleteCallback([](void* ctx) { static_cast<Fixture*>(ctx)->completions++; }, this);
+        mock::clearLogs();
+    }
+};
+
+std::vector<uint16_t> pattern(size_t count, uint16_t seed) {
+    std::vector<uint16_t> pixels(count);
+    for (size_t i = 0; i < count; ++i) {
+        pixels[i] = (uint16_t)(seed + i * 0x0101 + (i >> 8));
+    }
+    return pixels;
+}
+
+bool window_shows(int x, int y, int w, int h, const uint16_t* pixels) {
+    for (int row = 0; row < h; ++row) {
+        for (int col = 0; col < w; ++col) {
+            if (mock::panel().pixel(x + col, y + row) != pixels[row * w + col]) return false;
+        }
+    }
+    return true;
+}
+
+bool window_filled(int x, int y, int w, int h, uint16_t color) {
+    for (int row = 0; row < h; ++row) {
+        for (int col = 0; col < w; ++col) {
+            if (mock::panel().pixel(x + col, y + row) != color) return false;
+        }
+    }
+    return true;
+}
+
+// The 16-bit units the DMA channels wrote to the FIFO, in order.
+std::vector<uint32_t> dma_units() {
+    std::vector<uint32_t> units;
+    for (const mock::FifoWrite& w : mock::fifoWrites()) {
+        if (w.from_dma) units.push_back(w.value);
+    }
+    return units;
+}
+
+// Window setup and count tag, as build_window_packets lays them out.
+std::vector<uint32_t> window_packets(uint16_t x, uint16_t y, uint16_t w, uint16_t h, bool repeat) {
+    uint32_t last = (uint32_t)w * h - 1;
+    return {0x2A, 0x8000, 1, x, (uint32_t)(x + w - 1),
+            0x2B, 0x8000, 1, y, (uint32_t)(y + h - 1),
+            0x2C, 0x8000u | (repeat ? 0x4000u : 0u) | (last >> 16), last & 0xffff};
+}
+
+} // namespace
+
+TEST(init_sends_the_panel_setup_sequence) {
+    mock::reset();
+    mock::attachPanel(DISPLAY_PIN_SDA, DISPLAY_PIN_SCL, DISPLAY_PIN_CS, DISPLAY_PIN_DC);
+    St7789Display display(pio0, DISPLAY_PIN_SDA, DISPLAY_PIN_SCL, DISPLAY_PIN_CS, DISPLAY_PIN_DC,
+                          DISPLAY_PIN_RESET, DisplayOrientation::LANDSCAPE);
+    display.init();
+
+    const auto& cmds = mock::panel().commands();
+    const uint8_t expected[] = {0x01, 0x11, 0x3a, 0x36, 0x2a, 0x2b, 0x21, 0x13, 0x29, 0x36, 0x2a, 0x2b};
+    CHECK_EQ(cmds.size(), sizeof(expected));
+    for (size_t i = 0; i < cmds.size() && i < sizeof(expected); ++i) {
+        CHECK_EQ(cmds[i].opcode, expected[i]);
+    }
+    CHECK(cmds.size() > 11 && cmds[2].params == std::vector<uint8_t>({0x55}));
+    CHECK(cmds.size() > 11 && cmds[9].params == std::vector<uint8_t>({0x60}));
+    CHECK(cmds.size() > 11 && cmds[10].params == std::vector<uint8_t>({0, 0, 0x01, 0x3f}));
+    CHECK(cmds.size() > 11 && cmds[11].params == std::vector<uint8_t>({0, 0, 0, 0xef}));
+    CHECK_EQ(mock::panel().framingErrors(), 0);
+    CHECK(mock::gpioLevel(DISPLAY_PIN_CS));
+    CHECK(!mock::stateMachineHung());
+}
+
+TEST(packed16_draw_sets_window_then_streams_pixels) {
+    Fixture f(PixelTransferMode::PACKED_16);
+    auto pixels = pattern(7 * 5, 0x1234);
+    CHECK(f.display.drawBufferAsync(30, 40, 7, 5, pixels.data()));
+    f.display.waitForIdle();
+
+    const auto& runs = mock::dmaRuns();
+    CHECK_EQ(runs.size(), 1);
+    CHECK(runs.size() == 1 && runs[0].channel == PIXEL_CHANNEL && runs[0].count == 35 &&
+          runs[0].size == DMA_SIZE_16 && runs[0].read_increment);
+    const auto& cmds = mock::panel().commands();
+    CHECK_EQ(cmds.size(), 3);
+    CHECK(cmds.size() == 3 && cmds[0].opcode == 0x2a && cmds[0].params == std::vector<uint8_t>({0, 30, 0, 36}));
+    CHECK(cmds.size() == 3 && cmds[1].opcode == 0x2b && cmds[1].params == std::vector<uint8_t>({0, 40, 0, 44}));
+    CHECK(cmds.size() == 3 && cmds[2].opcode == 0x2c && cmds[2].data_bytes == 70);
+    CHECK(window_shows(30, 40, 7, 5, pixels.data()));
+    CHECK_EQ(f.completions, 1);
+    CHECK(mock::gpioLevel(DISPLAY_PIN_CS));
+    CHECK_EQ(mock::panel().framingErrors(), 0);
+}
+
+TEST(packed32_moves_two_pixels_per_word) {
+    Fixture f(PixelTransferMode::PACKED_32);
+    alignas(4) uint16_t pixels[8 * 4];
+    auto src = pattern(8 * 4, 0xa55a);
+    std::copy(src.begin(), src.end(), pixels);
+    CHECK(f.display.drawBufferAsync(100, 10, 8, 4, pixels));
+    f.display.waitForIdle();
+
+    const auto& runs = mock::dmaRuns();
+    CHECK(runs.size() == 1 && runs[0].count == 16 && runs[0].size == DMA_SIZE_32);
+    CHECK(window_shows(100, 10, 8, 4, pixels));
+    CHECK_EQ(mock::panel().pixelsWritten(), 32);
+}
+
+TEST(packed32_falls_back_for_odd_counts_and_fills_either_way) {
+    Fixture f(PixelTransferMode::PACKED_32);
+    auto pixels = pattern(3 * 3, 0x0f0f);
+    f.display.drawBuffer(0, 0, 3, 3, pixels.data());
+    CHECK(mock::dmaRuns().size() == 1 && mock::dmaRuns()[0].size == DMA_SIZE_16 && mock::dmaRuns()[0].count == 9);
+    CHECK(window_shows(0, 0, 3, 3, pixels.data()));
+
+    mock::clearLogs();
+    f.display.drawBuffer(50, 60, 10, 2, nullptr, 0xf81f);
+    CHECK(mock::dmaRuns().size() == 1 && mock::dmaRuns()[0].size == DMA_SIZE_32 &&
+          mock::dmaRuns()[0].count == 10 && !mock::dmaRuns()[0].read_increment);
+    CHECK(window_filled(50, 60, 10, 2, 0xf81f));
+}
+
+TEST(framed_draw_is_one_packet_chain_then_pixels) {
+    Fixture f(PixelTransferMode::FRAMED);
+    auto pixels = pattern(4 * 3, 0x4321);
+    CHECK(f.display.drawBufferAsync(10, 20, 4, 3, pixels.data()));
+    f.display.waitForIdle();
+
+    const auto& runs = mock::dmaRuns();
+    CHECK_EQ(runs.size(), 2);
+    CHECK(runs.size() == 2 && runs[0].channel == PACKET_CHANNEL && runs[0].count == 13);
+    CHECK(runs.size() == 2 && runs[1].channel == PIXEL_CHANNEL && runs[1].count == 12);
+
+    std::vector<uint32_t> expected = window_packets(10, 20, 4, 3, false);
+    expected.insert(expected.end(), pixels.begin(), pixels.end());
+    CHECK(dma_units() == expected);
+    // No CPU byte writes at all in FRAMED mode.
+    CHECK_EQ(mock::fifoWrites().size(), expected.size());
+
+    CHECK_EQ(mock::panel().windows(), 1);
+    CHECK(window_shows(10, 20, 4, 3, pixels.data()));
+    CHECK_EQ(f.completions, 1);
+    CHECK(mock::gpioLevel(DISPLAY_PIN_CS));
+    CHECK_EQ(mock::panel().framingErrors(), 0);
+}
+
+TEST(framed_fill_is_a_single_repeat_packet) {
+    Fixture f(PixelTransferMode::FRAMED);
+    CHECK(f.display.drawBufferAsync(200, 100, 50, 30, nullptr, 0x07e0));
+    f.display.waitForIdle();
+
+    const auto& runs = mock::dmaRuns();
+    CHECK(runs.size() == 1 && runs[0].channel == PACKET_CHANNEL && runs[0].count == 14);
+    std::vector<uint32_t> expected = window_packets(200, 100, 50, 30, true);
+    expected.push_back(0x07e0);
+    CHECK(dma_units() == expected);
+    CHECK_EQ(mock::panel().pixelsWritten(), 1500);
+    CHECK(window_filled(200, 100, 50, 30, 0x07e0));
+    CHECK_EQ(f.completions, 1);
+}
+
+TEST(framed_count_encoding_one_pixel) {
+    Fixture f(PixelTransferMode::FRAMED);
+    uint16_t pixel = 0xbeef;
+    f.display.drawBuffer(319, 239, 1, 1, &pixel);
+    std::vector<uint32_t> units = dma_units();
+    CHECK(units.size() == 14 && units[11] == 0x8000 && units[12] == 0);
+    CHECK_EQ(mock::panel().pixel(319, 239), 0xbeef);
+    CHECK_EQ(mock::panel().pixelsWritten(), 1);
+}
+
+TEST(framed_count_encoding_65536_pixels) {
+    Fixture f(PixelTransferMode::FRAMED);
+    // count - 1 = 0xffff: the largest count that still fits the low unit.
+    auto pixels = pattern(256 * 256, 0x0001);
+    f.display.drawBuffer(0, 0, 256, 256, pixels.data());
+    std::vector<uint32_t> units = dma_units();
+    CHECK(units.size() == 13 + 65536 && units[11] == 0x8000 && units[12] == 0xffff);
+    CHECK_EQ(mock::panel().pixelsWritten(), 65536);
+    CHECK(window_shows(0, 0, 256, 256, pixels.data()));
+
+    mock::clearLogs();
+    f.display.drawBuffer(0, 0, 256, 256, nullptr, 0x1234);
+    units = dma_units();
+    CHECK(units.size() == 14 && units[11] == 0xc000 && units[12] == 0xffff);
+    CHECK_EQ(mock::panel().pixelsWritten(), 65536);
+    CHECK(window_filled(0, 0, 256, 256, 0x1234));
+}
+
+TEST(framed_count_encoding_above_16_bits) {
+    Fixture f(PixelTransferMode::FRAMED);
+    // 272 * 241 = 65552 pixels, count - 1 = 0x1000f: bit 16 moves into the tag.
+    auto pixels = pattern(272 * 241, 0x2222);
+    f.display.drawBuffer(0, 0, 272, 241, pixels.data());
+    std::vector<uint32_t> units = dma_units();
+    CHECK(units.size() == 13 + 65552 && units[11] == 0x8001 && units[12] == 0x000f);
+    CHECK_EQ(mock::panel().pixelsWritten(), 65552);
+    CHECK(window_shows(0, 0, 272, 241, pixels.data()));
+
+    mock::clearLogs();
+    f.display.fillScreen(0xffff);
+    units = dma_units();
+    CHECK(units.size() == 14 && units[11] == (0xc000 | (76799 >> 16)) && units[12] == (76799 & 0xffff));
+    CHECK_EQ(mock::panel().pixelsWritten(), 76800);
+    CHECK(window_filled(0, 0, 320, 240, 0xffff));
+    CHECK(!mock::stateMachineHung());
+}
+
+TEST(framed_pixel_channel_waits_for_the_packet_chain) {
+    Fixture f(PixelTransferMode::FRAMED);
+    auto pixels = pattern(6, 0x5555);
+    mock::holdDma(true);
+    CHECK(f.display.drawBufferAsync(0, 0, 3, 2, pixels.data()));
+    CHECK(f.display.isBusy());
+    // Configured but not triggered: the count stays loaded until the chain.
+    CHECK_EQ(dma_channel_hw_addr(PIXEL_CHANNEL)->transfer_count, 6);
+    CHECK(!f.display.drawBufferAsync(0, 0, 3, 2, pixels.data()));
+    CHECK(!mock::gpioLevel(DISPLAY_PIN_CS));
+
+    mock::releaseDma();
+    const auto& runs = mock::dmaRuns();
+    CHECK(runs.size() == 2 && runs[0].channel == PACKET_CHANNEL && runs[1].channel == PIXEL_CHANNEL);
+    CHECK_EQ(f.completions, 1);
+    CHECK(!f.display.isBusy());
+    CHECK(mock::gpioLevel(DISPLAY_PIN_CS));
+    CHECK(window_shows(0, 0, 3, 2, pixels.data()));
+}
+
+TEST(streamed_window_matches_single_transfer) {
+    const PixelTransferMode modes[] = {PixelTransferMode::PACKED_16, PixelTransferMode::FRAMED};
+    for (PixelTransferMode mode : modes) {
+        Fixture f(mode);
+        auto pixels = pattern(20 * 9, 0x7777);
+        f.display.beginWrite(5, 6, 20, 9);
+        CHECK(f.display.isBusy());
+        for (size_t i = 0; i < pixels.size(); i += 40) {
+            f.display.writePixels(pixels.data() + i, (uint32_t)std::min<size_t>(40, pixels.size() - i));
+        }
+        f.display.endWrite();
+        CHECK(!f.display.isBusy());
+        CHECK_EQ(mock::panel().windows(), 1);
+        CHECK(window_shows(5, 6, 20, 9, pixels.data()));
+        CHECK(mock::gpioLevel(DISPLAY_PIN_CS));
+        CHECK_EQ(mock::panel().framingErrors(), 0);
+    }
+}
+
+TEST(switching_out_of_framed_hands_dc_back_to_the_cpu) {
+    Fixture f(PixelTransferMode::FRAMED);
+    f.display.fillScreen(0x0000);
+    f.display.setPixelTransferMode(PixelTransferMode::PACKED_16);
+    mock::clearLogs();
+    auto pixels = pattern(4, 0x9999);
+    f.display.drawBuffer(1, 1, 2, 2, pixels.data());
+    const auto& cmds = mock::panel().commands();
+    CHECK(cmds.size() == 3 && cmds[0].opcode == 0x2a && cmds[2].opcode == 0x2c);
+    CHECK(window_shows(1, 1, 2, 2, pixels.data()));
+    CHECK_EQ(mock::panel().framingErrors(), 0);
+}
+
+// The packet DMA of a fill is done after 14 units; the state machine then
+// repeats the colour on its own. isBusy() must say so rather than wait for it.
+TEST(framed_fill_stays_busy_until_the_state_machine_is_done) {
+    Fixture f(PixelTransferMode::FRAMED);
+    mock::holdPio(true);
+    CHECK(f.display.drawBufferAsync(0, 0, 320, 240, nullptr, 0x001f));
+    CHECK_EQ(f.completions, 1); // The packet channel has finished
+
+    uint64_t start = mock::stateMachine(pio0, 0).cycles();
+    for (int i = 0; i < 3; ++i) {
+        CHECK(f.display.isBusy());
+    }
+    // One FDEBUG read per call, no spinning on TXSTALL.
+    CHECK(mock::stallPolls() <= 3);
+    CHECK(mock::stateMachine(pio0, 0).cycles() - start < 34 * 320 * 240 / 100);
+    CHECK(!mock::gpioLevel(DISPLAY_PIN_CS));
+    CHECK(mock::panel().pixelsWritten() < 320 * 240);
+
+    mock::releasePio();
+    CHECK(!f.display.isBusy());
+    CHECK(mock::gpioLevel(DISPLAY_PIN_CS));
+    CHECK_EQ(mock::panel().pixelsWritten(), 320 * 240);
+    CHECK(window_filled(0, 0, 320, 240, 0x001f));
+
+    // waitForIdle still blocks until the last pixel is out.
+    mock::holdPio(true);
+    CHECK(f.display.drawBufferAsync(0, 0, 320, 240, nullptr, 0xf800));
+    f.display.waitForIdle();
+    CHECK(!f.display.isBusy());
+    CHECK(window_filled(0, 0, 320, 240, 0xf800));
+    CHECK(mock::gpioLevel(DISPLAY_PIN_CS));
+    CHECK_EQ(mock::panel().framingErrors(), 0);
+}
+
+TEST(empty_windows_are_rejected_in_every_mode) {
+    const PixelTransferMode modes[] = {PixelTransferMode::PACKED_16, PixelTransferMode::PACKED_32,
+                                       PixelTransferMode::FRAMED};
+    for (PixelTransferMode mode : modes) {
+        Fixture f(mode);
+        // count - 1 would underflow to a ~2^30 unit framed packet.
+        mock::setCycleBudget(1u << 20);
+        uint16_t pixel = 0xffff;
+        CHECK(!f.display.drawBufferAsync(10, 10, 0, 5, &pixel));
+        CHECK(!f.display.drawBufferAsync(10, 10, 5, 0, &pixel));
+        CHECK(!f.display.drawBufferAsync(10, 10, 0, 0, nullptr, 0xffff));
+        f.display.drawBuffer(10, 10, 0, 1, nullptr, 0xffff);
+        f.display.beginWrite(10, 10, 4, 0);
+        CHECK(!f.display.isBusy());
+        f.display.endWrite();
+
+        CHECK(mock::dmaRuns().empty());
+        CHECK(mock::fifoWrites().empty());
+        CHECK(!mock::stateMachineHung());
+        CHECK(!f.display.isBusy());
+        CHECK(mock::gpioLevel(DISPLAY_PIN_CS));
+        CHECK_EQ(f.completions, 0);
+
+        // And the display is still usable afterwards.
+        f.display.drawBuffer(10, 10, 1, 1, &pixel);
+        CHECK_EQ(mock::panel().pixel(10, 10), 0xffff);
+        CHECK_EQ(mock::panel().framingErrors(), 0);
+    }
+}
+
+int main() {
+    return run_all_tests();
+}
@@ -0,0 +1,437 @@
+// File: tests/test_drawing.cpp
+//
+// Drawing on top of the mocked display: clipping, rejected rectangles, the
+// BUSY/IDLE cycle of drawImageAsync, the RLE and palette decoders and text.
+
+#include "TestHarness.h"
+#include "MockHardware.h"
+#include "Drawing.h"
+#include "BandRenderer.h"
+#include "config.h"
+#include "font_freesans_16.h"
+#include "rle_vectors.h"
+#ifdef HAVE_TEST_FONTS
+#include "font_test_sans_16_packed.h"
+#include "font_test_sans_16_rle.h"
+#include "font_test_bold_40_packed.h"
+#include "font_test_bold_40_rle.h"
+#endif
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+struct Fixture {
+    St7789Display display{pio0, DISPLAY_PIN_SDA, DISPLAY_PIN_SCL, DISPLAY_PIN_CS,
+                          DISPLAY_PIN_DC, DISPLAY_PIN_RESET, DisplayOrientation::LANDSCAPE};
+    Drawing drawing{display};
+
+    Fixture() {
+        mock::reset();
+        mock::attachPanel(DISPLAY_PIN_SDA, DISPLAY_PIN_SCL, DISPLAY_PIN_CS, DISPLAY_PIN_DC);
+        display.init();
+        display.setPixelTransferMode(PixelTransferMode::FRAMED);
+        mock::setCycleBudget(1u << 22);
+        mock::clearLogs();
+    }
+};
+
+bool filled(int x, int y, int w, int h, uint16_t color) {
+    for (int row = 0; row < h; ++row) {
+        for (int col = 0; col < w; ++col) {
+            if (mock::panel().pixel(x + col, y + row) != color) return false;
+        }
+    }
+    return true;
+}
+
+std::vector<uint16_t> snapshot(int y, int h) {
+    std::vector<uint16_t> pixels;
+    for (int row = y; row < y + h; ++row) {
+        for (int col = 0; col < 320; ++col) pixels.push_back(mock::panel().pixel(col, row));
+    }
+    return pixels;
+}
+
+// Every inked pixel as a 1x1 fill, as drawString used to plot text.
+void draw_string_per_pixel(Drawing& drawing, uint16_t x, uint16_t y, const char* str, uint16_t color) {
+    const custom_font_t* font = &font_freesans_16;
+    int32_t pen = x;
+    for (; *str; ++str) {
+        const custom_glyph_t* glyph = font_find_glyph(font, *str);
+        if (!glyph) continue;
+        GlyphRuns runs(font, glyph);
+        uint8_t row, x0, x1;
+        while (runs.next(row, x0, x1)) {
+            for (uint8_t col = x0; col < x1; ++col) {
+                drawing.fillRect((uint16_t)(pen + glyph->x_offset + col), y + glyph->y_offset + row, 1, 1, color);
+            }
+        }
+        pen += glyph->advance;
+    }
+}
+
+} // namespace
+
+TEST(fill_rect_clips_to_the_panel) {
+    Fixture f;
+    f.drawing.fillRect(300, 230, 50, 50, 0x1111);
+    f.display.waitForIdle();
+    CHECK_EQ(mock::panel().pixelsWritten(), 20 * 10);
+    CHECK(filled(300, 230, 20, 10, 0x1111));
+    CHECK_EQ(mock::panel().pixel(299, 230), 0);
+}
+
+TEST(fill_rect_ignores_empty_rects) {
+    Fixture f;
+    f.drawing.fillRect(10, 10, 0, 20, 0xffff);
+    f.drawing.fillRect(10, 10, 20, 0, 0xffff);
+    f.drawing.fillRect(320, 0, 5, 5, 0xffff);
+    f.drawing.fillRect(0, 240, 5, 5, 0xffff);
+    f.display.waitForIdle();
+    CHECK(mock::dmaRuns().empty());
+    CHECK(!mock::stateMachineHung());
+    CHECK(!f.display.isBusy());
+}
+
+TEST(draw_image_rejects_empty_and_off_screen_rects) {
+    Fixture f;
+    std::vector<uint16_t> pixels(40 * 10, 0xabcd);
+    CHECK(!f.drawing.drawImageAsync(10, 10, 0, 10, pixels.data()));
+    CHECK(!f.drawing.drawImageAsync(10, 10, 10, 0, pixels.data()));
+    CHECK(!f.drawing.drawImageAsync(300, 0, 40, 10, pixels.data()));
+    CHECK(!f.drawing.drawImageAsync(0, 235, 40, 10, pixels.data()));
+    CHECK(!f.drawing.drawImageAsync(320, 0, 1, 1, pixels.data()));
+    CHECK(mock::dmaRuns().empty());
+    CHECK(f.drawing.processDrawing() == Drawing::DrawStatus::IDLE);
+
+    // Exactly at the edge is fine.
+    CHECK(f.drawing.drawImageAsync(280, 230, 40, 10, pixels.data()));
+    f.display.waitForIdle();
+    CHECK(f.drawing.processDrawing() == Drawing::DrawStatus::IDLE);
+    CHECK(filled(280, 230, 40, 10, 0xabcd));
+    CHECK_EQ(mock::panel().framingErrors(), 0);
+}
+
+TEST(draw_image_is_busy_until_the_dma_finishes) {
+    Fixture f;
+    std::vector<uint16_t> pixels(8 * 8, 0x0f0f);
+    mock::holdDma(true);
+    CHECK(f.drawing.drawImageAsync(0, 0, 8, 8, pixels.data()));
+    CHECK(f.drawing.processDrawing() == Drawing::DrawStatus::BUSY);
+    CHECK(!f.drawing.drawImageAsync(8, 0, 8, 8, pixels.data()));
+    mock::releaseDma();
+    CHECK(f.drawing.processDrawing() == Drawing::DrawStatus::IDLE);
+    CHECK(filled(0, 0, 8, 8, 0x0f0f));
+}
+
+// Rows [0, good_rows) show 'pixels', the rest of the window is black.
+bool shows_rows_then_black(int x, int y, int w, int h, const uint16_t* pixels, int good_rows) {
+    for (int row = 0; row < h; ++row) {
+        for (int col = 0; col < w; ++col) {
+            uint16_t expected = row < good_rows ? pixels[row * w + col] : 0;
+            if (mock::panel().pixel(x + col, y + row) != expected) return false;
+        }
+    }
+    return true;
+}
+
+// What drawPaletteImage should show for pixel 'col' of a row: first pixel in
+// the low bits, indices beyond the palette black.
+uint16_t palette_pixel(const uint8_t* row, uint16_t col, uint8_t bits, const std::vector<uint16_t>& palette) {
+    uint32_t bit = (uint32_t)col * bits;
+    uint8_t index = (row[bit / 8] >> (bit % 8)) & ((1u << bits) - 1);
+    return index < palette.size() ? palette[index] : 0;
+}
+
+// Every bit depth, with widths that end part way through a byte and
+// palettes too small for every index.
+TEST(rle_decodes_what_tile_codec_encodes) {
+    for (const RleVector& v : rle_vectors) {
+        Fixture f;
+        CHECK(f.drawing.drawRleImage(0, 10, v.width, v.height, v.data, v.length));
+        f.display.waitForIdle();
+        CHECK(shows_rows_then_black(0, 10, v.width, v.height, v.pixels, v.height));
+        CHECK_EQ(mock::panel().pixelsWritten(), (int)v.width * v.height);
+        CHECK_EQ(mock::panel().framingErrors(), 0);
+    }
+}
+
+// Malformed data: false, with the window completed in black from the bad row on.
+TEST(rle_rejects_copy_up_in_the_first_row) {
+    Fixture f;
+    f.drawing.fillRect(0, 0, 4, 2, 0xffff);
+    const uint8_t data[] = {0xC3, 0xC3};
+    CHECK(!f.drawing.drawRleImage(0, 0, 4, 2, data, sizeof(data)));
+    f.display.waitForIdle();
+    CHECK(filled(0, 0, 4, 2, 0));
+    CHECK_EQ(mock::panel().framingErrors(), 0);
+}
+
+TEST(rle_rejects_runs_past_the_end_of_the_row) {
+    Fixture f;
+    f.drawing.fillRect(0, 0, 4, 3, 0xffff);
+    // Row 0 fine, then a run of 8 and a literal of 5 in a 4-pixel row.
+    const uint8_t data[] = {0x83, 0x34, 0x12, 0x87, 0x34, 0x12, 0x04, 1, 0, 2, 0, 3, 0, 4, 0, 5, 0};
+    CHECK(!f.drawing.drawRleImage(0, 0, 4, 3, data, sizeof(data)));
+    f.display.waitForIdle();
+    CHECK(filled(0, 0, 4, 1, 0x1234));
+    CHECK(filled(0, 1, 4, 2, 0));
+
+    const uint8_t literal[] = {0x04, 1, 0, 2, 0, 3, 0, 4, 0, 5, 0};
+    CHECK(!f.drawing.drawRleImage(0, 0, 4, 1, literal, sizeof(literal)));
+    f.display.waitForIdle();
+    CHECK(filled(0, 0, 4, 1, 0));
+    CHECK_EQ(mock::panel().framingErrors(), 0);
+}
+
+TEST(rle_rejects_truncated_data) {
+    for (const RleVector& v : rle_vectors) {
+        Fixture f;
+        for (size_t length = 0; length < v.length; ++length) {
+            // Rows whose encoding ends within 'length' are drawn.
+            int good_rows = 0;
+            while (good_rows < v.height &&
+                   (good_rows + 1 < v.height ? v.row_offsets[good_rows + 1] : v.length) <= length) {
+                good_rows++;
+            }
+            f.drawing.fillRect(0, 0, v.width, v.height, 0xffff);
+            CHECK(!f.drawing.drawRleImage(0, 0, v.width, v.height, v.data, length));
+            f.display.waitForIdle();
+            CHECK(shows_rows_then_black(0, 0, v.width, v.height, v.pixels, good_rows));
+        }
+        CHECK_EQ(mock::panel().framingErrors(), 0);
+    }
+}
+
+// Trailing bytes are an error too, but every row was good, so nothing is blanked.
+TEST(rle_rejects_trailing_bytes) {
+    const RleVector& v = rle_vectors[0];
+    std::vector<uint8_t> data(v.data, v.data + v.length);
+    data.push_back(0x80);
+    data.push_back(0);
+    Fixture f;
+    CHECK(!f.drawing.drawRleImage(0, 0, v.width, v.height, data.data(), data.size()));
+    f.display.waitForIdle();
+    CHECK(shows_rows_then_black(0, 0, v.width, v.height, v.pixels, v.height));
+    CHECK_EQ(mock::panel().pixelsWritten(), (int)v.width * v.height);
+}
+
+TEST(palette_images_expand_every_bit_depth) {
+    const uint8_t depths[] = {1, 2, 4, 8};
+    const uint16_t widths[] = {1, 7, 13, 320};
+    for (uint8_t bits : depths) {
+        for (uint16_t width : widths) {
+            for (size_t palette_count : {(size_t)1, (size_t)(1u << bits) - (bits > 1 ? 1 : 0), (size_t)(1u << bits)}) {
+                Fixture f;
+                const uint16_t HEIGHT = 5;
+                std::vector<uint16_t> palette(palette_count);
+                for (size_t i = 0; i < palette_count; ++i) palette[i] = (uint16_t)(0x1234 + i * 0x0841);
+                size_t bytes_per_row = ((size_t)width * bits + 7) / 8;
+                std::vector<uint8_t> indices(bytes_per_row * HEIGHT);
+                for (size_t i = 0; i < indices.size(); ++i) indices[i] = (uint8_t)(i * 0x9d + 0x35);
+
+                CHECK(f.drawing.drawPaletteImage(0, 20, width, HEIGHT, bits, palette.data(), palette_count,
+                                                 indices.data(), indices.size()));
+                f.display.waitForIdle();
+                bool ok = true;
+                for (uint16_t row = 0; row < HEIGHT; ++row) {
+                    for (uint16_t col = 0; col < width; ++col) {
+                        uint16_t expected = palette_pixel(indices.data() + row * bytes_per_row, col, bits, palette);
+                        if (mock::panel().pixel(col, 20 + row) != expected) ok = false;
+                    }
+                }
+                if (!ok) std::printf("  %u bpp, width %u, %zu colours\n", bits, width, palette_count);
+                CHECK(ok);
+                CHECK_EQ(mock::panel().pixelsWritten(), (int)width * HEIGHT);
+                CHECK_EQ(mock::panel().framingErrors(), 0);
+            }
+        }
+    }
+}
+
+TEST(palette_images_reject_bad_arguments) {
+    Fixture f;
+    uint16_t palette[4] = {1, 2, 3, 4};
+    uint8_t indices[8] = {};
+    CHECK(!f.drawing.drawPaletteImage(0, 0, 8, 1, 3, palette, 4, indices, 3));
+    CHECK(!f.drawing.drawPaletteImage(0, 0, 8, 1, 2, palette, 0, indices, 2));
+    CHECK(!f.drawing.drawPaletteImage(0, 0, 8, 1, 2, palette, 4, indices, 3));
+    CHECK(!f.drawing.drawPaletteImage(0, 0, 9, 1, 2, palette, 4, indices, 2));
+    CHECK(!f.drawing.drawPaletteImage(316, 0, 8, 1, 2, palette, 4, indices, 2));
+    CHECK(mock::dmaRuns().empty());
+}
+
+// Window counts on the panel for the old per-pixel path and both span paths,
+// with the spans required to draw exactly the same ink.
+TEST(text_spans_match_per_pixel_with_fewer_windows) {
+    const char* strings[] = {"Connecting to Wi-Fi...", "Hello, World! 0123456789", "Waiting for host..."};
+    const uint16_t Y = 100;
+    const uint16_t INK = 0xffe0;
+    const uint16_t BACKGROUND = 0x001f;
+    for (const char* str : strings) {
+        Fixture f;
+        draw_string_per_pixel(f.drawing, 3, Y, str, INK);
+        f.display.waitForIdle();
+        int pixel_windows = mock::panel().windows();
+        std::vector<uint16_t> expected = snapshot(Y, font_freesans_16.height);
+
+        f.display.fillScreen(0);
+        mock::clearLogs();
+        f.drawing.drawString(3, Y, str, INK, &font_freesans_16);
+        f.display.waitForIdle();
+        int span_windows = mock::panel().windows();
+        CHECK(snapshot(Y, font_freesans_16.height) == expected);
+
+        f.display.fillScreen(0);
+        mock::clearLogs();
+        f.drawing.drawString(3, Y, str, INK, BACKGROUND, &font_freesans_16);
+        int opaque_windows = mock::panel().windows();
+        std::vector<uint16_t> opaque = snapshot(Y, font_freesans_16.height);
+        bool ink_matches = true;
+        for (size_t i = 0; i < opaque.size(); ++i) {
+            if ((expected[i] == INK) != (opaque[i] == INK)) ink_matches = false;
+            if (opaque[i] != INK && opaque[i] != BACKGROUND && opaque[i] != 0) ink_matches = false;
+        }
+        CHECK(ink_matches);
+
+        std::printf("  \"%s\": %d windows per pixel, %d as spans, %d with background\n",
+                    str, pixel_windows, span_windows, opaque_windows);
+        CHECK(span_windows * 2 < pixel_windows);
+        CHECK_EQ(opaque_windows, 1);
+        CHECK_EQ(mock::panel().framingErrors(), 0);
+    }
+}
+
+TEST(text_benchmark_runs_and_clears_up) {
+    Fixture f;
+    text_benchmark(f.display, f.drawing, &font_freesans_16);
+    CHECK(!f.display.isBusy());
+    CHECK(snapshot(0, font_freesans_16.height) == std::vector<uint16_t>(320 * font_freesans_16.height, 0));
+    CHECK_EQ(mock::panel().framingErrors(), 0);
+    CHECK(!mock::stateMachineHung());
+}
+
+#ifdef HAVE_TEST_FONTS
+struct GlyphRun {
+    uint8_t row, x0, x1;
+    bool operator==(const GlyphRun& o) const { return row == o.row && x0 == o.x0 && x1 == o.x1; }
+};
+
+std::vector<GlyphRun> glyph_runs(const custom_font_t* font, const custom_glyph_t* glyph) {
+    std::vector<GlyphRun> runs;
+    GlyphRuns walker(font, glyph);
+    GlyphRun r;
+    while (walker.next(r.row, r.x0, r.x1)) runs.push_back(r);
+    return runs;
+}
+
+// create_font.py output with every glyph packed and with every glyph
+// run-length coded must walk as the same runs, long runs of the bold face
+// included.
+TEST(glyph_runs_match_across_encodings) {
+    const custom_font_t* pairs[][2] = {{&font_test_sans_16_packed, &font_test_sans_16_rle},
+                                       {&font_test_bold_40_packed, &font_test_bold_40_rle}};
+    for (const auto& pair : pairs) {
+        int glyphs = 0, rle_glyphs = 0, mismatches = 0;
+        for (int c = 32; c <= 126; ++c) {
+            const custom_glyph_t* packed = font_find_glyph(pair[0], (char)c);
+            const custom_glyph_t* rle = font_find_glyph(pair[1], (char)c);
+            CHECK(packed && rle);
+            if (!packed || !rle) continue;
+            glyphs++;
+            CHECK_EQ(packed->flags & GLYPH_RLE, 0);
+            if (rle->flags & GLYPH_RLE) rle_glyphs++;
+            CHECK(packed->width == rle->width && packed->height == rle->height);
+            std::vector<GlyphRun> runs = glyph_runs(pair[0], packed);
+            if (runs != glyph_runs(pair[1], rle)) {
+                std::printf("  '%c' walks differently\n", c);
+                mismatches++;
+            }
+            // Runs stay inside the box, in order, and never touch.
+            for (size_t i = 0; i < runs.size(); ++i) {
+                const GlyphRun& r = runs[i];
+                CHECK(r.x0 < r.x1 && r.x1 <= packed->width && r.row < packed->height);
+                if (i > 0) {
+                    const GlyphRun& p = runs[i - 1];
+                    CHECK(r.row > p.row || (r.row == p.row && r.x0 > p.x1));
+                }
+            }
+        }
+        CHECK_EQ(glyphs, 95);
+        CHECK_EQ(rle_glyphs, 94); // All but the blank space
+        CHECK_EQ(mismatches, 0);
+    }
+}
+#endif
+
+// The band renderer composites in memory; the panel must end up as if every
+// operation had been drawn directly, in order.
+TEST(band_renderer_matches_direct_drawing) {
+    const uint16_t X = 5, Y = 40, WIDTH = 300, HEIGHT = 30;
+    std::vector<uint16_t> image(40 * 12);
+    for (size_t i = 0; i < image.size(); ++i) image[i] = (uint16_t)(0x0841 * i);
+    const char* text = "Hello, World! 0123456789";
+
+    Fixture direct;
+    direct.drawing.fillRect(X, Y, WIDTH, HEIGHT, 0);
+    direct.drawing.fillRect(0, Y + 2, 100, 20, 0x001f);
+    CHECK(direct.drawing.drawImageAsync(60, Y + 10, 40, 12, image.data()));
+    direct.display.waitForIdle();
+    CHECK(direct.drawing.processDrawing() == Drawing::DrawStatus::IDLE);
+    direct.drawing.drawString(10, Y + 4, text, 0xffe0, &font_freesans_16);
+    direct.drawing.fillRect(200, Y + 20, 200, 30, 0xf800);
+    direct.display.waitForIdle();
+    std::vector<uint16_t> expected = snapshot(Y - 5, HEIGHT + 10);
+
+    Fixture banded;
+    BandRenderer renderer(banded.drawing);
+    renderer.clear();
+    CHECK(renderer.fillRect(0, Y + 2, 100, 20, 0x001f));
+    CHECK(renderer.drawImage(60, Y + 10, 40, 12, image.data()));
+    CHECK(renderer.drawString(10, Y + 4, text, 0xffe0, &font_freesans_16));
+    CHECK(renderer.fillRect(200, Y + 20, 200, 30, 0xf800));
+    CHECK(renderer.render(X, Y, WIDTH, HEIGHT));
+    banded.display.waitForIdle();
+    CHECK(banded.drawing.processDrawing() == Drawing::DrawStatus::IDLE);
+
+    // Outside the window nothing is drawn, so the direct fills there are masked off.
+    for (int row = 0; row < HEIGHT + 10; ++row) {
+        for (int col = 0; col < 320; ++col) {
+            int y = Y - 5 + row;
+            if (y < Y || y >= Y + HEIGHT || col < X || col >= X + WIDTH) expected[row * 320 + col] = 0;
+        }
+    }
+    CHECK(snapshot(Y - 5, HEIGHT + 10) == expected);
+    CHECK_EQ(mock::panel().windows(), (HEIGHT + BAND_ROWS - 1) / BAND_ROWS);
+    CHECK_EQ(mock::panel().pixelsWritten(), WIDTH * HEIGHT);
+    CHECK_EQ(mock::panel().framingErrors(), 0);
+}
+
+TEST(band_renderer_fails_instead_of_dropping_bands) {
+    Fixture f;
+    BandRenderer renderer(f.drawing);
+    renderer.clear();
+    renderer.fillRect(0, 0, 320, 240, 0x07e0);
+    // The last band would end below the panel.
+    CHECK(!renderer.render(0, 230, 320, 20));
+    f.display.waitForIdle();
+    CHECK(filled(0, 230, 320, BAND_ROWS, 0x07e0));
+    CHECK(!renderer.render(0, 0, BAND_MAX_WIDTH + 1, 8));
+    CHECK(!renderer.render(0, 0, 0, 8));
+
+    // A transfer that is still running is waited for, not lost.
+    std::vector<uint16_t> pixels(16, 0x1234);
+    mock::holdDma(true);
+    CHECK(f.drawing.drawImageAsync(0, 0, 16, 1, pixels.data()));
+    CHECK(renderer.render(0, 100, 320, 16));
+    mock::holdDma(false);
+    f.display.waitForIdle();
+    CHECK(filled(0, 0, 16, 1, 0x1234));
+    CHECK(filled(0, 100, 320, 16, 0x07e0));
+    CHECK_EQ(mock::panel().framingErrors(), 0);
+}
+
+int main() {
+    return run_all_tests();
+}
@@ -0,0 +1,208 @@
+// File: tests/test_framebuffer.cpp
+//
+// Retained mode: Framebuffer's overlapping copies, scrolls and dirty rows,
+// and Drawing::flush putting exactly the dirty band on the mocked panel.
+
+#include "TestHarness.h"
+#include "MockHardware.h"
+#include "Drawing.h"
+#include "Framebuffer.h"
+#include "config.h"
+#include <vector>
+
+namespace {
+
+constexpr uint16_t W = 64;
+constexpr uint16_t H = 48;
+
+uint16_t seed_pixel(int x, int y) {
+    return (uint16_t)(x | (y << 8));
+}
+
+// A framebuffer holding seed_pixel everywhere, clean, and a plain copy of it.
+struct Board {
+    Framebuffer fb;
+    std::vector<uint16_t> ref;
+
+    Board() : ref((size_t)W * H) {
+        fb.init(W, H);
+        for (int y = 0; y < H; ++y) {
+            std::vector<uint16_t> row(W);
+            for (int x = 0; x < W; ++x) row[x] = ref[y * W + x] = seed_pixel(x, y);
+            fb.writeRow(0, (uint16_t)y, row.data(), W);
+        }
+        uint16_t x, y, w, h;
+        while (fb.takeDirtyRect(x, y, w, h)) {}
+    }
+
+    // Reference copy through a temporary, so overlap cannot matter.
+    void refCopy(int x, int y, int w, int h, int dst_x, int dst_y) {
+        std::vector<uint16_t> tmp((size_t)w * h);
+        for (int r = 0; r < h; ++r)
+            for (int c = 0; c < w; ++c) tmp[r * w + c] = ref[(y + r) * W + x + c];
+        for (int r = 0; r < h; ++r)
+            for (int c = 0; c < w; ++c) ref[(dst_y + r) * W + dst_x + c] = tmp[r * w + c];
+    }
+
+    void refFill(int x, int y, int w, int h, uint16_t color) {
+        for (int r = y; r < y + h; ++r)
+            for (int c = x; c < x + w; ++c) ref[r * W + c] = color;
+    }
+
+    bool matches() const {
+        for (int y = 0; y < H; ++y) {
+            for (int x = 0; x < W; ++x) {
+                if (fb.row((uint16_t)y)[x] != ref[y * W + x]) return false;
+            }
+        }
+        return true;
+    }
+};
+
+struct Rect {
+    uint16_t x, y, w, h;
+    bool operator==(const Rect& o) const { return x == o.x && y == o.y && w == o.w && h == o.h; }
+};
+
+std::vector<Rect> take_all(Framebuffer& fb) {
+    std::vector<Rect> rects;
+    Rect r;
+    while (fb.takeDirtyRect(r.x, r.y, r.w, r.h)) rects.push_back(r);
+    return rects;
+}
+
+} // namespace
+
+TEST(copy_handles_overlap_in_every_direction) {
+    // Source at (10,10) 20x15, moved by less than its size each way.
+    const int moves[][2] = {{3, 0}, {-3, 0}, {0, 4}, {0, -4}, {5, 5}, {-5, -5}, {5, -5}, {-5, 5}, {0, 0}};
+    for (const auto& m : moves) {
+        Board b;
+        b.fb.copy(10, 10, 20, 15, 10 + m[0], 10 + m[1]);
+        b.refCopy(10, 10, 20, 15, 10 + m[0], 10 + m[1]);
+        CHECK(b.matches());
+        std::vector<Rect> dirty = take_all(b.fb);
+        CHECK(dirty.size() == 1 && dirty[0] == (Rect{(uint16_t)(10 + m[0]), (uint16_t)(10 + m[1]), 20, 15}));
+    }
+}
+
+TEST(copy_clips_at_the_edges) {
+    Board b;
+    b.fb.copy(0, 0, 20, 20, W - 8, H - 5);
+    b.refCopy(0, 0, 8, 5, W - 8, H - 5);
+    CHECK(b.matches());
+    b.fb.copy(W, 0, 4, 4, 0, 0);
+    b.fb.copy(0, 0, 4, 4, 0, H);
+    CHECK(b.matches());
+}
+
+TEST(scroll_fills_the_exposed_strip) {
+    const int shifts[][2] = {{0, 6}, {0, -6}, {7, 0}, {-7, 0}, {3, -2}, {-3, 2}};
+    for (const auto& s : shifts) {
+        Board b;
+        const int x = 4, y = 6, w = 30, h = 20;
+        const uint16_t FILL = 0xbeef;
+        b.fb.scroll(x, y, w, h, (int16_t)s[0], (int16_t)s[1], FILL);
+
+        int sx = s[0] < 0 ? -s[0] : s[0];
+        int sy = s[1] < 0 ? -s[1] : s[1];
+        b.refCopy(s[0] < 0 ? x + sx : x, s[1] < 0 ? y + sy : y, w - sx, h - sy,
+                  s[0] > 0 ? x + sx : x, s[1] > 0 ? y + sy : y);
+        if (sy) b.refFill(x, s[1] > 0 ? y : y + h - sy, w, sy, FILL);
+        if (sx) b.refFill(s[0] > 0 ? x : x + w - sx, y, sx, h, FILL);
+        CHECK(b.matches());
+        // Outside the rectangle nothing moved, and only the rectangle is dirty.
+        std::vector<Rect> dirty = take_all(b.fb);
+        CHECK(dirty.size() == 1 && dirty[0] == (Rect{x, y, w, h}));
+    }
+}
+
+TEST(scroll_by_the_whole_rect_just_fills) {
+    Board b;
+    b.fb.scroll(10, 10, 8, 8, 0, -8, 0x1234);
+    b.refFill(10, 10, 8, 8, 0x1234);
+    b.fb.scroll(30, 10, 8, 8, 100, 0, 0x4321);
+    b.refFill(30, 10, 8, 8, 0x4321);
+    CHECK(b.matches());
+}
+
+TEST(dirty_rows_merge_into_bands) {
+    Board b;
+    CHECK(!b.fb.isDirty());
+    b.fb.fill(20, 30, 5, 4, 1);   // Rows 30-33
+    b.fb.fill(2, 5, 3, 2, 1);     // Rows 5-6
+    b.fb.fill(40, 6, 10, 3, 1);   // Rows 6-8, touching the band above
+    b.fb.setPixel(60, 34, 1);     // Row 34, right below the first band
+    CHECK(b.fb.isDirty());
+    std::vector<Rect> dirty = take_all(b.fb);
+    CHECK(dirty.size() == 2);
+    CHECK(dirty.size() == 2 && dirty[0] == (Rect{2, 5, 48, 4}));
+    CHECK(dirty.size() == 2 && dirty[1] == (Rect{20, 30, 41, 5}));
+    CHECK(!b.fb.isDirty());
+}
+
+// flush() sends the topmost band: full width as one DMA transfer, narrower
+// bands row by row through a streamed window. Nothing else reaches the panel.
+TEST(flush_puts_exactly_the_dirty_band_on_the_panel) {
+    mock::reset();
+    mock::attachPanel(DISPLAY_PIN_SDA, DISPLAY_PIN_SCL, DISPLAY_PIN_CS, DISPLAY_PIN_DC);
+    St7789Display display(pio0, DISPLAY_PIN_SDA, DISPLAY_PIN_SCL, DISPLAY_PIN_CS,
+                          DISPLAY_PIN_DC, DISPLAY_PIN_RESET, DisplayOrientation::LANDSCAPE);
+    display.init();
+    display.setPixelTransferMode(PixelTransferMode::FRAMED);
+    mock::setCycleBudget(1u << 22);
+    display.fillScreen(0x0001);
+
+    Framebuffer fb;
+    CHECK(fb.init(display.getWidth(), display.getHeight()));
+    Drawing drawing(display);
+    drawing.setFramebuffer(&fb);
+
+    drawing.fillRect(0, 100, 320, 10, 0xaaaa);
+    drawing.fillRect(50, 200, 30, 4, 0x5555);
+    drawing.fillRect(52, 203, 30, 2, 0x7777);
+    mock::clearLogs();
+    CHECK_EQ(mock::panel().pixelsWritten(), 0); // Nothing drawn until flushed
+
+    CHECK(drawing.flush());
+    display.waitForIdle();
+    CHECK(drawing.processDrawing() == Drawing::DrawStatus::IDLE);
+    CHECK_EQ(mock::panel().windows(), 1);
+    CHECK_EQ(mock::panel().pixelsWritten(), 320 * 10);
+    // Packet chain, then one pixel run for the whole band.
+    const auto& runs = mock::dmaRuns();
+    CHECK(runs.size() == 2 && runs[1].count == 320 * 10);
+
+    mock::clearLogs();
+    CHECK(drawing.flush());
+    display.waitForIdle();
+    CHECK_EQ(mock::panel().windows(), 1);
+    CHECK_EQ(mock::panel().pixelsWritten(), 32 * 5);
+    int pixel_runs = 0;
+    for (const mock::DmaRun& r : mock::dmaRuns()) {
+        if (r.count == 32) pixel_runs++;
+    }
+    CHECK_EQ(pixel_runs, 5);
+    CHECK(!drawing.flush());
+
+    bool ok = true;
+    for (int y = 0; y < 240; ++y) {
+        for (int x = 0; x < 320; ++x) {
+            uint16_t expected = 0x0001;
+            if (y >= 100 && y < 110) expected = 0xaaaa;
+            if (y >= 200 && y < 205) {
+                // The band is the union of the two rects' columns, from the framebuffer.
+                if (x >= 50 && x < 82) expected = 0;
+                if (x >= 50 && x < 80 && y < 204) expected = 0x5555;
+                if (x >= 52 && x < 82 && y >= 203) expected = 0x7777;
+            }
+            if (mock::panel().pixel(x, y) != expected) ok = false;
+        }
+    }
+    CHECK(ok);
+    CHECK_EQ(mock::panel().framingErrors(), 0);
+}
+
+int main() {
+    return run_all_tests();
+}
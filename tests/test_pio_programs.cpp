@@ -0,0 +1,269 @@
+// File: tests/test_pio_programs.cpp
+//
+// Runs the programs in st7789_lcd.pio on the simulated state machine, set up
+// by the c-sdk helpers from the same file, and checks what the panel decodes
+// and how many SM cycles each path costs.
+
+#include "TestHarness.h"
+#include "MockHardware.h"
+#include "hardware/gpio.h"
+#include "st7789_lcd.pio.h"
+#include "config.h"
+#include <cstdio>
+
+namespace {
+
+constexpr uint SM = 0;
+constexpr float CLK_DIV = 1.0f;
+constexpr uint64_t MAX_CYCLES = 1ull << 26;
+
+// One state machine wired to the panel model, CS held low.
+struct Bench {
+    Bench() {
+        mock::reset();
+        mock::attachPanel(DISPLAY_PIN_SDA, DISPLAY_PIN_SCL, DISPLAY_PIN_CS, DISPLAY_PIN_DC);
+        gpio_init(DISPLAY_PIN_CS);
+        gpio_put(DISPLAY_PIN_CS, 0);
+        pio_claim_unused_sm(pio0, true);
+    }
+
+    // Byte-wide program, DC on a GPIO.
+    void loadBytes() {
+        gpio_init(DISPLAY_PIN_DC);
+        uint offset = pio_add_program(pio0, &st7789_lcd_program);
+        st7789_lcd_program_init(pio0, SM, offset, DISPLAY_PIN_SDA, DISPLAY_PIN_SCL, CLK_DIV);
+        m_offset = offset;
+    }
+
+    void use16Bit() {
+        pio_sm_config c = st7789_lcd_program_get_config(m_offset, DISPLAY_PIN_SDA, DISPLAY_PIN_SCL, CLK_DIV, 16);
+        st7789_lcd_set_config(pio0, SM, m_offset, &c);
+    }
+
+    void usePx32() {
+        uint offset = pio_add_program(pio0, &st7789_lcd_px32_program);
+        pio_sm_config c = st7789_lcd_px32_program_get_config(offset, DISPLAY_PIN_SDA, DISPLAY_PIN_SCL, CLK_DIV);
+        st7789_lcd_set_config(pio0, SM, offset, &c);
+    }
+
+    void loadFramed() {
+        uint offset = pio_add_program(pio0, &st7789_lcd_framed_program);
+        st7789_lcd_framed_program_init(pio0, SM, offset, DISPLAY_PIN_SDA, DISPLAY_PIN_SCL, DISPLAY_PIN_DC, CLK_DIV);
+    }
+
+    // Command and parameters through the byte-wide program, as send_command does.
+    void command(uint8_t opcode, std::initializer_list<uint8_t> params = {}) {
+        gpio_put(DISPLAY_PIN_DC, 0);
+        byte(opcode);
+        gpio_put(DISPLAY_PIN_DC, 1);
+        for (uint8_t p : params) byte(p);
+    }
+
+    void byte(uint8_t value) { push(value * 0x01010101u); }
+    void unit(uint16_t value) { push(value * 0x00010001u); }
+
+    void push(uint32_t word) {
+        PioStateMachine& sm = mock::stateMachine(pio0, SM);
+        sm.push(word);
+        CHECK(sm.run(MAX_CYCLES));
+    }
+
+    uint64_t cycles() { return mock::stateMachine(pio0, SM).cycles(); }
+    St7789Model& panel() { return mock::panel(); }
+
+    uint m_offset = 0;
+};
+
+uint16_t test_pixel(uint32_t i) {
+    return (uint16_t)(0x8421 * (i + 1) ^ (i << 5));
+}
+
+// Framed data packet header for 'count' payload units.
+void framed_data_tag(Bench& b, uint32_t count, bool repeat) {
+    b.unit((uint16_t)(0x8000 | (repeat ? 0x4000 : 0) | ((count - 1) >> 16)));
+    b.unit((uint16_t)((count - 1) & 0xffff));
+}
+
+void framed_window(Bench& b, uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+    b.unit(0x2A);
+    framed_data_tag(b, 2, false);
+    b.unit(x);
+    b.unit((uint16_t)(x + w - 1));
+    b.unit(0x2B);
+    framed_data_tag(b, 2, false);
+    b.unit(y);
+    b.unit((uint16_t)(y + h - 1));
+    b.unit(0x2C);
+}
+
+} // namespace
+
+TEST(byte_program_frames_commands_and_data) {
+    Bench b;
+    b.loadBytes();
+    uint64_t start = b.cycles();
+    b.command(0x2A, {0x00, 0x05, 0x01, 0x02});
+    CHECK_EQ(b.cycles() - start, 5 * 16);
+    const auto& cmds = b.panel().commands();
+    CHECK(cmds.size() == 1 && cmds[0].opcode == 0x2A && cmds[0].params == std::vector<uint8_t>({0, 5, 1, 2}));
+    CHECK_EQ(b.panel().framingErrors(), 0);
+}
+
+TEST(pixel16_program_sends_native_pixels_high_byte_first) {
+    Bench b;
+    b.loadBytes();
+    b.command(0x2A, {0, 0, 0, 9});
+    b.command(0x2B, {0, 0, 0, 0});
+    b.command(0x2C);
+    b.use16Bit();
+    uint64_t start = b.cycles();
+    for (uint32_t i = 0; i < 10; ++i) b.unit(test_pixel(i));
+    CHECK_EQ(b.cycles() - start, 10 * 32);
+    for (int x = 0; x < 10; ++x) CHECK_EQ(b.panel().pixel(x, 0), test_pixel(x));
+}
+
+TEST(px32_program_sends_the_low_half_first) {
+    Bench b;
+    b.loadBytes();
+    b.command(0x2A, {0, 0, 0, 9});
+    b.command(0x2B, {0, 0, 0, 0});
+    b.command(0x2C);
+    b.usePx32();
+    uint64_t start = b.cycles();
+    // A little-endian uint16_t buffer read as words: pixel 2i in the low half.
+    for (uint32_t i = 0; i < 10; i += 2) {
+        b.push((uint32_t)test_pixel(i) | ((uint32_t)test_pixel(i + 1) << 16));
+    }
+    CHECK_EQ(b.cycles() - start, 5 * 68);
+    for (int x = 0; x < 10; ++x) CHECK_EQ(b.panel().pixel(x, 0), test_pixel(x));
+    CHECK_EQ(b.panel().pixelsWritten(), 10);
+}
+
+TEST(framed_program_drives_dc_from_the_tags) {
+    Bench b;
+    b.loadFramed();
+    framed_window(b, 3, 4, 2, 2);
+    framed_data_tag(b, 4, false);
+    for (uint32_t i = 0; i < 4; ++i) b.unit(test_pixel(i));
+    b.unit(0x29); // A command right after the payload is framed correctly
+
+    const auto& cmds = b.panel().commands();
+    CHECK_EQ(cmds.size(), 4);
+    CHECK(cmds.size() == 4 && cmds[0].opcode == 0x2A && cmds[0].params == std::vector<uint8_t>({0, 3, 0, 4}));
+    CHECK(cmds.size() == 4 && cmds[1].opcode == 0x2B && cmds[1].params == std::vector<uint8_t>({0, 4, 0, 5}));
+    CHECK(cmds.size() == 4 && cmds[2].opcode == 0x2C && cmds[2].data_bytes == 8);
+    CHECK(cmds.size() == 4 && cmds[3].opcode == 0x29 && cmds[3].data_bytes == 0);
+    CHECK_EQ(b.panel().pixel(3, 4), test_pixel(0));
+    CHECK_EQ(b.panel().pixel(4, 4), test_pixel(1));
+    CHECK_EQ(b.panel().pixel(3, 5), test_pixel(2));
+    CHECK_EQ(b.panel().pixel(4, 5), test_pixel(3));
+    CHECK_EQ(b.panel().framingErrors(), 0);
+}
+
+TEST(framed_repeat_flag_clocks_one_unit_count_times) {
+    Bench b;
+    b.loadFramed();
+    framed_window(b, 0, 0, 7, 3);
+    framed_data_tag(b, 21, true);
+    b.unit(0xf00f);
+    b.unit(0x29);
+    CHECK_EQ(b.panel().pixelsWritten(), 21);
+    for (int y = 0; y < 3; ++y) {
+        for (int x = 0; x < 7; ++x) CHECK_EQ(b.panel().pixel(x, y), 0xf00f);
+    }
+    CHECK_EQ(b.panel().pixel(7, 0), 0);
+    CHECK(b.panel().commands().back().opcode == 0x29);
+    CHECK_EQ(b.panel().framingErrors(), 0);
+}
+
+TEST(framed_count_is_split_across_two_units) {
+    // Counts on both sides of the 16-bit boundary, for payload and repeat.
+    const uint32_t counts[] = {1, 2, 0xffff, 0x10000, 0x10001, 320 * 320};
+    for (uint32_t count : counts) {
+        for (int repeat = 0; repeat < 2; ++repeat) {
+            Bench b;
+            b.loadFramed();
+            framed_window(b, 0, 0, 320, 320);
+            framed_data_tag(b, count, repeat != 0);
+            if (repeat) {
+                b.unit(0x1234);
+            } else {
+                for (uint32_t i = 0; i < count; ++i) b.unit(test_pixel(i));
+            }
+            // Nothing may be left over: the next unit must be taken as a command.
+            b.unit(0x29);
+            CHECK_EQ(b.panel().pixelsWritten(), count);
+            CHECK(b.panel().commands().back().opcode == 0x29);
+            CHECK_EQ(b.panel().framingErrors(), 0);
+            uint32_t last = count - 1;
+            uint16_t expected = repeat ? 0x1234 : test_pixel(last);
+            CHECK_EQ(b.panel().pixel(last % 320, last / 320), expected);
+        }
+    }
+}
+
+// The cycle figures quoted in st7789_lcd.pio, and the cost per transfer path.
+TEST(cycle_counts_per_pixel) {
+    const uint32_t PIXELS = 1000;
+
+    uint64_t bytes_cycles, px16_cycles, px32_cycles, framed_cycles, fill_cycles, command_cycles;
+    // The mock hardware is global, so one bench at a time.
+    {
+        Bench b;
+        b.loadBytes();
+        uint64_t start = b.cycles();
+        for (uint32_t i = 0; i < PIXELS; ++i) {
+            b.byte((uint8_t)(test_pixel(i) >> 8));
+            b.byte((uint8_t)test_pixel(i));
+        }
+        bytes_cycles = b.cycles() - start;
+    }
+    {
+        Bench b;
+        b.loadBytes();
+        b.use16Bit();
+        uint64_t start = b.cycles();
+        for (uint32_t i = 0; i < PIXELS; ++i) b.unit(test_pixel(i));
+        px16_cycles = b.cycles() - start;
+    }
+    {
+        Bench b;
+        b.loadBytes();
+        b.usePx32();
+        uint64_t start = b.cycles();
+        for (uint32_t i = 0; i < PIXELS; i += 2) b.push(test_pixel(i) | ((uint32_t)test_pixel(i + 1) << 16));
+        px32_cycles = b.cycles() - start;
+    }
+    {
+        Bench b;
+        b.loadFramed();
+        uint64_t start = b.cycles();
+        framed_data_tag(b, PIXELS, false);
+        for (uint32_t i = 0; i < PIXELS; ++i) b.unit(test_pixel(i));
+        framed_cycles = b.cycles() - start;
+
+        start = b.cycles();
+        framed_data_tag(b, PIXELS, true);
+        b.unit(0);
+        fill_cycles = b.cycles() - start;
+
+        start = b.cycles();
+        b.unit(0x2C);
+        command_cycles = b.cycles() - start;
+    }
+
+    std::printf("  SM cycles for %u pixels: 8-bit %llu, 16-bit %llu, px32 %llu, framed %llu, framed fill %llu; framed command %llu\n",
+                PIXELS, (unsigned long long)bytes_cycles, (unsigned long long)px16_cycles,
+                (unsigned long long)px32_cycles, (unsigned long long)framed_cycles,
+                (unsigned long long)fill_cycles, (unsigned long long)command_cycles);
+    CHECK_EQ(bytes_cycles, 32 * PIXELS);
+    CHECK_EQ(px16_cycles, 32 * PIXELS);
+    CHECK_EQ(px32_cycles, 34 * PIXELS);
+    CHECK_EQ(framed_cycles, 34 * PIXELS + 11);
+    CHECK_EQ(fill_cycles, 34 * PIXELS + 14);
+    CHECK_EQ(command_cycles, 22);
+}
+
+int main() {
+    return run_all_tests();
+}
@@ -0,0 +1,144 @@
+// File: tests/test_spsc_queue.cpp
+//
+// SpscQueue and FrameRing with a real producer thread and consumer thread:
+// millions of elements must come out complete, in order, exactly once.
+
+#include "TestHarness.h"
+#include "SpscQueue.h"
+#include "FrameRing.h"
+#include <cstring>
+#include <thread>
+
+namespace {
+
+struct Item {
+    uint32_t seq;
+    uint32_t check[3];
+};
+
+uint32_t mix(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352d;
+    x ^= x >> 15;
+    x *= 0x846ca68b;
+    x ^= x >> 16;
+    return x;
+}
+
+// Mostly small frames with the odd full-size one, like tiles and stream chunks.
+size_t payload_length(uint32_t seq) {
+    uint32_t r = mix(seq);
+    if ((r & 0xff) == 0) return Protocol::MAX_PAYLOAD_SIZE - (r >> 8) % 64;
+    return (r >> 8) % 300;
+}
+
+uint8_t payload_byte(uint32_t seq, size_t i) {
+    return (uint8_t)(seq * 31 + i * 7);
+}
+
+} // namespace
+
+TEST(spsc_queue_two_threads_keep_order) {
+    constexpr uint32_t COUNT = 10000000;
+    static SpscQueue<Item, 64> queue;
+    int bad_items = 0;
+    uint32_t received = 0;
+
+    std::thread consumer([&] {
+        while (received < COUNT) {
+            Item* item = queue.front();
+            if (!item) {
+                std::this_thread::yield();
+                continue;
+            }
+            uint32_t s = item->seq;
+            if (s != received || item->check[0] != mix(s) || item->check[1] != ~s || item->check[2] != s * 3) {
+                bad_items++;
+            }
+            queue.pop();
+            received++;
+        }
+    });
+
+    uint32_t max_size = 0;
+    for (uint32_t s = 0; s < COUNT; ++s) {
+        Item* slot;
+        while (!(slot = queue.reserve())) {
+            std::this_thread::yield();
+        }
+        slot->seq = s;
+        slot->check[0] = mix(s);
+        slot->check[1] = ~s;
+        slot->check[2] = s * 3;
+        queue.commit();
+        max_size = std::max<uint32_t>(max_size, (uint32_t)queue.size());
+    }
+    consumer.join();
+
+    CHECK_EQ(received, COUNT);
+    CHECK_EQ(bad_items, 0);
+    CHECK(max_size <= 64);
+    CHECK(queue.empty());
+    CHECK(queue.front() == nullptr);
+}
+
+TEST(frame_ring_two_threads_keep_order_and_payloads) {
+    constexpr uint32_t COUNT = 2000000;
+    static FrameRing<20000> ring;
+    int bad_frames = 0;
+    int misaligned = 0;
+    uint32_t received = 0;
+
+    std::thread consumer([&] {
+        while (received < COUNT) {
+            Protocol::Frame* frame = ring.front();
+            if (!frame) {
+                std::this_thread::yield();
+                continue;
+            }
+            uint32_t s = frame->seq;
+            size_t length = frame->header.payload_length;
+            bool ok = s == received && length == payload_length(s);
+            for (size_t i = 0; ok && i < length; ++i) {
+                ok = frame->payload()[i] == payload_byte(s, i);
+            }
+            if (!ok) bad_frames++;
+            if ((uintptr_t)frame->payload() % 4 != 0) misaligned++;
+            ring.pop();
+            received++;
+        }
+    });
+
+    // Space the ring promises to the host must always be there.
+    int broken_promises = 0;
+    for (uint32_t s = 0; s < COUNT; ++s) {
+        size_t length = payload_length(s);
+        Protocol::Frame* frame;
+        while (true) {
+            uint32_t promised = ring.guaranteed_space();
+            frame = ring.reserve(length);
+            if (frame) break;
+            if (ring.record_size(length) <= promised) broken_promises++;
+            std::this_thread::yield();
+        }
+        std::memset(&frame->header, 0, sizeof(frame->header));
+        frame->header.payload_length = (uint16_t)length;
+        frame->seq = s;
+        for (size_t i = 0; i < length; ++i) {
+            frame->payload()[i] = payload_byte(s, i);
+        }
+        ring.commit();
+    }
+    consumer.join();
+
+    CHECK_EQ(received, COUNT);
+    CHECK_EQ(bad_frames, 0);
+    CHECK_EQ(misaligned, 0);
+    CHECK_EQ(broken_promises, 0);
+    CHECK(ring.empty());
+    CHECK(ring.front() == nullptr);
+}
+
+int main() {
+    return run_all_tests();
+}